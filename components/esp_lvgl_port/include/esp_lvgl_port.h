@@ -53,6 +53,7 @@ typedef struct {
     int task_affinity;      /*!< LVGL task pinned to core (-1 is no affinity) */
     int task_max_sleep_ms;  /*!< Maximum sleep in LVGL task */
     int timer_period_ms;    /*!< LVGL timer tick period in ms */
+    int target_fps;         /*!< Frame pacing: LVGL task runs on a fixed cadence of this many frames per second and sleeps between the frames (0: disabled, LVGL 9 only) */
 } lvgl_port_cfg_t;
 
 /**
@@ -138,6 +139,120 @@ esp_err_t lvgl_port_stop(void);
  */
 esp_err_t lvgl_port_resume(void);
 
+/**
+ * @brief LVGL port replay configuration structure
+ */
+typedef struct {
+    uint32_t        tick_period_ms;     /*!< Synthetic clock: LVGL tick is advanced by this value on every LVGL task cycle */
+    const uint32_t *tick_deltas;        /*!< Recorded clock: LVGL tick increments in [ms], one per LVGL task cycle (optional) */
+    uint32_t        tick_deltas_count;  /*!< Count of recorded increments, the synthetic clock is used after the last one */
+} lvgl_port_replay_cfg_t;
+
+/**
+ * @brief Seed the LVGL port pseudo-random generator
+ *
+ * @note The generator is deterministic (PCG32), the same seed gives the same sequence on every chip and on host.
+ *
+ * @param seed Seed value
+ */
+void lvgl_port_rand_seed(uint64_t seed);
+
+/**
+ * @brief Get next pseudo-random value
+ *
+ * @note It is not thread safe, use it from LVGL task or under LVGL lock.
+ *
+ * @return 32-bit pseudo-random value
+ */
+uint32_t lvgl_port_rand(void);
+
+/**
+ * @brief Get next pseudo-random value in range [0, bound)
+ *
+ * @param bound Exclusive upper bound (0 returns 0)
+ * @return pseudo-random value without modulo bias
+ */
+uint32_t lvgl_port_rand_bounded(uint32_t bound);
+
+/**
+ * @brief Start replay mode
+ *
+ * @note In replay mode the LVGL tick timer is stopped and the LVGL tick is driven from a recorded or synthetic clock,
+ * one step per LVGL task cycle. Together with a seeded lvgl_port_rand() the rendered frames do not depend on the wall clock.
+ *
+ * @param cfg Replay configuration (tick_deltas must stay valid until replay is stopped)
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if the configuration is not valid
+ *      - ESP_ERR_INVALID_STATE     if the LVGL port is not initialized or replay mode is already running
+ *      - ESP_ERR_NOT_SUPPORTED     if it is not implemented (LVGL8)
+ */
+esp_err_t lvgl_port_replay_start(const lvgl_port_replay_cfg_t *cfg);
+
+/**
+ * @brief Stop replay mode and resume the LVGL tick timer
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_STATE     if replay mode is not running
+ *      - ESP_ERR_NOT_SUPPORTED     if it is not implemented (LVGL8)
+ */
+esp_err_t lvgl_port_replay_stop(void);
+
+/**
+ * @brief Start recording the LVGL tick increments of every LVGL task cycle
+ *
+ * @note The recorded buffer can be used as tick_deltas in lvgl_port_replay_start() for replaying the same timing.
+ *
+ * @param buf   Buffer for the recorded increments in [ms]
+ * @param len   Length of the buffer (recording stops, when it is full)
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if the buffer is not valid
+ *      - ESP_ERR_NOT_SUPPORTED     if it is not implemented (LVGL8)
+ */
+esp_err_t lvgl_port_record_start(uint32_t *buf, uint32_t len);
+
+/**
+ * @brief Stop recording the LVGL tick increments
+ *
+ * @return Count of recorded increments
+ */
+uint32_t lvgl_port_record_stop(void);
+
+/**
+ * @brief Frame pacing statistics
+ */
+typedef struct {
+    uint32_t    frames;         /*!< Count of refreshed frames (frames with invalidated areas) */
+    uint32_t    fps;            /*!< Average refreshed frames per second over elapsed_us */
+    uint32_t    late;           /*!< Count of refreshed frames, which took longer than the frame period */
+    uint32_t    missed;         /*!< Count of frame periods skipped by the late frames */
+    uint64_t    work_us;        /*!< Total time of LVGL work in the refreshed frames [us] (average: work_us / frames) */
+    uint32_t    work_max_us;    /*!< Longest LVGL work in a refreshed frame [us] */
+    uint64_t    slack_us;       /*!< Total time left to the next frame after the frames in time [us] (average: slack_us / (frames - late)) */
+    uint32_t    slack_min_us;   /*!< Shortest time left to the next frame after a frame in time [us] */
+    uint32_t    interval_avg_us;/*!< Average time between two refreshed frames in a row [us] */
+    uint32_t    interval_dev_us;/*!< Standard deviation of the time between two refreshed frames in a row [us] */
+    uint64_t    elapsed_us;     /*!< Time since the statistics were reset [us] */
+} lvgl_port_frame_stats_t;
+
+/**
+ * @brief Get frame pacing statistics
+ *
+ * @note Frame pacing is enabled by target_fps in lvgl_port_cfg_t. Only frames with invalidated areas are measured.
+ * The deviation of the interval shows, how steady the animations look (late frames make it bigger).
+ *
+ * @param stats     Output statistics
+ * @param reset     Reset the statistics after reading
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if the argument is not valid
+ *      - ESP_ERR_INVALID_STATE     if frame pacing is not enabled
+ *      - ESP_ERR_NOT_SUPPORTED     if it is not implemented (LVGL8)
+ */
+esp_err_t lvgl_port_get_frame_stats(lvgl_port_frame_stats_t *stats, bool reset);
+
 /**
  * @brief Notify LVGL task, that display need reload
  *
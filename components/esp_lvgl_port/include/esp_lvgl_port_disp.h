@@ -33,6 +33,68 @@ typedef struct {
     bool mirror_y; /*!< LCD Screen mirrored Y (in esp_lcd driver) */
 } lvgl_port_rotation_cfg_t;
 
+/**
+ * @brief Command set of the panel, for the commands sent by the LVGL port directly to the panel IO
+ */
+typedef enum {
+    LVGL_PORT_PANEL_CMD_NONE = 0,   /*!< Unknown command set: RGB444 output, chained bands, polled transfers and TE synchronization can't be used */
+    LVGL_PORT_PANEL_CMD_DCS,        /*!< MIPI DCS panel (e.g. ST7789, ILI9341) on SPI or I8080 panel IO, 8-bit commands */
+    LVGL_PORT_PANEL_CMD_DCS_QSPI,   /*!< MIPI DCS panel on QSPI panel IO (e.g. SH8601, RM67162, CO5300), 32-bit command word with the write opcode (0x02 commands, 0x32 pixels) */
+} lvgl_port_panel_cmd_t;
+
+/**
+ * @brief Output configuration for the transfers sent directly to the panel IO (LVGL 9)
+ */
+typedef struct {
+    lvgl_port_panel_cmd_t cmd_set; /*!< Command set of the panel (window, memory write and continue, COLMOD, TEON) */
+    bool rgb444;    /*!< Send pixels as packed 12-bit RGB444 (1.5 bytes per pixel) and set COLMOD of the panel to 12 bits per pixel (RGB565 display color format, LVGL_PORT_PANEL_CMD_DCS panels with COLMOD 0x53, e.g. ST7789) */
+    bool dither;    /*!< Use 4x4 ordered dithering, when reducing to RGB444 */
+    int  x_gap;     /*!< Panel X gap, the same as in esp_lcd_panel_set_gap() (RGB444 pixels, chained bands and polled transfers are sent directly to the panel IO, they don't use the gap of the panel driver) */
+    int  y_gap;     /*!< Panel Y gap, the same as in esp_lcd_panel_set_gap() */
+} lvgl_port_output_cfg_t;
+
+/**
+ * @brief Tearing effect (TE) synchronization configuration (LVGL 9, panels with TE output and command set in output)
+ */
+typedef struct {
+    bool sync;      /*!< Delay each band transfer, so that the panel scan doesn't cross the written rows (TE output is enabled by TEON command) */
+    int  gpio_num;  /*!< GPIO connected to the TE output of the panel */
+} lvgl_port_te_cfg_t;
+
+/**
+ * @brief Draw buffer size tuning configuration (LVGL 9.2, I2C/SPI/I8080 displays in partial mode)
+ */
+typedef struct {
+    bool     enable;        /*!< Measure render and flush time of the bands and resize the draw buffers between frames to the smallest size close to the best FPS (buffer_size is the initial size) */
+    uint32_t max_bytes;     /*!< RAM ceiling of all draw buffers of the display [bytes] (0: size of the configured buffers) */
+    uint32_t min_lines;     /*!< Smallest draw buffer [lines] (0: 4 lines) */
+    uint32_t heap_reserve;  /*!< Free heap of the buffer capabilities left for the application [bytes] (0: 16 kB) */
+} lvgl_port_buff_tune_cfg_t;
+
+/**
+ * @brief Visible window of the panel (LVGL 9, partial mode)
+ *
+ * Coordinates are in the screen at rotation 0, after the gap of the panel (esp_lcd_panel_set_gap).
+ */
+typedef struct {
+    uint32_t x;         /*!< Left column of the visible window */
+    uint32_t y;         /*!< Top row of the visible window */
+    uint32_t width;     /*!< Width of the visible window (0: whole screen is visible) */
+    uint32_t height;    /*!< Height of the visible window */
+    uint32_t radius;    /*!< Radius of the rounded corners (width / 2 for a round display, 0: rectangle) */
+} lvgl_port_visible_cfg_t;
+
+/**
+ * @brief Alignment of the windows sent to the panel (LVGL 9, partial mode)
+ *
+ * Columns and rows are of the panel at rotation 0. The resolution and the panel gap must be multiples of the alignment.
+ */
+typedef struct {
+    uint8_t     x_align;    /*!< Windows start and end on multiples of x_align columns (0 or 1: any column) */
+    uint8_t     y_align;    /*!< Windows start and end on multiples of y_align rows (0 or 1: any row) */
+    uint16_t    min_width;  /*!< Minimum width of the windows in columns (0: any width) */
+} lvgl_port_rounder_cfg_t;
+
 /**
  * @brief Configuration display structure
  */
@@ -54,6 +116,14 @@ typedef struct {
 #if LVGL_VERSION_MAJOR >= 9
     lv_color_format_t        color_format;  /*!< The color format of the display */
 #endif
+    /* Features of the LVGL 9 port, they must be zero with LVGL 8 */
+    uint8_t                  ring_buffers;  /*!< Number of partial draw buffers in a flush ring, 3..4 (0: use double_buffer). Flushes are queued to the panel IO and LVGL renders into the next free buffer (optional) */
+    lvgl_port_output_cfg_t   output;        /*!< Command set, reduced color depth and gap of the panel for the transfers sent directly to the panel IO (optional) */
+    lvgl_port_te_cfg_t       te;            /*!< Flush synchronized with the TE output of the panel (optional) */
+    lvgl_port_buff_tune_cfg_t buff_tune;    /*!< Draw buffer size tuning (optional) */
+    uint32_t                 poll_max_bytes; /*!< Bands up to this size [bytes] are sent by polling, without the queue and the done interrupt of the panel IO (LVGL_PORT_PANEL_CMD_DCS panels on SPI, panel gap in output, 0: always queued) (optional) */
+    lvgl_port_visible_cfg_t  visible;       /*!< Visible window of the panel, invalidated areas are clipped to it and areas out of it are not sent (optional) */
+    lvgl_port_rounder_cfg_t  rounder;       /*!< Alignment of the windows required by the panel, invalidated areas are extended to it (optional) */
     struct {
         unsigned int buff_dma: 1;    /*!< Allocated LVGL buffer will be DMA capable */
         unsigned int buff_spiram: 1; /*!< Allocated LVGL buffer will be in PSRAM */
@@ -61,6 +131,9 @@ typedef struct {
 #if LVGL_VERSION_MAJOR >= 9
         unsigned int swap_bytes: 1;  /*!< Swap bytes in RGB656 (16-bit) color format before send to LCD driver */
 #endif
+        unsigned int diff_flush: 1;  /*!< Keep hashes of the panel content and send only changed rows of the flushed area (I2C/SPI/I8080 partial mode), or only changed page spans (monochrome I1) */
+        unsigned int chain_bands: 1; /*!< Send the next band of the same area as a continuation of the panel window (MIPI DCS RAMWRC), so its transfer is queued without window commands (command set and panel gap in output) */
+        unsigned int shared_buffers: 1; /*!< Borrow the draw buffers from a pool shared by all displays with this flag for the time of a refresh, instead of allocating own buffers (I2C/SPI/I8080, not direct mode). Bigger buffers of a new display free the pool buffers set in LVGL by the displays added before, they take the new ones at their next refresh */
         unsigned int full_refresh: 1;/*!< 1: Always make the whole screen redrawn */
         unsigned int direct_mode: 1; /*!< 1: Use screen-sized buffers and draw to absolute coordinates */
     } flags;
@@ -85,6 +158,63 @@ typedef struct {
     } flags;
 } lvgl_port_display_dsi_cfg_t;
 
+/**
+ * @brief Display flush statistics
+ */
+typedef struct {
+    uint32_t    frames;         /*!< Count of refreshed frames (last flushed area of a refresh) */
+    uint32_t    flushes;        /*!< Count of flushed areas */
+    uint32_t    stalls;         /*!< Count of flushes, when LVGL had to wait for a free draw buffer */
+    uint64_t    stall_us;       /*!< Total time LVGL waited for a free draw buffer [us] */
+    uint64_t    elapsed_us;     /*!< Time since the statistics were reset [us] */
+    uint32_t    fps;            /*!< Average frames per second over elapsed_us */
+    uint32_t    merged_areas;   /*!< Count of invalidated areas merged by the flush cost model */
+    uint32_t    trans_saved;    /*!< Count of flush transactions saved by merging (per frame: trans_saved / frames) */
+    uint64_t    diff_skipped_bytes; /*!< Bytes not sent by the diff flush, because the panel already shows them */
+    uint64_t    te_delay_us;    /*!< Total time band transfers were delayed by the TE synchronization [us] */
+    uint32_t    chained_bands;  /*!< Count of bands sent as a continuation of the panel window, without window commands */
+    uint32_t    poll_trans;     /*!< Count of color transfers sent by polling (poll_max_bytes) */
+    uint64_t    poll_us;        /*!< Total time of the polled transfers, from the window commands to the end of the pixels [us] */
+    uint32_t    queued_trans;   /*!< Count of queued color transfers (counted with poll_max_bytes) */
+    uint32_t    queued_measured;/*!< Count of queued color transfers started on an idle panel IO, their time is in queued_us */
+    uint64_t    queued_us;      /*!< Total time of the measured queued transfers, from the window commands to the done callback [us] */
+    uint64_t    flushed_px;     /*!< Pixels of the flushed areas */
+    uint64_t    visible_skipped_px; /*!< Pixels of the invalidated areas out of the visible window, which were not rendered (ratio: visible_skipped_px / (visible_skipped_px + flushed_px)) */
+} lvgl_port_disp_flush_stats_t;
+
+/**
+ * @brief Draw buffer size chosen by the tuning
+ */
+typedef struct {
+    uint32_t    buffer_size;    /*!< Size of one draw buffer, in the same units as buffer_size in lvgl_port_display_cfg_t (it can be used without the tuning) */
+    uint32_t    lines;          /*!< Size of one draw buffer in lines of the current horizontal resolution */
+    uint8_t     buffers;        /*!< Count of draw buffers */
+    uint32_t    frame_us;       /*!< Predicted frame time with the chosen size [us] (0: not predicted yet) */
+    uint32_t    resizes;        /*!< Count of resizes */
+    bool        stable;         /*!< The size was kept in the last decisions */
+} lvgl_port_buff_tune_info_t;
+
+/**
+ * @brief Shared draw buffer pool statistics
+ */
+typedef struct {
+    uint32_t    displays;       /*!< Count of displays sharing the pool */
+    uint32_t    buffers;        /*!< Count of buffers in the pool (the most draw buffers of one display) */
+    uint32_t    pool_bytes;     /*!< Memory of the pool, each buffer has the size of the biggest draw buffer of the displays [bytes] */
+    uint32_t    private_bytes;  /*!< Memory of the draw buffers, if each display allocated its own [bytes] */
+    uint32_t    borrows;        /*!< Count of refreshes, which took the buffers from another display */
+    uint32_t    waits;          /*!< Count of borrows, which waited for the last band of the other display */
+    uint64_t    wait_us;        /*!< Total time of the waits [us] */
+} lvgl_port_buff_pool_stats_t;
+
+/**
+ * @brief Flush cost model, used for merging invalidated areas
+ */
+typedef struct {
+    uint32_t    trans_overhead_us;  /*!< Overhead of one flush transaction (e.g. CASET, RASET and RAMWR commands) [us] */
+    uint32_t    bytes_per_us;       /*!< Throughput of the color data [bytes/us] (e.g. 5 for 40 MHz SPI), 0: merging is disabled */
+} lvgl_port_area_cost_cfg_t;
+
 /**
  * @brief Add I2C/SPI/I8080 display handling to LVGL
  *
@@ -127,6 +257,69 @@ lv_display_t *lvgl_port_add_disp_rgb(const lvgl_port_display_cfg_t *disp_cfg, co
  */
 esp_err_t lvgl_port_remove_disp(lv_display_t *disp);
 
+/**
+ * @brief Get display flush statistics
+ *
+ * @note Stall time is the time, when rendering was blocked by the flushing (all draw buffers were in flight).
+ * It can be used for selecting the right number of draw buffers (double_buffer or ring_buffers).
+ *
+ * @param disp      LVGL display handle (returned from lvgl_port_add_disp)
+ * @param stats     Output statistics
+ * @param reset     Reset the statistics after reading
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_NOT_SUPPORTED     if it is not implemented (LVGL8)
+ */
+esp_err_t lvgl_port_disp_get_flush_stats(lv_display_t *disp, lvgl_port_disp_flush_stats_t *stats, bool reset);
+
+/**
+ * @brief Set flush cost model for merging of invalidated areas
+ *
+ * @note Nearby invalidated areas are merged, when one bigger transaction is cheaper than the separate ones.
+ * The cost of an area is the count of its transactions (the area is split into draw buffer bands) multiplied by the overhead,
+ * plus the time of sending its pixels. It is used only in partial render mode.
+ *
+ * @param disp      LVGL display handle (returned from lvgl_port_add_disp)
+ * @param cost      Flush cost model (NULL disables merging)
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_NOT_SUPPORTED     if it is not implemented (LVGL8)
+ */
+esp_err_t lvgl_port_disp_set_area_cost(lv_display_t *disp, const lvgl_port_area_cost_cfg_t *cost);
+
+/**
+ * @brief Get draw buffer size chosen by the tuning
+ *
+ * @note When the size is stable, it can be set as buffer_size in the display configuration and the tuning can be disabled.
+ *
+ * @param disp      LVGL display handle (returned from lvgl_port_add_disp)
+ * @param info      Output size and state of the tuning
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_INVALID_STATE     if the tuning is not enabled for the display
+ *      - ESP_ERR_NOT_SUPPORTED     if it is not implemented (LVGL8)
+ */
+esp_err_t lvgl_port_disp_get_buff_tune(lv_display_t *disp, lvgl_port_buff_tune_info_t *info);
+
+/**
+ * @brief Get statistics of the draw buffer pool shared by the displays with shared_buffers flag
+ *
+ * @note Only one display renders at a time in the LVGL task, so the pool needs the memory of the biggest display,
+ * not of all displays. A display borrows the buffers at the start of its refresh, after the last band of the display,
+ * which had them before, is sent.
+ *
+ * @param stats     Output statistics
+ * @param reset     Reset the counters of borrows and waits after reading
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if the argument is not valid
+ *      - ESP_ERR_NOT_SUPPORTED     if it is not implemented (LVGL8)
+ */
+esp_err_t lvgl_port_disp_get_buff_pool_stats(lvgl_port_buff_pool_stats_t *stats, bool reset);
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,6 +32,11 @@ extern "C" {
     _lv_color_blend_to_rgb565_esp(dsc)
 #endif
 
+#ifndef LV_DRAW_SW_RGB565_SWAP
+#define LV_DRAW_SW_RGB565_SWAP(buf, buf_size_px) \
+    _lv_rgb565_swap_esp(buf, buf_size_px)
+#endif
+
 
 /**********************
  *      TYPEDEFS
@@ -83,6 +88,14 @@ static inline lv_result_t _lv_color_blend_to_rgb565_esp(_lv_draw_sw_blend_fill_d
     return lv_color_blend_to_rgb565_esp(&asm_dsc);
 }
 
+extern void lvgl_port_rgb565_swap(void *buf, uint32_t len_px);
+
+static inline lv_result_t _lv_rgb565_swap_esp(void *buf, uint32_t buf_size_px)
+{
+    lvgl_port_rgb565_swap(buf, buf_size_px);
+    return LV_RESULT_OK;
+}
+
 #endif // CONFIG_LV_DRAW_SW_ASM_CUSTOM
 
 #ifdef __cplusplus
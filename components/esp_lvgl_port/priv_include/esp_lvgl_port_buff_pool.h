@@ -0,0 +1,108 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port draw buffers shared by the displays
+ *
+ * All displays render one after another in one task, so they can borrow the same draw buffers for the time of their
+ * refresh. The last band of a refresh is still sent, when the refresh ends. The display, which borrows the buffers
+ * next, waits until that band is done, before it renders into them.
+ * It doesn't depend on LVGL, so it can be tested on host.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LVGL_PORT_BUFF_POOL_BUFFS   2
+#define LVGL_PORT_BUFF_POOL_WAIT_MS 100     /* Maximum wait for the band in flight of the owner, then the buffers are taken anyway */
+
+/**
+ * @brief Display using the shared draw buffers
+ */
+typedef struct {
+    uint32_t        size;           /*!< Size of the draw buffers of the display [bytes] */
+    uint8_t         count;          /*!< Number of draw buffers of the display */
+    volatile bool   in_flight;      /*!< A band rendered in the pool buffers is sent */
+    void            *done;          /*!< Given, when the band in flight is done (semaphore) */
+} lvgl_port_buff_pool_user_t;
+
+/**
+ * @brief Draw buffers shared by the displays
+ */
+typedef struct {
+    void            *buffs[LVGL_PORT_BUFF_POOL_BUFFS];  /*!< Buffers big enough for each display */
+    uint32_t        sizes[LVGL_PORT_BUFF_POOL_BUFFS];   /*!< Sizes of the buffers [bytes] */
+    uint32_t        caps;           /*!< Heap capabilities of the buffers */
+    uint32_t        users;          /*!< Displays sharing the buffers */
+    lvgl_port_buff_pool_user_t *owner;  /*!< Display, which rendered into the buffers last (NULL: nobody) */
+    uint32_t        private_bytes;  /*!< Draw buffers of all displays, if they were not shared */
+    uint32_t        borrows;        /*!< Count of the buffers taken over from another display */
+    uint32_t        waits;          /*!< Count of the waits for a band in flight of another display */
+    uint64_t        wait_us;        /*!< Time of the waits */
+    uint32_t        timeouts;       /*!< Count of the waits, which timed out */
+} lvgl_port_buff_pool_t;
+
+/**
+ * @brief Add a display to the pool
+ *
+ * Smaller buffers of the pool are replaced by buffers of the display size. The band in flight of the owner is waited
+ * for first.
+ *
+ * @warning The replaced buffers are freed. Displays added before keep them set in LVGL (lv_display_set_buffers()),
+ *          until they borrow the buffers again at their next refresh. Nobody owns the buffers after this call,
+ *          so each display borrows them, before it renders.
+ *
+ * @param pool      Pool
+ * @param user      Display, initialized
+ * @param size      Size of the draw buffers of the display [bytes]
+ * @param count     Number of draw buffers of the display (1 or 2)
+ * @param caps      Heap capabilities of the buffers, the same for all displays
+ * @return true on success, false when the capabilities differ or on no memory
+ */
+bool lvgl_port_buff_pool_add(lvgl_port_buff_pool_t *pool, lvgl_port_buff_pool_user_t *user, uint32_t size, uint8_t count, uint32_t caps);
+
+/**
+ * @brief Remove the display from the pool, the buffers are freed with the last display
+ *
+ * The band in flight of the display is waited for, when it owns the buffers.
+ */
+void lvgl_port_buff_pool_remove(lvgl_port_buff_pool_t *pool, lvgl_port_buff_pool_user_t *user);
+
+/**
+ * @brief Borrow the buffers for a refresh of the display
+ *
+ * When another display owns the buffers, its band in flight is waited for (a timeout is counted).
+ *
+ * @param pool      Pool
+ * @param user      Display
+ * @return true: the display was not the owner, the buffers of the pool must be set to it again
+ */
+bool lvgl_port_buff_pool_borrow(lvgl_port_buff_pool_t *pool, lvgl_port_buff_pool_user_t *user);
+
+/**
+ * @brief The display sends a band rendered in the pool buffers, called before the band is queued
+ */
+void lvgl_port_buff_pool_send(lvgl_port_buff_pool_user_t *user);
+
+/**
+ * @brief The band of the display is done (sent, or nothing was sent), another display can render into the buffers
+ *
+ * It is safe to call it from an interrupt and from a task.
+ *
+ * @return true, when a higher priority task was woken (yield from the interrupt)
+ */
+bool lvgl_port_buff_pool_done(lvgl_port_buff_pool_user_t *user);
+
+#ifdef __cplusplus
+}
+#endif
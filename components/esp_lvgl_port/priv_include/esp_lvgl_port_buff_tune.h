@@ -0,0 +1,124 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port draw buffer size tuning
+ *
+ * Render and flush time of each band are measured and fitted by a linear model: time = per band overhead + time per pixel.
+ * Flushed bands of a frame are joined back to the rendered areas, so the band count of the same frames can be computed for
+ * other buffer sizes. After a window of frames, the frame time is predicted for each candidate size and the smallest size,
+ * whose frame time is close to the best one, is chosen.
+ * It doesn't depend on LVGL or on ESP-IDF drivers, so it can be tested on host.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LVGL_PORT_BUFF_TUNE_STEPS       8   /* Maximum count of candidate sizes */
+
+/**
+ * @brief Running sums of a linear fit: time [us] by pixels
+ */
+typedef struct {
+    int64_t     n;
+    int64_t     sx;
+    int64_t     sxx;
+    int64_t     sy;
+    int64_t     sxy;
+} lvgl_port_buff_tune_fit_t;
+
+/**
+ * @brief Tuning state
+ */
+typedef struct {
+    uint32_t    px_size;        /* Bytes per pixel */
+    uint8_t     buffers;        /* Draw buffers (1 or 2), rendering and flushing overlap with 2 buffers */
+    uint32_t    window;         /* Frames between decisions */
+    uint32_t    sizes[LVGL_PORT_BUFF_TUNE_STEPS];   /* Candidate sizes of one buffer [bytes], ascending */
+    uint8_t     steps;          /* Count of candidates */
+    uint8_t     current;        /* Candidate used now */
+    uint32_t    stable;         /* Windows without a change */
+    lvgl_port_buff_tune_fit_t render;
+    lvgl_port_buff_tune_fit_t flush;
+    /* Workload of the window */
+    uint64_t    bands[LVGL_PORT_BUFF_TUNE_STEPS];   /* Bands of the window with each candidate size */
+    uint64_t    pixels;
+    uint32_t    frames;
+    /* Area of the frame, which is flushed now */
+    int32_t     area_x1;
+    int32_t     area_x2;
+    int32_t     area_y1;
+    int32_t     area_y2;
+    bool        area_valid;
+    uint32_t    predicted_us[LVGL_PORT_BUFF_TUNE_STEPS];    /* Predicted frame time of each candidate in the last window (0: no prediction) */
+} lvgl_port_buff_tune_t;
+
+/**
+ * @brief Initialize tuning
+ *
+ * Candidates are spread geometrically from the minimum to the maximum size and rounded down to whole lines.
+ *
+ * @param tune          Tuning state
+ * @param px_size       Bytes per pixel
+ * @param buffers       Count of draw buffers (1 or 2)
+ * @param line_bytes    Bytes of one line of the display
+ * @param min_bytes     Smallest size of one buffer
+ * @param max_bytes     Biggest size of one buffer
+ * @param start_bytes   Size used now, the nearest smaller candidate is the current one
+ * @param window        Frames between decisions
+ */
+void lvgl_port_buff_tune_init(lvgl_port_buff_tune_t *tune, uint32_t px_size, uint8_t buffers, uint32_t line_bytes,
+                              uint32_t min_bytes, uint32_t max_bytes, uint32_t start_bytes, uint32_t window);
+
+/**
+ * @brief Get size of one buffer of the current candidate [bytes]
+ */
+static inline uint32_t lvgl_port_buff_tune_get_size(const lvgl_port_buff_tune_t *tune)
+{
+    return tune->sizes[tune->current];
+}
+
+/**
+ * @brief Add rendered band (flushed area), end is inclusive
+ *
+ * @param render_us     Time of rendering the band, without the time of waiting for a free buffer
+ */
+void lvgl_port_buff_tune_add_band(lvgl_port_buff_tune_t *tune, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t render_us);
+
+/**
+ * @brief Add flush time of a band
+ *
+ * @param pixels        Pixels of the band
+ * @param flush_us      Time from the flush to the transfer done
+ */
+void lvgl_port_buff_tune_add_flush(lvgl_port_buff_tune_t *tune, uint32_t pixels, uint32_t flush_us);
+
+/**
+ * @brief End of a frame
+ *
+ * @return New size of one buffer [bytes], or 0 when the current size is kept
+ */
+uint32_t lvgl_port_buff_tune_frame_done(lvgl_port_buff_tune_t *tune);
+
+/**
+ * @brief Use a smaller size, than the tuning has chosen (e.g. the chosen size can't be allocated)
+ *
+ * Candidates bigger than the size are removed.
+ *
+ * @param size          Size of one buffer used now [bytes]
+ */
+void lvgl_port_buff_tune_limit(lvgl_port_buff_tune_t *tune, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,62 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port chaining of the bands of one flushed area
+ *
+ * MIPI DCS panels continue writing below the last written pixel after the memory write continue command (RAMWRC).
+ * The window of the first band of an area is opened down to the bottom of the panel, and the next band of the same
+ * area is sent only with RAMWRC. Its transfer is queued behind the transfer in flight, while the window commands
+ * (CASET, RASET) would wait for all queued transfers.
+ * It doesn't depend on LVGL or on ESP-IDF drivers, so it can be tested on host.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Panel window of the last band
+ */
+typedef struct {
+    bool    valid;      /*!< Window of the last band is open to the bottom of the panel and the next pixel starts a row */
+    int32_t x_start;    /*!< Columns of the window (end is exclusive) */
+    int32_t x_end;
+    int32_t y_end;      /*!< Next row written by the panel */
+} lvgl_port_chain_t;
+
+/**
+ * @brief Forget the window of the last band (e.g. the panel orientation or its window changed)
+ */
+void lvgl_port_chain_reset(lvgl_port_chain_t *chain);
+
+/**
+ * @brief Decide, whether the band continues the window of the last band
+ *
+ * Coordinates are the same as in esp_lcd_panel_draw_bitmap() (end is exclusive).
+ *
+ * @param chain         Window of the last band, updated to this band
+ * @param x_start       First column of the band
+ * @param y_start       First row of the band
+ * @param x_end         End column of the band
+ * @param y_end         End row of the band
+ * @param vres          Rows of the panel
+ * @param byte_end      Pixels of the band end on a byte boundary (false e.g. for packed RGB444 with an odd pixel count,
+ *                      the next band can't continue it)
+ * @param win_y_end     End row of the window to open, set when the band is not chained (vres)
+ * @return true: send the band with RAMWRC, false: open the window (x_start, y_start, x_end, win_y_end) and send RAMWR
+ */
+bool lvgl_port_chain_band(lvgl_port_chain_t *chain, int32_t x_start, int32_t y_start, int32_t x_end, int32_t y_end, int32_t vres, bool byte_end, int32_t *win_y_end);
+
+#ifdef __cplusplus
+}
+#endif
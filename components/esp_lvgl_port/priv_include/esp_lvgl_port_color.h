@@ -0,0 +1,144 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port color conversion kernels
+ *
+ * These kernels don't depend on LVGL or on ESP-IDF drivers, so they can be tested on host.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Tile size in pixels for 90/270 rotation. Source tile rows and destination tile rows stay in cache (32 B lines). */
+#define LVGL_PORT_ROTATE_TILE       16
+/* Size of the tile buffer of lvgl_port_rotate() for pixels up to 4 bytes */
+#define LVGL_PORT_ROTATE_TILE_BYTES (LVGL_PORT_ROTATE_TILE * LVGL_PORT_ROTATE_TILE * 4)
+
+/**
+ * @brief Rotation of the color buffer
+ *
+ * @note Values are the same as lv_display_rotation_t
+ */
+typedef enum {
+    LVGL_PORT_COLOR_ROTATION_0 = 0,
+    LVGL_PORT_COLOR_ROTATION_90,
+    LVGL_PORT_COLOR_ROTATION_180,
+    LVGL_PORT_COLOR_ROTATION_270,
+} lvgl_port_color_rotation_t;
+
+/**
+ * @brief Rotate RGB565 buffer and optionally swap bytes of each pixel in one pass
+ *
+ * Destination mapping is the same as in lvgl_port_rotate_area():
+ *  - 90:  dst[(w - 1 - x), y]
+ *  - 180: dst[(h - 1 - y), (w - 1 - x)]
+ *  - 270: dst[x, (h - 1 - y)]
+ *
+ * @note 90 and 270 are processed in tiles, two pixels per 32-bit word when buffers and strides are word aligned.
+ *
+ * @param src           Source buffer
+ * @param dst           Destination buffer (must not overlap with source, except for rotation 0)
+ * @param src_w         Source width in pixels
+ * @param src_h         Source height in pixels
+ * @param src_stride    Source stride in bytes
+ * @param dst_stride    Destination stride in bytes
+ * @param rotation      Rotation
+ * @param swap          Swap bytes of each pixel
+ */
+void lvgl_port_rgb565_rotate_swap(const void *src, void *dst, int32_t src_w, int32_t src_h, int32_t src_stride, int32_t dst_stride,
+                                  lvgl_port_color_rotation_t rotation, bool swap);
+
+/**
+ * @brief Rotate buffer of 2, 3 or 4 bytes per pixel (RGB565, RGB888, XRGB8888, ARGB8888)
+ *
+ * Destination mapping is the same as in lvgl_port_rgb565_rotate_swap().
+ *
+ * @note 90 and 270 are processed in tiles of LVGL_PORT_ROTATE_TILE x LVGL_PORT_ROTATE_TILE pixels. With a tile buffer
+ * (in internal RAM, for buffers in PSRAM), each tile is read by source rows into the tile buffer and written
+ * by destination rows, so both buffers are accessed by whole cache lines. RGB565 without the tile buffer
+ * is rotated by lvgl_port_rgb565_rotate_swap().
+ *
+ * @param src           Source buffer
+ * @param dst           Destination buffer (must not overlap with source, except for rotation 0)
+ * @param src_w         Source width in pixels
+ * @param src_h         Source height in pixels
+ * @param src_stride    Source stride in bytes
+ * @param dst_stride    Destination stride in bytes
+ * @param px_size       Bytes per pixel (2, 3 or 4)
+ * @param rotation      Rotation
+ * @param swap          Swap bytes of each pixel (only for 2 bytes per pixel)
+ * @param tile_buf      Tile buffer of LVGL_PORT_ROTATE_TILE_BYTES (NULL: tiles are rotated directly)
+ */
+void lvgl_port_rotate(const void *src, void *dst, int32_t src_w, int32_t src_h, int32_t src_stride, int32_t dst_stride,
+                      uint32_t px_size, lvgl_port_color_rotation_t rotation, bool swap, void *tile_buf);
+
+/**
+ * @brief Swap bytes of each RGB565 pixel in place
+ *
+ * @note Two pixels are swapped per 32-bit word (four words per loop), single pixels only at unaligned start and odd end.
+ * On ESP32-S3 the buffers of 16 and more pixels are swapped with PIE, eight pixels per 128-bit vector.
+ *
+ * @param buf       RGB565 buffer (2-byte aligned)
+ * @param len_px    Number of pixels
+ */
+void lvgl_port_rgb565_swap(void *buf, uint32_t len_px);
+
+/**
+ * @brief Convert RGB565 pixels to packed RGB444 (12 bits per pixel, two pixels in three bytes)
+ *
+ * Packed stream: R0G0 B0R1 G1B1 ..., the last odd pixel is followed by a zero nibble.
+ * Without dithering the channels are truncated, with dithering a 4x4 ordered (Bayer) threshold
+ * is added before truncation: out = min(max, (in + (bayer >> (4 - dropped_bits))) >> dropped_bits).
+ *
+ * @note It can be done in place (dst == src).
+ *
+ * @param src       RGB565 pixels (native byte order, 2-byte aligned, stride is the width)
+ * @param dst       Packed output (at least (w * h * 3 + 1) / 2 bytes)
+ * @param w         Width in pixels
+ * @param h         Height in pixels
+ * @param x         Left column of the area on the screen (phase of the dithering matrix)
+ * @param y         Top row of the area on the screen
+ * @param dither    Use ordered dithering
+ * @return Size of the packed output in bytes
+ */
+size_t lvgl_port_rgb565_to_rgb444(const void *src, void *dst, int32_t w, int32_t h, int32_t x, int32_t y, bool dither);
+
+/**
+ * @brief Convert horizontally packed I1 rows to vertically packed pages of monochrome OLED (e.g. SSD1306)
+ *
+ * Source pixel (x, y) is bit (7 - x % 8) of src[src_stride * y + x / 8], set bit is a lit pixel.
+ * Output bit is cleared for a set source bit and set otherwise (the same as the LVGL port monochrome transform):
+ *  - swap_xy false: bit (y % 8) of dst[dst_stride * (y / 8) + x]
+ *  - swap_xy true:  bit (x % 8) of dst[dst_stride * (x / 8) + y]
+ *
+ * @note Blocks of 8x8 pixels (aligned to 8 in both directions) are transposed with 32-bit word operations,
+ * with swap_xy each source byte is one output byte. Only pixels out of the blocks are converted one by one.
+ *
+ * @param src           I1 pixels (without palette)
+ * @param src_stride    Source stride in bytes
+ * @param dst           Output pages, pixels out of the area are kept
+ * @param dst_stride    Output stride of one page in bytes
+ * @param x1            Left column of the area (inclusive)
+ * @param y1            Top row of the area (inclusive)
+ * @param x2            Right column of the area (inclusive)
+ * @param y2            Bottom row of the area (inclusive)
+ * @param swap_xy       Swap X and Y in the output
+ */
+void lvgl_port_i1_to_pages(const uint8_t *src, uint32_t src_stride, uint8_t *dst, uint32_t dst_stride,
+                           int32_t x1, int32_t y1, int32_t x2, int32_t y2, bool swap_xy);
+
+#ifdef __cplusplus
+}
+#endif
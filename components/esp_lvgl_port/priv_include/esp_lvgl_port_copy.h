@@ -0,0 +1,97 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port asynchronous copy of pixel data
+ *
+ * Copies are queued and the caller continues (e.g. LVGL renders the next band), until it waits for them. On SoCs with
+ * the async memcpy engine (GDMA/CP_DMA) the copies are done by DMA, on the host build by a worker thread. Small copies,
+ * copies from or to PSRAM (the cache would have to be synchronized on aligned spans), copies the engine doesn't accept
+ * (e.g. memory not accessible by DMA) and the other SoCs use the CPU copy right away.
+ * It doesn't depend on LVGL, so it can be tested on host.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LVGL_PORT_COPY_MIN_ASYNC_BYTES  1024    /* Smaller copies are done by the CPU, setup of the engine costs more */
+
+/**
+ * @brief Called, when one copy is done
+ *
+ * With DMA, it is called from the interrupt and must be short. With the CPU copy, it is called before the submit returns.
+ *
+ * @param user_ctx  User data of the copy
+ */
+typedef void (*lvgl_port_copy_done_cb_t)(void *user_ctx);
+
+/**
+ * @brief Copy statistics
+ */
+typedef struct {
+    uint32_t    async;          /*!< Count of copies done by the engine */
+    uint64_t    async_bytes;    /*!< Bytes copied by the engine */
+    uint32_t    cpu;            /*!< Count of copies done by the CPU */
+    uint64_t    cpu_bytes;      /*!< Bytes copied by the CPU */
+} lvgl_port_copy_stats_t;
+
+/**
+ * @brief Copy service
+ */
+typedef struct lvgl_port_copy_s lvgl_port_copy_t;
+
+/**
+ * @brief Create copy service
+ *
+ * @param backlog   Maximum count of queued copies, more copies wait for the oldest one
+ * @return Copy service or NULL, when the engine can't be initialized
+ */
+lvgl_port_copy_t *lvgl_port_copy_new(uint32_t backlog);
+
+/**
+ * @brief Delete copy service, after all queued copies are done
+ */
+void lvgl_port_copy_del(lvgl_port_copy_t *copy);
+
+/**
+ * @brief Queue one copy
+ *
+ * Source and destination must not be changed until the copy is done. Queued copies must not overlap each other.
+ *
+ * @param copy      Copy service
+ * @param dst       Destination
+ * @param src       Source
+ * @param len       Length in bytes
+ * @param done_cb   Called, when the copy is done (optional)
+ * @param user_ctx  User data of the callback
+ */
+void lvgl_port_copy_submit(lvgl_port_copy_t *copy, void *dst, const void *src, size_t len, lvgl_port_copy_done_cb_t done_cb, void *user_ctx);
+
+/**
+ * @brief Wait until all queued copies are done
+ */
+void lvgl_port_copy_wait(lvgl_port_copy_t *copy);
+
+/**
+ * @brief Get statistics
+ *
+ * @param copy      Copy service
+ * @param stats     Output statistics
+ * @param reset     Reset statistics after reading
+ */
+void lvgl_port_copy_get_stats(lvgl_port_copy_t *copy, lvgl_port_copy_stats_t *stats, bool reset);
+
+#ifdef __cplusplus
+}
+#endif
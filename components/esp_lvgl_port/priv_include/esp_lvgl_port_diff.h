@@ -0,0 +1,129 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port shadow frame buffer diff
+ *
+ * The panel content is tracked as a hash of each segment of each row. A flushed area is compared with it
+ * and only windows of changed rows are sent. Monochrome OLED pages are small, so they are compared with a copy of the sent pages.
+ * It doesn't depend on LVGL or on ESP-IDF drivers, so it can be tested on host.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Width of one hashed segment of a row in pixels (flushed areas are rounded to it)
+ */
+#define LVGL_PORT_DIFF_SEG_PX       32
+
+/**
+ * @brief Columns of unchanged bytes, which are still sent inside of a span (cheaper than addressing of the next span on I2C)
+ */
+#define LVGL_PORT_DIFF_PAGE_GAP     8
+
+/**
+ * @brief Shadow of the panel content
+ */
+typedef struct {
+    uint32_t    *hashes;    /*!< Hash of each segment of each row (0: unknown content) */
+    uint32_t    width;      /*!< Panel width in pixels */
+    uint32_t    height;     /*!< Panel height in pixels */
+    uint32_t    segs;       /*!< Segments per row (stride of hashes) */
+} lvgl_port_diff_t;
+
+/**
+ * @brief Changed window of a flushed area
+ */
+typedef struct {
+    int32_t     x1;         /*!< Left column (inclusive) */
+    int32_t     y1;         /*!< Top row (inclusive) */
+    int32_t     x2;         /*!< Right column (inclusive) */
+    int32_t     y2;         /*!< Bottom row (inclusive) */
+    uint8_t     *data;      /*!< Pixels of the window (contiguous, stride is the window width) */
+} lvgl_port_diff_window_t;
+
+/**
+ * @brief Get count of hashes needed for a panel in any orientation
+ *
+ * @param width     Panel width in pixels
+ * @param height    Panel height in pixels
+ * @return Count of uint32_t hashes
+ */
+size_t lvgl_port_diff_get_hashes_count(uint32_t width, uint32_t height);
+
+/**
+ * @brief Set panel size and forget its content, so that the next flushes are sent whole
+ *
+ * @param diff      Shadow (hashes must hold lvgl_port_diff_get_hashes_count() of the panel)
+ * @param width     Panel width in pixels (it can be swapped with height after rotation)
+ * @param height    Panel height in pixels
+ */
+void lvgl_port_diff_reset(lvgl_port_diff_t *diff, uint32_t width, uint32_t height);
+
+/**
+ * @brief Round columns of an area out to segments
+ *
+ * @param diff      Shadow
+ * @param x1        Left column (inclusive), rounded down
+ * @param x2        Right column (inclusive), rounded up and clipped to the panel width
+ */
+void lvgl_port_diff_round_area(const lvgl_port_diff_t *diff, int32_t *x1, int32_t *x2);
+
+/**
+ * @brief Compare the flushed area with the shadow and get windows of changed rows
+ *
+ * The shadow is updated with the area, so all windows must be sent. Consecutive changed rows make one window,
+ * its columns are the union of the changed segments. Pixels of each window are moved in place to the beginning
+ * of its first row, so every window is contiguous.
+ *
+ * @note Segments, which are covered only partially, are always sent and their content becomes unknown.
+ * Unchanged rows can be sent in the last window, when the windows array is full.
+ *
+ * @param diff          Shadow
+ * @param buf           Pixels of the area (stride is the area width), modified in place
+ * @param px_size       Size of one pixel in bytes
+ * @param x1            Left column of the area (inclusive)
+ * @param y1            Top row of the area (inclusive)
+ * @param x2            Right column of the area (inclusive)
+ * @param y2            Bottom row of the area (inclusive)
+ * @param windows       Output windows
+ * @param max_windows   Size of the windows array (at least 1)
+ * @return Count of windows (0: nothing changed)
+ */
+uint32_t lvgl_port_diff_area(lvgl_port_diff_t *diff, uint8_t *buf, uint32_t px_size, int32_t x1, int32_t y1, int32_t x2, int32_t y2,
+                             lvgl_port_diff_window_t *windows, uint32_t max_windows);
+
+/**
+ * @brief Compare monochrome OLED pages with the sent ones and get changed spans
+ *
+ * Every page is 8 rows high and one byte per column. Changed columns of a page, which are closer than
+ * LVGL_PORT_DIFF_PAGE_GAP, make one span. The copy of sent pages is updated, so all spans must be sent.
+ *
+ * @note When the spans array is full, the last span is extended to whole pages up to the last page.
+ * Such span is contiguous, because the pages are full width.
+ *
+ * @param sent          Copy of the sent pages (width * page_count bytes)
+ * @param pages         Pages to be sent
+ * @param width         Width of a page in columns (bytes)
+ * @param page_count    Count of pages
+ * @param spans         Output spans (rows in pixels, data points into pages)
+ * @param max_spans     Size of the spans array (at least 1)
+ * @return Count of spans (0: nothing changed)
+ */
+uint32_t lvgl_port_diff_pages(uint8_t *sent, uint8_t *pages, uint32_t width, uint32_t page_count,
+                              lvgl_port_diff_window_t *spans, uint32_t max_spans);
+
+#ifdef __cplusplus
+}
+#endif
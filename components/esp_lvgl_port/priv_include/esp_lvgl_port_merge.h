@@ -0,0 +1,80 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port merging of invalidated areas by a flush cost model
+ *
+ * Each flushed area costs a transaction per band of the draw buffer (window commands and the transfer setup) plus
+ * the time of its pixels. A new invalidated area is grown over the area of the frame, which saves the most cost,
+ * while such an area exists. The grown area contains the merged ones, LVGL drops or joins them.
+ * It doesn't depend on LVGL or on ESP-IDF drivers, so it can be tested on host.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Areas of one frame, the same as LV_INV_BUF_SIZE of LVGL */
+#define LVGL_PORT_MERGE_AREAS_MAX   32
+
+/**
+ * @brief Area of the frame, end is inclusive
+ */
+typedef struct {
+    int32_t     x1;
+    int32_t     y1;
+    int32_t     x2;
+    int32_t     y2;
+} lvgl_port_merge_area_t;
+
+/**
+ * @brief Merging of the invalidated areas of one frame
+ */
+typedef struct {
+    uint32_t    trans_overhead_us;  /* Overhead of one flush transaction [us] */
+    uint32_t    bytes_per_us;       /* Throughput of the color data [bytes/us], 0: merging is disabled */
+    uint32_t    px_size;            /* Size of a pixel [bytes] */
+    uint32_t    buff_bytes;         /* Size of the draw buffer [bytes], for band count of an area */
+    lvgl_port_merge_area_t areas[LVGL_PORT_MERGE_AREAS_MAX]; /* Areas invalidated in this frame (after merging) */
+    uint32_t    count;
+} lvgl_port_merge_t;
+
+/**
+ * @brief Forget the areas of the frame (new frame)
+ */
+void lvgl_port_merge_reset(lvgl_port_merge_t *merge);
+
+/**
+ * @brief Flush cost of the area
+ *
+ * @param merge     Merging with the cost model
+ * @param area      Area
+ * @param trans     Count of the transactions of the area (bands of the draw buffer), set
+ * @return Cost [ns]
+ */
+uint64_t lvgl_port_merge_area_cost(const lvgl_port_merge_t *merge, const lvgl_port_merge_area_t *area, uint32_t *trans);
+
+/**
+ * @brief Grow the invalidated area over the areas of the frame, while it saves cost, and remember it
+ *
+ * @note Areas inside of the grown one are merged too, but they are not counted: LVGL would join them anyway.
+ *
+ * @param merge         Merging with the cost model (bytes_per_us must not be 0)
+ * @param area          Invalidated area, updated
+ * @param trans_saved   Transactions saved by the counted merges, incremented
+ * @return Count of the merged areas, which LVGL would not join
+ */
+uint32_t lvgl_port_merge_area(lvgl_port_merge_t *merge, lvgl_port_merge_area_t *area, uint32_t *trans_saved);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,123 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port frame pacing
+ *
+ * Frames start on a fixed cadence. Invalidations between two frame starts are coalesced into the next frame and
+ * the LVGL task sleeps until then. A frame, which overruns its period, skips the periods it took, so the next frames
+ * stay on the cadence instead of catching up. After an idle time the cadence starts again with the next frame.
+ * It doesn't depend on LVGL or on ESP-IDF drivers, so it can be tested on host.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Frame pacing statistics
+ */
+typedef struct {
+    uint32_t    frames;         /*!< Count of refreshed frames */
+    uint32_t    late;           /*!< Count of refreshed frames, which overran their period */
+    uint32_t    missed;         /*!< Count of periods skipped by the late frames */
+    uint64_t    work_us;        /*!< Total time of the refreshed frames, from the start to the end of the LVGL work [us] */
+    uint32_t    work_max_us;    /*!< Longest refreshed frame [us] */
+    uint64_t    slack_us;       /*!< Total time left to the next frame start after the frames in time [us] */
+    uint32_t    slack_min_us;   /*!< Shortest time left after a frame in time [us] */
+    uint32_t    intervals;      /*!< Count of measured intervals between starts of two refreshed frames in a row */
+    uint32_t    interval_avg_us;/*!< Average interval [us] */
+    uint32_t    interval_dev_us;/*!< Standard deviation of the intervals [us] */
+    uint64_t    elapsed_us;     /*!< Time since the statistics were reset [us] */
+} lvgl_port_pace_stats_t;
+
+/**
+ * @brief Frame pacing state
+ */
+typedef struct {
+    uint32_t    period_us;      /* Frame period (0: pacing is disabled) */
+    bool        started;        /* The cadence is running */
+    int64_t     next_us;        /* Start of the next frame */
+    int64_t     start_us;       /* Start of the current frame */
+    bool        refresh;        /* The current frame refreshes the displays */
+    /* Statistics */
+    int64_t     reset_us;
+    uint32_t    frames;
+    uint32_t    late;
+    uint32_t    missed;
+    uint64_t    work_us;
+    uint32_t    work_max_us;
+    uint64_t    slack_us;
+    uint32_t    slack_min_us;
+    uint32_t    intervals;
+    uint64_t    interval_sum;
+    uint64_t    interval_sq_sum;
+} lvgl_port_pace_t;
+
+/**
+ * @brief Initialize frame pacing
+ *
+ * @param pace      Pacing state
+ * @param period_us Frame period (0: pacing is disabled)
+ * @param now_us    Current time
+ */
+void lvgl_port_pace_init(lvgl_port_pace_t *pace, uint32_t period_us, int64_t now_us);
+
+/**
+ * @brief Get time to the start of the next frame
+ *
+ * @param pace      Pacing state
+ * @param now_us    Current time
+ * @return Microseconds to sleep (0: the frame starts now)
+ */
+uint32_t lvgl_port_pace_get_wait(const lvgl_port_pace_t *pace, int64_t now_us);
+
+/**
+ * @brief Start a frame
+ *
+ * The frame is in time, when it starts less than one period after its start time. Otherwise the LVGL task was idle
+ * and the cadence starts again now.
+ *
+ * @param pace      Pacing state
+ * @param now_us    Current time
+ * @param refresh   Something was invalidated since the last frame (only refreshed frames are measured)
+ */
+void lvgl_port_pace_frame_start(lvgl_port_pace_t *pace, int64_t now_us, bool refresh);
+
+/**
+ * @brief End the frame, when LVGL finished its work
+ *
+ * @param pace      Pacing state
+ * @param now_us    Current time
+ */
+void lvgl_port_pace_frame_end(lvgl_port_pace_t *pace, int64_t now_us);
+
+/**
+ * @brief Get statistics
+ *
+ * @param pace      Pacing state
+ * @param now_us    Current time
+ * @param stats     Output statistics
+ */
+void lvgl_port_pace_get_stats(const lvgl_port_pace_t *pace, int64_t now_us, lvgl_port_pace_stats_t *stats);
+
+/**
+ * @brief Reset statistics
+ *
+ * @param pace      Pacing state
+ * @param now_us    Current time
+ */
+void lvgl_port_pace_reset_stats(lvgl_port_pace_t *pace, int64_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -42,6 +42,15 @@ typedef struct {
  */
 bool lvgl_port_task_notify(uint32_t value);
 
+/**
+ * @brief Get LVGL task priority
+ *
+ * @note It is used for tasks, which serve the LVGL task (e.g. flush ring)
+ *
+ * @return LVGL task priority
+ */
+int lvgl_port_get_task_priority(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,30 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port pseudo-random generator
+ *
+ * The functions are public in esp_lvgl_port.h. This header doesn't depend on LVGL, so the generator can be tested on host.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void lvgl_port_rand_seed(uint64_t seed);
+
+uint32_t lvgl_port_rand(void);
+
+uint32_t lvgl_port_rand_bounded(uint32_t bound);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,83 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port replay and recording of the LVGL tick
+ *
+ * In replay mode the LVGL tick is advanced once per LVGL task cycle, by the recorded increments and then by the
+ * synthetic period. Recording stores the increment of the LVGL tick in every LVGL task cycle, so a recorded run
+ * replays with the same ticks in the same cycles.
+ * It doesn't depend on LVGL or on ESP-IDF drivers, so it can be tested on host.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Replayed clock
+ */
+typedef struct {
+    uint32_t        tick_period_ms;     /* Synthetic increment, after the recorded ones */
+    const uint32_t  *tick_deltas;       /* Recorded increments (optional) */
+    uint32_t        tick_deltas_count;
+    uint32_t        pos;                /* Next recorded increment */
+} lvgl_port_replay_t;
+
+/**
+ * @brief Recorded clock
+ */
+typedef struct {
+    uint32_t        *buf;               /* Recorded increments (NULL: not recording) */
+    uint32_t        len;
+    uint32_t        count;
+    uint32_t        last_tick;          /* LVGL tick in the last cycle */
+} lvgl_port_record_t;
+
+/**
+ * @brief Start replay from the first recorded increment
+ *
+ * @param replay            Replayed clock
+ * @param tick_period_ms    Synthetic increment [ms]
+ * @param tick_deltas       Recorded increments [ms] (NULL: only synthetic clock)
+ * @param tick_deltas_count Count of recorded increments
+ */
+void lvgl_port_replay_init(lvgl_port_replay_t *replay, uint32_t tick_period_ms, const uint32_t *tick_deltas, uint32_t tick_deltas_count);
+
+/**
+ * @brief Get the increment of the LVGL tick for the next LVGL task cycle
+ *
+ * @param replay    Replayed clock
+ * @return Increment [ms]
+ */
+uint32_t lvgl_port_replay_next(lvgl_port_replay_t *replay);
+
+/**
+ * @brief Start recording
+ *
+ * @param record    Recorded clock
+ * @param buf       Buffer for the increments (NULL: stop recording)
+ * @param len       Length of the buffer (recording stops, when it is full)
+ * @param tick      Current LVGL tick [ms]
+ */
+void lvgl_port_record_init(lvgl_port_record_t *record, uint32_t *buf, uint32_t len, uint32_t tick);
+
+/**
+ * @brief Record the increment of the LVGL tick since the last LVGL task cycle
+ *
+ * @param record    Recorded clock
+ * @param tick      Current LVGL tick [ms], it can overflow
+ */
+void lvgl_port_record_tick(lvgl_port_record_t *record, uint32_t tick);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,71 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port rounding of invalidated areas to the window alignment of the panel
+ *
+ * Some panel controllers accept only windows, which start and end on a multiple of columns or rows (e.g. even columns
+ * of AMOLED controllers), or which are not narrower than a minimum width. Invalidated areas are extended to the
+ * alignment before they are rendered. LVGL asks the same event for the height of the bands of the draw buffer,
+ * so the bands of an aligned area are aligned too. The resolution of the panel must be a multiple of the alignment,
+ * the grid then starts at 0 in any rotation.
+ * It doesn't depend on LVGL or on ESP-IDF drivers, so it can be tested on host.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Rounding of one axis
+ */
+typedef struct {
+    int32_t     align;      /* Start and end+1 of the area are multiples of align */
+    int32_t     min;        /* Minimum length, multiple of align */
+    int32_t     res;        /* Resolution, multiple of align */
+} lvgl_port_rounder_axis_t;
+
+/**
+ * @brief Rounding of the areas in the current rotation
+ */
+typedef struct {
+    lvgl_port_rounder_axis_t x;
+    lvgl_port_rounder_axis_t y;
+} lvgl_port_rounder_t;
+
+/**
+ * @brief Initialize rounding for the current rotation
+ *
+ * @param rounder   Rounding
+ * @param hres      Horizontal resolution of the panel at rotation 0
+ * @param vres      Vertical resolution of the panel at rotation 0
+ * @param x_align   Alignment of the panel columns (0 or 1: any column), hres must be its multiple
+ * @param y_align   Alignment of the panel rows (0 or 1: any row), vres must be its multiple
+ * @param min_width Minimum width in panel columns (0: any width)
+ * @param swap_xy   Rotation by 90 or 270 degrees, columns of the panel are rows of the screen
+ */
+void lvgl_port_rounder_init(lvgl_port_rounder_t *rounder, uint32_t hres, uint32_t vres, uint32_t x_align, uint32_t y_align, uint32_t min_width, bool swap_xy);
+
+/**
+ * @brief Extend the area to the alignment and the minimum width, inside of the screen
+ *
+ * @param rounder   Rounding
+ * @param x1        Left column of the area, updated
+ * @param y1        Top row of the area, updated
+ * @param x2        Right column of the area (inclusive), updated
+ * @param y2        Bottom row of the area (inclusive), updated
+ */
+void lvgl_port_rounder_area(const lvgl_port_rounder_t *rounder, int32_t *x1, int32_t *y1, int32_t *x2, int32_t *y2);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port synchronization of two frame buffers in direct mode
+ *
+ * In direct mode with two frame buffers, LVGL redraws only the invalid areas into the back buffer. After the buffers
+ * are swapped, the new back buffer is one frame old, so the areas of the last frame are copied into it from the shown
+ * buffer. Rows of the areas are joined, so overlapping areas are copied once and full-width rows are copied as one span.
+ * It doesn't depend on LVGL or on ESP-IDF drivers, so it can be tested on host.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LVGL_PORT_SYNC_AREAS_MAX    32  /* More areas in one frame are synchronized as the whole frame */
+
+/**
+ * @brief Area of the frame, end is inclusive
+ */
+typedef struct {
+    int32_t     x1;
+    int32_t     y1;
+    int32_t     x2;
+    int32_t     y2;
+} lvgl_port_sync_area_t;
+
+/**
+ * @brief Areas of one frame
+ */
+typedef struct {
+    lvgl_port_sync_area_t areas[LVGL_PORT_SYNC_AREAS_MAX];
+    uint32_t    count;
+    bool        full;       /* The whole frame is synchronized */
+} lvgl_port_sync_t;
+
+/**
+ * @brief Copy of a span of the frame buffer
+ *
+ * @param dst       Destination in the back buffer
+ * @param src       Source in the shown buffer
+ * @param len       Length in bytes
+ * @param user_ctx  User data
+ */
+typedef void (*lvgl_port_sync_copy_cb_t)(void *dst, const void *src, size_t len, void *user_ctx);
+
+/**
+ * @brief Remove all areas
+ */
+void lvgl_port_sync_reset(lvgl_port_sync_t *sync);
+
+/**
+ * @brief Add area drawn in this frame, areas inside of another area are not added
+ */
+void lvgl_port_sync_add_area(lvgl_port_sync_t *sync, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+
+/**
+ * @brief Copy the areas of the frame from the shown buffer into the back buffer
+ *
+ * Pixels covered by more areas are copied once. Spans, which continue in memory (e.g. full-width rows), are joined.
+ *
+ * @param sync      Areas of the frame
+ * @param dst       Back buffer
+ * @param src       Shown buffer
+ * @param hres      Width of the frame buffers [pixels], it is the stride too
+ * @param vres      Height of the frame buffers [pixels]
+ * @param px_size   Bytes per pixel
+ * @param copy      Copy of one span
+ * @param user_ctx  User data of the copy
+ * @return Copied bytes
+ */
+size_t lvgl_port_sync_copy(const lvgl_port_sync_t *sync, uint8_t *dst, const uint8_t *src, uint32_t hres, uint32_t vres, uint32_t px_size,
+                           lvgl_port_sync_copy_cb_t copy, void *user_ctx);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,52 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port tearing effect (TE) scheduling
+ *
+ * The panel scans its memory from the first to the last row once per TE period. A band written while the scan
+ * crosses its write position is shown half old and half new (tearing). The start of each band transfer is delayed
+ * until the scan stays on one side of the written rows for the whole transfer.
+ * It doesn't depend on LVGL or on ESP-IDF drivers, so it can be tested on host.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Scan timing of the panel
+ */
+typedef struct {
+    uint32_t    period_us;  /*!< TE period, time of one scan of the panel memory (0: not known) */
+    uint32_t    lines;      /*!< Rows of the panel memory in the scan direction */
+} lvgl_port_te_timing_t;
+
+/**
+ * @brief Get delay of a band transfer, so that the scan doesn't cross its write position
+ *
+ * The porches are counted as a part of the period, proportionally to the rows.
+ *
+ * @param te            Scan timing
+ * @param since_te_us   Time since the last TE pulse (scan of row 0)
+ * @param y1            First row of the band in the scan direction (inclusive)
+ * @param y2            Last row of the band (inclusive)
+ * @param down          Rows are written in the scan direction (false: written upwards, or all rows of the band
+ *                      at once, e.g. with swapped XY)
+ * @param trans_us      Time of the band transfer
+ * @return Delay in microseconds (0: start now, or the band can't be sent without tearing)
+ */
+uint32_t lvgl_port_te_get_delay(const lvgl_port_te_timing_t *te, uint32_t since_te_us, int32_t y1, int32_t y2, bool down, uint32_t trans_us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,71 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port visible window of the panel
+ *
+ * Only a part of the screen can be visible on the panel: a window under the cover glass, with rounded corners or round.
+ * Invalidated areas are clipped to the bounding box of their visible pixels, so the pixels out of the window are not
+ * rendered. Pixel is visible, when its center is inside of the window. Widest row of an area is its row nearest
+ * to the vertical center of the window, so the columns are clipped by one row and the rows by one column.
+ * It doesn't depend on LVGL or on ESP-IDF drivers, so it can be tested on host.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Visible window, end is inclusive
+ */
+typedef struct {
+    int32_t     x1;
+    int32_t     y1;
+    int32_t     x2;
+    int32_t     y2;
+    int32_t     radius;     /* Radius of the corners (0: rectangle) */
+} lvgl_port_visible_t;
+
+/**
+ * @brief Initialize the visible window
+ *
+ * @note The radius is limited to half of the shorter side, the window is a circle or a stadium then.
+ *
+ * @param vis       Visible window
+ * @param x1        Left column
+ * @param y1        Top row
+ * @param x2        Right column (inclusive)
+ * @param y2        Bottom row (inclusive)
+ * @param radius    Radius of the corners (0: rectangle)
+ */
+void lvgl_port_visible_init(lvgl_port_visible_t *vis, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t radius);
+
+/**
+ * @brief Check, if the pixel is visible
+ */
+bool lvgl_port_visible_pixel(const lvgl_port_visible_t *vis, int32_t x, int32_t y);
+
+/**
+ * @brief Clip the area to the bounding box of its visible pixels
+ *
+ * @param vis       Visible window
+ * @param x1        Left column of the area, updated
+ * @param y1        Top row of the area, updated
+ * @param x2        Right column of the area (inclusive), updated
+ * @param y2        Bottom row of the area (inclusive), updated
+ * @return False, if no pixel of the area is visible (the area is not changed)
+ */
+bool lvgl_port_visible_clip(const lvgl_port_visible_t *vis, int32_t *x1, int32_t *y1, int32_t *x2, int32_t *y2);
+
+#ifdef __cplusplus
+}
+#endif
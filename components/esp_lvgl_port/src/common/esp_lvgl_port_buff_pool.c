@@ -0,0 +1,240 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include "sdkconfig.h"
+#include "esp_lvgl_port_buff_pool.h"
+
+#if defined(ESP_PLATFORM) && !CONFIG_IDF_TARGET_LINUX
+#define LVGL_PORT_BUFF_POOL_RTOS    1
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#else
+/* Host build: mutex and condition instead of the semaphore, the IO callback runs in a thread */
+#include <pthread.h>
+#include <time.h>
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    bool            given;
+} lvgl_port_buff_pool_sem_t;
+#endif
+
+/*******************************************************************************
+* Local functions
+*******************************************************************************/
+
+#if LVGL_PORT_BUFF_POOL_RTOS
+
+static void *lvgl_port_buff_pool_sem_new(void)
+{
+    return xSemaphoreCreateBinary();
+}
+
+static void lvgl_port_buff_pool_sem_del(void *sem)
+{
+    vSemaphoreDelete((SemaphoreHandle_t)sem);
+}
+
+static bool lvgl_port_buff_pool_sem_take(void *sem, uint32_t wait_ms)
+{
+    return (xSemaphoreTake((SemaphoreHandle_t)sem, pdMS_TO_TICKS(wait_ms)) == pdTRUE);
+}
+
+static bool lvgl_port_buff_pool_sem_give(void *sem)
+{
+    /* The FromISR call is safe in the task too */
+    BaseType_t need_yield = pdFALSE;
+    xSemaphoreGiveFromISR((SemaphoreHandle_t)sem, &need_yield);
+    return (need_yield == pdTRUE);
+}
+
+static void *lvgl_port_buff_pool_malloc(uint32_t size, uint32_t caps)
+{
+    return heap_caps_malloc(size, caps);
+}
+
+static int64_t lvgl_port_buff_pool_time_us(void)
+{
+    return esp_timer_get_time();
+}
+
+#else
+
+static void *lvgl_port_buff_pool_sem_new(void)
+{
+    lvgl_port_buff_pool_sem_t *sem = calloc(1, sizeof(lvgl_port_buff_pool_sem_t));
+    if (sem) {
+        pthread_mutex_init(&sem->lock, NULL);
+        pthread_cond_init(&sem->cond, NULL);
+    }
+    return sem;
+}
+
+static void lvgl_port_buff_pool_sem_del(void *sem)
+{
+    lvgl_port_buff_pool_sem_t *s = sem;
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->lock);
+    free(s);
+}
+
+static bool lvgl_port_buff_pool_sem_take(void *sem, uint32_t wait_ms)
+{
+    lvgl_port_buff_pool_sem_t *s = sem;
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += wait_ms / 1000;
+    until.tv_nsec += (long)(wait_ms % 1000) * 1000000;
+    if (until.tv_nsec >= 1000000000) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&s->lock);
+    while (!s->given && wait_ms && pthread_cond_timedwait(&s->cond, &s->lock, &until) == 0) {
+    }
+    const bool taken = s->given;
+    s->given = false;
+    pthread_mutex_unlock(&s->lock);
+    return taken;
+}
+
+static bool lvgl_port_buff_pool_sem_give(void *sem)
+{
+    lvgl_port_buff_pool_sem_t *s = sem;
+    pthread_mutex_lock(&s->lock);
+    s->given = true;
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+    return false;
+}
+
+static void *lvgl_port_buff_pool_malloc(uint32_t size, uint32_t caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+static int64_t lvgl_port_buff_pool_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+#endif
+
+/* Wait for the last band sent from the buffers, nobody owns them then */
+static void lvgl_port_buff_pool_release(lvgl_port_buff_pool_t *pool)
+{
+    lvgl_port_buff_pool_user_t *owner = pool->owner;
+    if (owner == NULL) {
+        return;
+    }
+
+    /* The semaphore was taken, when the band was sent, it is given after in_flight is cleared */
+    if (owner->in_flight) {
+        const int64_t start = lvgl_port_buff_pool_time_us();
+        if (!lvgl_port_buff_pool_sem_take(owner->done, LVGL_PORT_BUFF_POOL_WAIT_MS)) {
+            pool->timeouts++;
+        }
+        pool->waits++;
+        pool->wait_us += lvgl_port_buff_pool_time_us() - start;
+    }
+    pool->owner = NULL;
+}
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+bool lvgl_port_buff_pool_add(lvgl_port_buff_pool_t *pool, lvgl_port_buff_pool_user_t *user, uint32_t size, uint8_t count, uint32_t caps)
+{
+    if ((pool->users && pool->caps != caps) || count == 0 || count > LVGL_PORT_BUFF_POOL_BUFFS) {
+        return false;
+    }
+    user->done = lvgl_port_buff_pool_sem_new();
+    if (user->done == NULL) {
+        return false;
+    }
+    user->in_flight = false;
+
+    /* Bigger buffers replace the old ones, so nobody can render into them now */
+    lvgl_port_buff_pool_release(pool);
+    for (int i = 0; i < count; i++) {
+        if (pool->sizes[i] >= size) {
+            continue;
+        }
+        void *buff = lvgl_port_buff_pool_malloc(size, caps);
+        if (buff == NULL) {
+            lvgl_port_buff_pool_sem_del(user->done);
+            user->done = NULL;
+            return false;
+        }
+        free(pool->buffs[i]);
+        pool->buffs[i] = buff;
+        pool->sizes[i] = size;
+    }
+
+    pool->caps = caps;
+    pool->users++;
+    pool->private_bytes += size * count;
+    user->size = size;
+    user->count = count;
+    return true;
+}
+
+void lvgl_port_buff_pool_remove(lvgl_port_buff_pool_t *pool, lvgl_port_buff_pool_user_t *user)
+{
+    if (pool->owner == user) {
+        lvgl_port_buff_pool_release(pool);
+    }
+
+    pool->users--;
+    pool->private_bytes -= user->size * user->count;
+    user->count = 0;
+    if (pool->users == 0) {
+        for (int i = 0; i < LVGL_PORT_BUFF_POOL_BUFFS; i++) {
+            free(pool->buffs[i]);
+            pool->buffs[i] = NULL;
+            pool->sizes[i] = 0;
+        }
+    }
+    lvgl_port_buff_pool_sem_del(user->done);
+    user->done = NULL;
+}
+
+bool lvgl_port_buff_pool_borrow(lvgl_port_buff_pool_t *pool, lvgl_port_buff_pool_user_t *user)
+{
+    /* The display rendered the last frame, the buffers are set already */
+    if (pool->owner == user) {
+        return false;
+    }
+
+    if (pool->owner) {
+        pool->borrows++;
+    }
+    lvgl_port_buff_pool_release(pool);
+    pool->owner = user;
+    return true;
+}
+
+void lvgl_port_buff_pool_send(lvgl_port_buff_pool_user_t *user)
+{
+    /* Semaphore given by the last done band is not waited for */
+    lvgl_port_buff_pool_sem_take(user->done, 0);
+    user->in_flight = true;
+}
+
+bool lvgl_port_buff_pool_done(lvgl_port_buff_pool_user_t *user)
+{
+    user->in_flight = false;
+    return lvgl_port_buff_pool_sem_give(user->done);
+}
@@ -0,0 +1,244 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <string.h>
+#include "esp_lvgl_port_buff_tune.h"
+
+/* Neighbour candidates differ at least by this ratio */
+#define LVGL_PORT_BUFF_TUNE_RATIO       1.25
+/* Samples of the fits, older samples are weighted down by halving the sums */
+#define LVGL_PORT_BUFF_TUNE_FIT_MAX     1024
+#define LVGL_PORT_BUFF_TUNE_FIT_MIN     8
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+static void lvgl_port_buff_tune_fit_add(lvgl_port_buff_tune_fit_t *fit, int64_t x, int64_t y)
+{
+    if (fit->n >= LVGL_PORT_BUFF_TUNE_FIT_MAX) {
+        fit->n /= 2;
+        fit->sx /= 2;
+        fit->sxx /= 2;
+        fit->sy /= 2;
+        fit->sxy /= 2;
+    }
+    fit->n++;
+    fit->sx += x;
+    fit->sxx += x * x;
+    fit->sy += y;
+    fit->sxy += x * y;
+}
+
+/* Per band overhead (a) and time per pixel (b), the sizes of the bands must differ */
+static bool lvgl_port_buff_tune_fit_get(const lvgl_port_buff_tune_fit_t *fit, double *a, double *b)
+{
+    if (fit->n < LVGL_PORT_BUFF_TUNE_FIT_MIN) {
+        return false;
+    }
+
+    const double n = (double)fit->n;
+    const double mean = (double)fit->sx / n;
+    const double var = (double)fit->sxx / n - mean * mean;
+    if (var <= mean * mean / 10000.0) {
+        return false;
+    }
+
+    *b = ((double)fit->sxy / n - mean * (double)fit->sy / n) / var;
+    *a = (double)fit->sy / n - *b * mean;
+    /* Noisy samples, time can't go down with more pixels or bands */
+    if (*b < 0) {
+        *b = 0;
+        *a = (double)fit->sy / n;
+    } else if (*a < 0) {
+        *a = 0;
+        *b = (double)fit->sxy / (double)fit->sxx;
+    }
+    return true;
+}
+
+static void lvgl_port_buff_tune_area_close(lvgl_port_buff_tune_t *tune)
+{
+    if (!tune->area_valid) {
+        return;
+    }
+
+    /* LVGL splits the area into bands of the whole width */
+    const uint32_t w = tune->area_x2 - tune->area_x1 + 1;
+    const uint32_t h = tune->area_y2 - tune->area_y1 + 1;
+    for (int i = 0; i < tune->steps; i++) {
+        uint32_t rows = tune->sizes[i] / (w * tune->px_size);
+        if (rows == 0) {
+            rows = 1;
+        }
+        tune->bands[i] += (h + rows - 1) / rows;
+    }
+    tune->area_valid = false;
+}
+
+static void lvgl_port_buff_tune_window_reset(lvgl_port_buff_tune_t *tune)
+{
+    memset(tune->bands, 0, sizeof(tune->bands));
+    tune->pixels = 0;
+    tune->frames = 0;
+}
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+void lvgl_port_buff_tune_init(lvgl_port_buff_tune_t *tune, uint32_t px_size, uint8_t buffers, uint32_t line_bytes,
+                              uint32_t min_bytes, uint32_t max_bytes, uint32_t start_bytes, uint32_t window)
+{
+    memset(tune, 0, sizeof(lvgl_port_buff_tune_t));
+    tune->px_size = px_size;
+    tune->buffers = buffers;
+    tune->window = (window ? window : 1);
+
+    /* Whole lines, at least one */
+    uint32_t min_lines = (min_bytes + line_bytes - 1) / line_bytes;
+    uint32_t max_lines = max_bytes / line_bytes;
+    if (min_lines == 0) {
+        min_lines = 1;
+    }
+    if (max_lines < min_lines) {
+        max_lines = min_lines;
+    }
+
+    int steps = 1;
+    if (max_lines > min_lines) {
+        steps = 1 + (int)ceil(log((double)max_lines / min_lines) / log(LVGL_PORT_BUFF_TUNE_RATIO));
+        if (steps > LVGL_PORT_BUFF_TUNE_STEPS) {
+            steps = LVGL_PORT_BUFF_TUNE_STEPS;
+        }
+    }
+
+    /* Geometric steps, lines are rounded down, so the same line count can repeat with small sizes */
+    const double ratio = (steps > 1 ? pow((double)max_lines / min_lines, 1.0 / (steps - 1)) : 1.0);
+    for (int i = 0; i < steps; i++) {
+        const uint32_t lines = (i == steps - 1 ? max_lines : (uint32_t)(min_lines * pow(ratio, i)));
+        const uint32_t size = lines * line_bytes;
+        if (tune->steps == 0 || size > tune->sizes[tune->steps - 1]) {
+            tune->sizes[tune->steps++] = size;
+        }
+    }
+
+    for (int i = 0; i < tune->steps; i++) {
+        if (tune->sizes[i] <= start_bytes) {
+            tune->current = i;
+        }
+    }
+}
+
+void lvgl_port_buff_tune_add_band(lvgl_port_buff_tune_t *tune, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t render_us)
+{
+    const uint32_t pixels = (uint32_t)(x2 - x1 + 1) * (y2 - y1 + 1);
+    lvgl_port_buff_tune_fit_add(&tune->render, pixels, render_us);
+    tune->pixels += pixels;
+
+    /* Next band of the same area */
+    if (tune->area_valid && x1 == tune->area_x1 && x2 == tune->area_x2 && y1 == tune->area_y2 + 1) {
+        tune->area_y2 = y2;
+        return;
+    }
+
+    lvgl_port_buff_tune_area_close(tune);
+    tune->area_x1 = x1;
+    tune->area_x2 = x2;
+    tune->area_y1 = y1;
+    tune->area_y2 = y2;
+    tune->area_valid = true;
+}
+
+void lvgl_port_buff_tune_add_flush(lvgl_port_buff_tune_t *tune, uint32_t pixels, uint32_t flush_us)
+{
+    lvgl_port_buff_tune_fit_add(&tune->flush, pixels, flush_us);
+}
+
+uint32_t lvgl_port_buff_tune_frame_done(lvgl_port_buff_tune_t *tune)
+{
+    /* Nothing was flushed */
+    if (!tune->area_valid) {
+        return 0;
+    }
+    lvgl_port_buff_tune_area_close(tune);
+
+    if (++tune->frames < tune->window) {
+        return 0;
+    }
+
+    double ra, rb, fa, fb;
+    if (!lvgl_port_buff_tune_fit_get(&tune->render, &ra, &rb) || !lvgl_port_buff_tune_fit_get(&tune->flush, &fa, &fb)) {
+        lvgl_port_buff_tune_window_reset(tune);
+        return 0;
+    }
+
+    /*
+     * Frame time of the same frames with each candidate. With two buffers, rendering and flushing overlap,
+     * the slower one takes the whole frame, plus one band of the faster one at the start of the frame.
+     */
+    double time[LVGL_PORT_BUFF_TUNE_STEPS];
+    double best = 0;
+    for (int i = 0; i < tune->steps; i++) {
+        const double bands = (double)tune->bands[i];
+        const double render = bands * ra + (double)tune->pixels * rb;
+        const double flush = bands * fa + (double)tune->pixels * fb;
+        if (tune->buffers >= 2) {
+            time[i] = fmax(render, flush) + tune->frames * fmin(render, flush) / bands;
+        } else {
+            time[i] = render + flush;
+        }
+        time[i] /= tune->frames;
+        tune->predicted_us[i] = (uint32_t)time[i];
+        if (i == 0 || time[i] < best) {
+            best = time[i];
+        }
+    }
+
+    /*
+     * The smallest buffer within 1/16 of the best frame time. Hysteresis: the current size is left, when it is worse
+     * than 1/16, and a smaller size is taken, when it is within 1/32, so noise doesn't switch neighbour sizes.
+     */
+    int next = tune->current;
+    if (time[tune->current] * 16 > best * 17) {
+        for (next = 0; time[next] * 16 > best * 17; next++) {
+        }
+    } else {
+        for (int i = 0; i < tune->current; i++) {
+            if (time[i] * 32 <= best * 33) {
+                next = i;
+                break;
+            }
+        }
+    }
+
+    lvgl_port_buff_tune_window_reset(tune);
+    if (next == tune->current) {
+        tune->stable++;
+        return 0;
+    }
+    tune->current = next;
+    tune->stable = 0;
+    return tune->sizes[next];
+}
+
+void lvgl_port_buff_tune_limit(lvgl_port_buff_tune_t *tune, uint32_t size)
+{
+    int steps = 0;
+    while (steps < tune->steps && tune->sizes[steps] < size) {
+        steps++;
+    }
+    if (steps == LVGL_PORT_BUFF_TUNE_STEPS) {
+        steps--;
+    }
+    tune->sizes[steps] = size;
+    tune->steps = steps + 1;
+    tune->current = steps;
+    tune->stable = 0;
+    tune->area_valid = false;
+    lvgl_port_buff_tune_window_reset(tune);
+}
@@ -0,0 +1,31 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_lvgl_port_chain.h"
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+void lvgl_port_chain_reset(lvgl_port_chain_t *chain)
+{
+    chain->valid = false;
+}
+
+bool lvgl_port_chain_band(lvgl_port_chain_t *chain, int32_t x_start, int32_t y_start, int32_t x_end, int32_t y_end, int32_t vres, bool byte_end, int32_t *win_y_end)
+{
+    /* Next band of the same area: the panel continues writing below the last band */
+    const bool chained = (chain->valid && x_start == chain->x_start && x_end == chain->x_end && y_start == chain->y_end);
+
+    chain->valid = byte_end;
+    chain->x_start = x_start;
+    chain->x_end = x_end;
+    chain->y_end = y_end;
+
+    /* The window is open to the bottom of the panel, the panel stops writing after the sent pixels */
+    *win_y_end = vres;
+    return chained;
+}
@@ -0,0 +1,572 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_lvgl_port_color.h"
+
+#define LVGL_PORT_MIN(a, b)     ((a) < (b) ? (a) : (b))
+#define LVGL_PORT_MAX(a, b)     ((a) > (b) ? (a) : (b))
+
+#if CONFIG_IDF_TARGET_ESP32S3
+/* Shorter buffers are not worth the PIE setup */
+#define LVGL_PORT_SWAP_PIE_MIN_PX   16
+
+extern void lvgl_port_rgb565_swap_esp(void *buf, uint32_t len_px);
+#endif
+
+/*******************************************************************************
+* Local functions
+*******************************************************************************/
+
+static inline uint16_t swap16(uint16_t c)
+{
+    return (uint16_t)((c >> 8) | (c << 8));
+}
+
+/* Swap bytes in both pixels of a word */
+static inline uint32_t swap16x2(uint32_t w)
+{
+    return ((w & 0x00FF00FFu) << 8) | ((w >> 8) & 0x00FF00FFu);
+}
+
+static inline bool is_word_aligned(const void *src, const void *dst, int32_t src_stride, int32_t dst_stride)
+{
+    return (((uintptr_t)src | (uintptr_t)dst | (uintptr_t)src_stride | (uintptr_t)dst_stride) & 3) == 0;
+}
+
+static void rotate_swap_0(const uint8_t *src, uint8_t *dst, int32_t w, int32_t h, int32_t src_stride, int32_t dst_stride, bool swap)
+{
+    for (int32_t y = 0; y < h; y++) {
+        const uint16_t *s = (const uint16_t *)(src + y * src_stride);
+        uint16_t *d = (uint16_t *)(dst + y * dst_stride);
+        if (!swap) {
+            if (s != d) {
+                memmove(d, s, w * sizeof(uint16_t));
+            }
+            continue;
+        }
+        for (int32_t x = 0; x < w; x++) {
+            d[x] = swap16(s[x]);
+        }
+    }
+}
+
+static void rotate_swap_180(const uint8_t *src, uint8_t *dst, int32_t w, int32_t h, int32_t src_stride, int32_t dst_stride, bool swap)
+{
+    /* Two pixels per word: reversing the pixel order in a word and swapping bytes is one bswap32 */
+    const bool word = is_word_aligned(src, dst, src_stride, dst_stride) && (w % 2 == 0);
+
+    for (int32_t y = 0; y < h; y++) {
+        const uint16_t *s = (const uint16_t *)(src + y * src_stride);
+        uint16_t *d = (uint16_t *)(dst + (h - 1 - y) * dst_stride);
+        if (word) {
+            const uint32_t *s32 = (const uint32_t *)s;
+            uint32_t *d32 = (uint32_t *)d + (w / 2 - 1);
+            for (int32_t x = 0; x < w / 2; x++) {
+                uint32_t v = s32[x];
+                *d32-- = swap ? __builtin_bswap32(v) : ((v >> 16) | (v << 16));
+            }
+        } else {
+            for (int32_t x = 0; x < w; x++) {
+                d[w - 1 - x] = swap ? swap16(s[x]) : s[x];
+            }
+        }
+    }
+}
+
+/* dst[(w - 1 - x), y] = src[y, x] for a rectangle of the source */
+static void rotate_swap_90_rect(const uint8_t *src, uint8_t *dst, int32_t w, int32_t src_stride, int32_t dst_stride,
+                                int32_t x0, int32_t x1, int32_t y0, int32_t y1, bool swap)
+{
+    for (int32_t x = x0; x < x1; x++) {
+        uint16_t *d = (uint16_t *)(dst + (w - 1 - x) * dst_stride);
+        for (int32_t y = y0; y < y1; y++) {
+            uint16_t c = *(const uint16_t *)(src + y * src_stride + x * 2);
+            d[y] = swap ? swap16(c) : c;
+        }
+    }
+}
+
+/* dst[x, (h - 1 - y)] = src[y, x] for a rectangle of the source */
+static void rotate_swap_270_rect(const uint8_t *src, uint8_t *dst, int32_t h, int32_t src_stride, int32_t dst_stride,
+                                 int32_t x0, int32_t x1, int32_t y0, int32_t y1, bool swap)
+{
+    for (int32_t x = x0; x < x1; x++) {
+        uint16_t *d = (uint16_t *)(dst + x * dst_stride);
+        for (int32_t y = y0; y < y1; y++) {
+            uint16_t c = *(const uint16_t *)(src + y * src_stride + x * 2);
+            d[h - 1 - y] = swap ? swap16(c) : c;
+        }
+    }
+}
+
+static void rotate_swap_90_270(const uint8_t *src, uint8_t *dst, int32_t w, int32_t h, int32_t src_stride, int32_t dst_stride,
+                               bool rot_270, bool swap)
+{
+    /*
+     * Word path transposes 2x2 pixel blocks: two word loads (two pixels from two source rows)
+     * and two word stores (two pixels in two destination rows). For 270 the destination pair starts at (h - 2 - y),
+     * so it is word aligned only for even height.
+     */
+    const bool word = is_word_aligned(src, dst, src_stride, dst_stride) && (!rot_270 || (h % 2 == 0));
+    const int32_t w_even = word ? (w & ~1) : 0;
+    const int32_t h_even = word ? (h & ~1) : 0;
+
+    for (int32_t y0 = 0; y0 < h; y0 += LVGL_PORT_ROTATE_TILE) {
+        const int32_t y1 = LVGL_PORT_MIN(y0 + LVGL_PORT_ROTATE_TILE, h);
+        const int32_t ye = LVGL_PORT_MAX(y0, LVGL_PORT_MIN(y1, h_even));
+        for (int32_t x0 = 0; x0 < w; x0 += LVGL_PORT_ROTATE_TILE) {
+            const int32_t x1 = LVGL_PORT_MIN(x0 + LVGL_PORT_ROTATE_TILE, w);
+            const int32_t xe = LVGL_PORT_MAX(x0, LVGL_PORT_MIN(x1, w_even));
+
+            for (int32_t x = x0; x < xe; x += 2) {
+                uint32_t *d0;
+                uint32_t *d1;
+                if (rot_270) {
+                    d0 = (uint32_t *)(dst + x * dst_stride);
+                    d1 = (uint32_t *)(dst + (x + 1) * dst_stride);
+                } else {
+                    d0 = (uint32_t *)(dst + (w - 1 - x) * dst_stride);
+                    d1 = (uint32_t *)(dst + (w - 2 - x) * dst_stride);
+                }
+                for (int32_t y = y0; y < ye; y += 2) {
+                    const uint32_t s0 = *(const uint32_t *)(src + y * src_stride + x * 2);
+                    const uint32_t s1 = *(const uint32_t *)(src + (y + 1) * src_stride + x * 2);
+                    uint32_t o0;
+                    uint32_t o1;
+                    if (rot_270) {
+                        o0 = (s1 & 0xFFFFu) | (s0 << 16);
+                        o1 = (s1 >> 16) | (s0 & 0xFFFF0000u);
+                    } else {
+                        o0 = (s0 & 0xFFFFu) | (s1 << 16);
+                        o1 = (s0 >> 16) | (s1 & 0xFFFF0000u);
+                    }
+                    if (swap) {
+                        o0 = swap16x2(o0);
+                        o1 = swap16x2(o1);
+                    }
+                    const int32_t i = rot_270 ? (h - 2 - y) / 2 : y / 2;
+                    d0[i] = o0;
+                    d1[i] = o1;
+                }
+            }
+
+            /* Odd column and odd row of the tile (or the whole tile, if not aligned) */
+            if (rot_270) {
+                rotate_swap_270_rect(src, dst, h, src_stride, dst_stride, xe, x1, y0, y1, swap);
+                rotate_swap_270_rect(src, dst, h, src_stride, dst_stride, x0, xe, ye, y1, swap);
+            } else {
+                rotate_swap_90_rect(src, dst, w, src_stride, dst_stride, xe, x1, y0, y1, swap);
+                rotate_swap_90_rect(src, dst, w, src_stride, dst_stride, x0, xe, ye, y1, swap);
+            }
+        }
+    }
+}
+
+/* One pixel of 2 (optionally swapped), 3 or 4 bytes */
+static inline void copy_px(uint8_t *d, const uint8_t *s, uint32_t px_size, bool swap)
+{
+    if (px_size == 2) {
+        uint16_t c;
+        memcpy(&c, s, 2);
+        c = swap ? swap16(c) : c;
+        memcpy(d, &c, 2);
+    } else if (px_size == 4) {
+        memcpy(d, s, 4);
+    } else {
+        d[0] = s[0];
+        d[1] = s[1];
+        d[2] = s[2];
+    }
+}
+
+static void rotate_px_0(const uint8_t *src, uint8_t *dst, int32_t w, int32_t h, int32_t src_stride, int32_t dst_stride, uint32_t px_size)
+{
+    for (int32_t y = 0; y < h; y++) {
+        if (src + y * src_stride != dst + y * dst_stride) {
+            memmove(dst + y * dst_stride, src + y * src_stride, w * px_size);
+        }
+    }
+}
+
+static void rotate_px_180(const uint8_t *src, uint8_t *dst, int32_t w, int32_t h, int32_t src_stride, int32_t dst_stride, uint32_t px_size)
+{
+    for (int32_t y = 0; y < h; y++) {
+        const uint8_t *s = src + y * src_stride;
+        uint8_t *d = dst + (h - 1 - y) * dst_stride + (w - 1) * px_size;
+        for (int32_t x = 0; x < w; x++) {
+            copy_px(d, s, px_size, false);
+            s += px_size;
+            d -= px_size;
+        }
+    }
+}
+
+/*
+ * 90/270 in tiles of LVGL_PORT_ROTATE_TILE x LVGL_PORT_ROTATE_TILE pixels.
+ * With a tile buffer, the tile is read by source rows into the buffer in destination order, then written
+ * by destination rows. Both buffers are accessed only by contiguous runs, so every cache line of PSRAM is filled
+ * and written back once, even when the strides map the rows of a tile to the same cache set.
+ * Without the buffer, the destination rows of the tile are written directly and the source is read by columns.
+ */
+static void rotate_px_90_270(const uint8_t *src, uint8_t *dst, int32_t w, int32_t h, int32_t src_stride, int32_t dst_stride,
+                             uint32_t px_size, bool rot_270, bool swap, uint8_t *tile_buf)
+{
+    for (int32_t y0 = 0; y0 < h; y0 += LVGL_PORT_ROTATE_TILE) {
+        const int32_t y1 = LVGL_PORT_MIN(y0 + LVGL_PORT_ROTATE_TILE, h);
+        const int32_t th = y1 - y0;
+        /* Destination columns of the tile: 90: y0..y1-1, 270: h-y1..h-1-y0 */
+        const int32_t dst_x = rot_270 ? h - y1 : y0;
+        for (int32_t x0 = 0; x0 < w; x0 += LVGL_PORT_ROTATE_TILE) {
+            const int32_t x1 = LVGL_PORT_MIN(x0 + LVGL_PORT_ROTATE_TILE, w);
+
+            if (tile_buf) {
+                /* Tile row (x - x0) is the destination row of source column x */
+                for (int32_t y = y0; y < y1; y++) {
+                    const uint8_t *s = src + y * src_stride + x0 * px_size;
+                    uint8_t *t = tile_buf + (rot_270 ? y1 - 1 - y : y - y0) * px_size;
+                    for (int32_t x = x0; x < x1; x++) {
+                        copy_px(t, s, px_size, swap);
+                        s += px_size;
+                        t += th * px_size;
+                    }
+                }
+                for (int32_t x = x0; x < x1; x++) {
+                    const int32_t dst_y = rot_270 ? x : w - 1 - x;
+                    memcpy(dst + dst_y * dst_stride + dst_x * px_size, tile_buf + (x - x0) * th * px_size, th * px_size);
+                }
+                continue;
+            }
+
+            for (int32_t x = x0; x < x1; x++) {
+                const int32_t dst_y = rot_270 ? x : w - 1 - x;
+                uint8_t *d = dst + dst_y * dst_stride + dst_x * px_size;
+                for (int32_t i = 0; i < th; i++) {
+                    const int32_t y = rot_270 ? y1 - 1 - i : y0 + i;
+                    copy_px(d, src + y * src_stride + x * px_size, px_size, swap);
+                    d += px_size;
+                }
+            }
+        }
+    }
+}
+
+/* 4x4 Bayer matrix, thresholds 0..15 */
+static const uint8_t bayer4[4][4] = {
+    { 0,  8,  2, 10},
+    {12,  4, 14,  6},
+    { 3, 11,  1,  9},
+    {15,  7, 13,  5},
+};
+
+static inline uint32_t rgb565_to_rgb444(uint16_t c)
+{
+    return ((c >> 4) & 0xF00) | ((c >> 3) & 0x0F0) | ((c >> 1) & 0x00F);
+}
+
+static inline uint32_t rgb565_to_rgb444_dither(uint16_t c, uint32_t t)
+{
+    /* Red and blue drop 1 bit, green drops 2 bits */
+    uint32_t r = ((c >> 11) + (t >> 3)) >> 1;
+    uint32_t g = (((c >> 5) & 0x3F) + (t >> 2)) >> 2;
+    uint32_t b = ((c & 0x1F) + (t >> 3)) >> 1;
+    r = LVGL_PORT_MIN(r, 15);
+    g = LVGL_PORT_MIN(g, 15);
+    b = LVGL_PORT_MIN(b, 15);
+    return (r << 8) | (g << 4) | b;
+}
+
+/* Two 12-bit pixels to three bytes */
+static inline void put_rgb444_pair(uint8_t *d, uint32_t p0, uint32_t p1)
+{
+    d[0] = (uint8_t)(p0 >> 4);
+    d[1] = (uint8_t)((p0 << 4) | (p1 >> 8));
+    d[2] = (uint8_t)p1;
+}
+
+/* The last odd pixel to two bytes */
+static inline void put_rgb444_last(uint8_t *d, uint32_t p0)
+{
+    d[0] = (uint8_t)(p0 >> 4);
+    d[1] = (uint8_t)(p0 << 4);
+}
+
+/* Pixel by pixel, for pixels out of the 8x8 blocks */
+static void i1_to_pages_rect(const uint8_t *src, uint32_t src_stride, uint8_t *dst, uint32_t dst_stride,
+                             int32_t x1, int32_t y1, int32_t x2, int32_t y2, bool swap_xy)
+{
+    for (int32_t y = y1; y <= y2; y++) {
+        for (int32_t x = x1; x <= x2; x++) {
+            const bool lit = src[src_stride * y + (x >> 3)] & (1 << (7 - (x & 7)));
+            const int32_t out_x = swap_xy ? y : x;
+            const int32_t out_y = swap_xy ? x : y;
+            uint8_t *out = dst + dst_stride * (out_y >> 3) + out_x;
+            if (lit) {
+                *out &= ~(1 << (out_y & 7));
+            } else {
+                *out |= (1 << (out_y & 7));
+            }
+        }
+    }
+}
+
+/*
+ * Transpose 8x8 bits: eight source rows of one byte column to eight page bytes (Hacker's Delight, transpose8).
+ * Rows are loaded in reverse order, so bit 0 of each output byte is the first row.
+ */
+static inline void i1_transpose8(const uint8_t *src, uint32_t src_stride, uint8_t *out)
+{
+    uint32_t x = ((uint32_t)src[7 * src_stride] << 24) | ((uint32_t)src[6 * src_stride] << 16) | ((uint32_t)src[5 * src_stride] << 8) | src[4 * src_stride];
+    uint32_t y = ((uint32_t)src[3 * src_stride] << 24) | ((uint32_t)src[2 * src_stride] << 16) | ((uint32_t)src[1 * src_stride] << 8) | src[0];
+    uint32_t t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AAu;
+    x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AAu;
+    y = y ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCCu;
+    x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCCu;
+    y = y ^ t ^ (t << 14);
+    t = (x & 0xF0F0F0F0u) | ((y >> 4) & 0x0F0F0F0Fu);
+    y = ((x << 4) & 0xF0F0F0F0u) | (y & 0x0F0F0F0Fu);
+    x = ~t;
+    y = ~y;
+
+    out[0] = (uint8_t)(x >> 24);
+    out[1] = (uint8_t)(x >> 16);
+    out[2] = (uint8_t)(x >> 8);
+    out[3] = (uint8_t)x;
+    out[4] = (uint8_t)(y >> 24);
+    out[5] = (uint8_t)(y >> 16);
+    out[6] = (uint8_t)(y >> 8);
+    out[7] = (uint8_t)y;
+}
+
+/* Reverse bits in each byte of the word */
+static inline uint32_t rev8x4(uint32_t v)
+{
+    v = ((v >> 1) & 0x55555555u) | ((v & 0x55555555u) << 1);
+    v = ((v >> 2) & 0x33333333u) | ((v & 0x33333333u) << 2);
+    return ((v >> 4) & 0x0F0F0F0Fu) | ((v & 0x0F0F0F0Fu) << 4);
+}
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+void lvgl_port_rgb565_rotate_swap(const void *src, void *dst, int32_t src_w, int32_t src_h, int32_t src_stride, int32_t dst_stride,
+                                  lvgl_port_color_rotation_t rotation, bool swap)
+{
+    switch (rotation) {
+    case LVGL_PORT_COLOR_ROTATION_90:
+        rotate_swap_90_270(src, dst, src_w, src_h, src_stride, dst_stride, false, swap);
+        break;
+    case LVGL_PORT_COLOR_ROTATION_180:
+        rotate_swap_180(src, dst, src_w, src_h, src_stride, dst_stride, swap);
+        break;
+    case LVGL_PORT_COLOR_ROTATION_270:
+        rotate_swap_90_270(src, dst, src_w, src_h, src_stride, dst_stride, true, swap);
+        break;
+    default:
+        rotate_swap_0(src, dst, src_w, src_h, src_stride, dst_stride, swap);
+        break;
+    }
+}
+
+void lvgl_port_rotate(const void *src, void *dst, int32_t src_w, int32_t src_h, int32_t src_stride, int32_t dst_stride,
+                      uint32_t px_size, lvgl_port_color_rotation_t rotation, bool swap, void *tile_buf)
+{
+    const bool rotated = (rotation == LVGL_PORT_COLOR_ROTATION_90 || rotation == LVGL_PORT_COLOR_ROTATION_270);
+
+    /* RGB565 in internal RAM: two pixels per word */
+    if (px_size == 2 && (tile_buf == NULL || !rotated)) {
+        lvgl_port_rgb565_rotate_swap(src, dst, src_w, src_h, src_stride, dst_stride, rotation, swap);
+        return;
+    }
+
+    switch (rotation) {
+    case LVGL_PORT_COLOR_ROTATION_90:
+        rotate_px_90_270(src, dst, src_w, src_h, src_stride, dst_stride, px_size, false, swap, tile_buf);
+        break;
+    case LVGL_PORT_COLOR_ROTATION_180:
+        rotate_px_180(src, dst, src_w, src_h, src_stride, dst_stride, px_size);
+        break;
+    case LVGL_PORT_COLOR_ROTATION_270:
+        rotate_px_90_270(src, dst, src_w, src_h, src_stride, dst_stride, px_size, true, swap, tile_buf);
+        break;
+    default:
+        rotate_px_0(src, dst, src_w, src_h, src_stride, dst_stride, px_size);
+        break;
+    }
+}
+
+size_t lvgl_port_rgb565_to_rgb444(const void *src, void *dst, int32_t w, int32_t h, int32_t x, int32_t y, bool dither)
+{
+    const uint16_t *s = (const uint16_t *)src;
+    uint8_t *d = (uint8_t *)dst;
+
+    /* Both pixels of a pair are read, before its three bytes are written (in place, output is never ahead of input) */
+    if (!dither) {
+        const uint32_t len_px = (uint32_t)(w * h);
+        uint32_t i = 0;
+        for (; i + 1 < len_px; i += 2) {
+            const uint32_t p0 = rgb565_to_rgb444(s[i]);
+            const uint32_t p1 = rgb565_to_rgb444(s[i + 1]);
+            put_rgb444_pair(d, p0, p1);
+            d += 3;
+        }
+        if (i < len_px) {
+            put_rgb444_last(d, rgb565_to_rgb444(s[i]));
+            d += 2;
+        }
+        return d - (uint8_t *)dst;
+    }
+
+    /* Row by row, the last pixel of an odd row is paired with the first pixel of the next row */
+    bool carry = false;
+    uint32_t carry_px = 0;
+    for (int32_t row = 0; row < h; row++) {
+        const uint16_t *s_row = s + row * w;
+        const uint8_t *t = bayer4[(y + row) & 3];
+        int32_t col = 0;
+        if (carry) {
+            put_rgb444_pair(d, carry_px, rgb565_to_rgb444_dither(s_row[0], t[x & 3]));
+            d += 3;
+            col = 1;
+            carry = false;
+        }
+        for (; col + 1 < w; col += 2) {
+            const uint32_t p0 = rgb565_to_rgb444_dither(s_row[col], t[(x + col) & 3]);
+            const uint32_t p1 = rgb565_to_rgb444_dither(s_row[col + 1], t[(x + col + 1) & 3]);
+            put_rgb444_pair(d, p0, p1);
+            d += 3;
+        }
+        if (col < w) {
+            carry_px = rgb565_to_rgb444_dither(s_row[col], t[(x + col) & 3]);
+            carry = true;
+        }
+    }
+    if (carry) {
+        put_rgb444_last(d, carry_px);
+        d += 2;
+    }
+    return d - (uint8_t *)dst;
+}
+
+void lvgl_port_i1_to_pages(const uint8_t *src, uint32_t src_stride, uint8_t *dst, uint32_t dst_stride,
+                           int32_t x1, int32_t y1, int32_t x2, int32_t y2, bool swap_xy)
+{
+    /* Blocks: columns and rows aligned to 8 inside of the area */
+    const int32_t bx1 = (x1 + 7) & ~7;
+    const int32_t bx2 = LVGL_PORT_MAX(bx1, (x2 + 1) & ~7);
+    const int32_t by1 = (y1 + 7) & ~7;
+    const int32_t by2 = LVGL_PORT_MAX(by1, (y2 + 1) & ~7);
+
+    if (bx1 < bx2 && by1 < by2) {
+        if (!swap_xy) {
+            for (int32_t y = by1; y < by2; y += 8) {
+                const uint8_t *s = src + src_stride * y + (bx1 >> 3);
+                uint8_t *d = dst + dst_stride * (y >> 3) + bx1;
+                for (int32_t x = bx1; x < bx2; x += 8) {
+                    i1_transpose8(s++, src_stride, d);
+                    d += 8;
+                }
+            }
+        } else {
+            /* Source byte is already one column of a page: reverse its bits, four bytes in a word */
+            for (int32_t y = by1; y < by2; y++) {
+                const uint8_t *s = src + src_stride * y + (bx1 >> 3);
+                uint8_t *d = dst + dst_stride * (bx1 >> 3) + y;
+                int32_t x = bx1;
+                for (; x + 32 <= bx2; x += 32) {
+                    const uint32_t v = ~rev8x4((uint32_t)s[0] | ((uint32_t)s[1] << 8) | ((uint32_t)s[2] << 16) | ((uint32_t)s[3] << 24));
+                    d[0] = (uint8_t)v;
+                    d[dst_stride] = (uint8_t)(v >> 8);
+                    d[2 * dst_stride] = (uint8_t)(v >> 16);
+                    d[3 * dst_stride] = (uint8_t)(v >> 24);
+                    s += 4;
+                    d += 4 * dst_stride;
+                }
+                for (; x < bx2; x += 8) {
+                    *d = (uint8_t)~rev8x4(*s++);
+                    d += dst_stride;
+                }
+            }
+        }
+    } else {
+        /* No block, all pixels are converted one by one */
+        i1_to_pages_rect(src, src_stride, dst, dst_stride, x1, y1, x2, y2, swap_xy);
+        return;
+    }
+
+    /* Pixels out of the blocks: rows above and below, columns left and right */
+    if (y1 < by1) {
+        i1_to_pages_rect(src, src_stride, dst, dst_stride, x1, y1, x2, by1 - 1, swap_xy);
+    }
+    if (by2 <= y2) {
+        i1_to_pages_rect(src, src_stride, dst, dst_stride, x1, by2, x2, y2, swap_xy);
+    }
+    if (x1 < bx1) {
+        i1_to_pages_rect(src, src_stride, dst, dst_stride, x1, by1, bx1 - 1, by2 - 1, swap_xy);
+    }
+    if (bx2 <= x2) {
+        i1_to_pages_rect(src, src_stride, dst, dst_stride, bx2, by1, x2, by2 - 1, swap_xy);
+    }
+}
+
+void lvgl_port_rgb565_swap(void *buf, uint32_t len_px)
+{
+#if CONFIG_IDF_TARGET_ESP32S3
+    if (len_px >= LVGL_PORT_SWAP_PIE_MIN_PX) {
+        lvgl_port_rgb565_swap_esp(buf, len_px);
+        return;
+    }
+#endif
+
+    uint16_t *buf16 = (uint16_t *)buf;
+
+    /* Align to word */
+    if (((uintptr_t)buf16 & 2) && len_px > 0) {
+        *buf16 = swap16(*buf16);
+        buf16++;
+        len_px--;
+    }
+
+    uint32_t *buf32 = (uint32_t *)buf16;
+    uint32_t words = len_px / 2;
+
+    /* Main loop, 8 pixels */
+    for (; words >= 4; words -= 4) {
+        uint32_t w0 = buf32[0];
+        uint32_t w1 = buf32[1];
+        uint32_t w2 = buf32[2];
+        uint32_t w3 = buf32[3];
+        buf32[0] = swap16x2(w0);
+        buf32[1] = swap16x2(w1);
+        buf32[2] = swap16x2(w2);
+        buf32[3] = swap16x2(w3);
+        buf32 += 4;
+    }
+
+    /* Tails: 4, 2 and 1 pixel */
+    if (words & 2) {
+        uint32_t w0 = buf32[0];
+        uint32_t w1 = buf32[1];
+        buf32[0] = swap16x2(w0);
+        buf32[1] = swap16x2(w1);
+        buf32 += 2;
+    }
+    if (words & 1) {
+        *buf32 = swap16x2(*buf32);
+        buf32++;
+    }
+    if (len_px & 1) {
+        buf16 = (uint16_t *)buf32;
+        *buf16 = swap16(*buf16);
+    }
+}
@@ -0,0 +1,290 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_lvgl_port_copy.h"
+
+#if defined(ESP_PLATFORM) && !CONFIG_IDF_TARGET_LINUX
+#include "esp_idf_version.h"
+#if CONFIG_SOC_ASYNC_MEMCPY_SUPPORTED && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+#define LVGL_PORT_COPY_DMA      1
+#include "esp_attr.h"
+#include "esp_async_memcpy.h"
+#include "esp_memory_utils.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#endif
+#else
+/* Host build: worker thread instead of the DMA */
+#define LVGL_PORT_COPY_THREAD   1
+#include <pthread.h>
+#endif
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+typedef struct lvgl_port_copy_job_s {
+    lvgl_port_copy_t            *copy;
+    void                        *dst;
+    const void                  *src;
+    size_t                      len;
+    lvgl_port_copy_done_cb_t    done_cb;
+    void                        *user_ctx;
+} lvgl_port_copy_job_t;
+
+struct lvgl_port_copy_s {
+    uint32_t                backlog;
+    lvgl_port_copy_job_t    *jobs;          /* Ring of queued copies */
+    uint32_t                queued;         /* Count of queued copies, the next job is at queued % backlog */
+    uint32_t                done;           /* Count of done copies */
+    lvgl_port_copy_stats_t  stats;
+#if LVGL_PORT_COPY_DMA
+    async_memcpy_handle_t   mcp;
+    SemaphoreHandle_t       done_sem;       /* Given for each copy done by DMA */
+#elif LVGL_PORT_COPY_THREAD
+    pthread_t               thread;
+    pthread_mutex_t         lock;
+    pthread_cond_t          queued_cond;
+    pthread_cond_t          done_cond;
+    bool                    stop;
+#endif
+};
+
+/*******************************************************************************
+* Local functions
+*******************************************************************************/
+
+static void lvgl_port_copy_cpu(lvgl_port_copy_t *copy, void *dst, const void *src, size_t len, lvgl_port_copy_done_cb_t done_cb, void *user_ctx)
+{
+    memcpy(dst, src, len);
+    copy->stats.cpu++;
+    copy->stats.cpu_bytes += len;
+    if (done_cb) {
+        done_cb(user_ctx);
+    }
+}
+
+#if LVGL_PORT_COPY_DMA
+
+static bool IRAM_ATTR lvgl_port_copy_dma_done(async_memcpy_handle_t mcp, async_memcpy_event_t *event, void *cb_args)
+{
+    const lvgl_port_copy_job_t *job = (const lvgl_port_copy_job_t *)cb_args;
+    if (job->done_cb) {
+        job->done_cb(job->user_ctx);
+    }
+    BaseType_t need_yield = pdFALSE;
+    xSemaphoreGiveFromISR(job->copy->done_sem, &need_yield);
+    return (need_yield == pdTRUE);
+}
+
+static bool lvgl_port_copy_engine_init(lvgl_port_copy_t *copy)
+{
+    copy->done_sem = xSemaphoreCreateCounting(copy->backlog, 0);
+    if (copy->done_sem == NULL) {
+        return false;
+    }
+    async_memcpy_config_t config = ASYNC_MEMCPY_DEFAULT_CONFIG();
+    config.backlog = copy->backlog;
+    if (esp_async_memcpy_install(&config, &copy->mcp) != ESP_OK) {
+        vSemaphoreDelete(copy->done_sem);
+        return false;
+    }
+    return true;
+}
+
+static void lvgl_port_copy_engine_deinit(lvgl_port_copy_t *copy)
+{
+    esp_async_memcpy_uninstall(copy->mcp);
+    vSemaphoreDelete(copy->done_sem);
+}
+
+/* Wait until at most max_pending copies are not done, done copies are counted, when they are taken from the semaphore */
+static void lvgl_port_copy_engine_wait(lvgl_port_copy_t *copy, uint32_t max_pending)
+{
+    while (copy->queued - copy->done > max_pending) {
+        xSemaphoreTake(copy->done_sem, portMAX_DELAY);
+        copy->done++;
+    }
+}
+
+/*
+ * DMA to or from PSRAM would need cache write-back of the source and invalidation of the destination (esp_cache_msync)
+ * on cache line aligned spans, but the rows of the areas are not aligned. The CPU copies them through the cache.
+ */
+static bool lvgl_port_copy_engine_accepts(const void *dst, const void *src)
+{
+    return (!esp_ptr_external_ram(dst) && !esp_ptr_external_ram(src));
+}
+
+static bool lvgl_port_copy_engine_queue(lvgl_port_copy_t *copy, lvgl_port_copy_job_t *job)
+{
+    /* Rejected by the engine (e.g. memory not accessible by DMA or its alignment), the CPU copies it */
+    return (esp_async_memcpy(copy->mcp, job->dst, (void *)job->src, job->len, lvgl_port_copy_dma_done, job) == ESP_OK);
+}
+
+#elif LVGL_PORT_COPY_THREAD
+
+static void *lvgl_port_copy_thread(void *arg)
+{
+    lvgl_port_copy_t *copy = (lvgl_port_copy_t *)arg;
+    pthread_mutex_lock(&copy->lock);
+    while (true) {
+        while (copy->done == copy->queued && !copy->stop) {
+            pthread_cond_wait(&copy->queued_cond, &copy->lock);
+        }
+        if (copy->done == copy->queued) {
+            break;
+        }
+        const lvgl_port_copy_job_t *job = &copy->jobs[copy->done % copy->backlog];
+        pthread_mutex_unlock(&copy->lock);
+
+        memcpy(job->dst, job->src, job->len);
+        if (job->done_cb) {
+            job->done_cb(job->user_ctx);
+        }
+
+        pthread_mutex_lock(&copy->lock);
+        copy->done++;
+        pthread_cond_broadcast(&copy->done_cond);
+    }
+    pthread_mutex_unlock(&copy->lock);
+    return NULL;
+}
+
+static bool lvgl_port_copy_engine_init(lvgl_port_copy_t *copy)
+{
+    pthread_mutex_init(&copy->lock, NULL);
+    pthread_cond_init(&copy->queued_cond, NULL);
+    pthread_cond_init(&copy->done_cond, NULL);
+    if (pthread_create(&copy->thread, NULL, lvgl_port_copy_thread, copy) != 0) {
+        pthread_cond_destroy(&copy->done_cond);
+        pthread_cond_destroy(&copy->queued_cond);
+        pthread_mutex_destroy(&copy->lock);
+        return false;
+    }
+    return true;
+}
+
+static void lvgl_port_copy_engine_deinit(lvgl_port_copy_t *copy)
+{
+    pthread_mutex_lock(&copy->lock);
+    copy->stop = true;
+    pthread_cond_signal(&copy->queued_cond);
+    pthread_mutex_unlock(&copy->lock);
+    pthread_join(copy->thread, NULL);
+    pthread_cond_destroy(&copy->done_cond);
+    pthread_cond_destroy(&copy->queued_cond);
+    pthread_mutex_destroy(&copy->lock);
+}
+
+/* Wait until at most max_pending copies are not done */
+static void lvgl_port_copy_engine_wait(lvgl_port_copy_t *copy, uint32_t max_pending)
+{
+    pthread_mutex_lock(&copy->lock);
+    while (copy->queued - copy->done > max_pending) {
+        pthread_cond_wait(&copy->done_cond, &copy->lock);
+    }
+    pthread_mutex_unlock(&copy->lock);
+}
+
+static bool lvgl_port_copy_engine_accepts(const void *dst, const void *src)
+{
+    (void)dst;
+    (void)src;
+    return true;
+}
+
+static bool lvgl_port_copy_engine_queue(lvgl_port_copy_t *copy, lvgl_port_copy_job_t *job)
+{
+    /* The job is already in the ring, the worker takes it by the count of queued copies */
+    (void)job;
+    pthread_mutex_lock(&copy->lock);
+    copy->queued++;
+    pthread_cond_signal(&copy->queued_cond);
+    pthread_mutex_unlock(&copy->lock);
+    return true;
+}
+
+#endif
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+lvgl_port_copy_t *lvgl_port_copy_new(uint32_t backlog)
+{
+    lvgl_port_copy_t *copy = calloc(1, sizeof(lvgl_port_copy_t));
+    if (copy == NULL) {
+        return NULL;
+    }
+    copy->backlog = (backlog ? backlog : 1);
+#if LVGL_PORT_COPY_DMA || LVGL_PORT_COPY_THREAD
+    copy->jobs = calloc(copy->backlog, sizeof(lvgl_port_copy_job_t));
+    if (copy->jobs == NULL || !lvgl_port_copy_engine_init(copy)) {
+        free(copy->jobs);
+        free(copy);
+        return NULL;
+    }
+#endif
+    return copy;
+}
+
+void lvgl_port_copy_del(lvgl_port_copy_t *copy)
+{
+    if (copy == NULL) {
+        return;
+    }
+    lvgl_port_copy_wait(copy);
+#if LVGL_PORT_COPY_DMA || LVGL_PORT_COPY_THREAD
+    lvgl_port_copy_engine_deinit(copy);
+#endif
+    free(copy->jobs);
+    free(copy);
+}
+
+void lvgl_port_copy_submit(lvgl_port_copy_t *copy, void *dst, const void *src, size_t len, lvgl_port_copy_done_cb_t done_cb, void *user_ctx)
+{
+#if LVGL_PORT_COPY_DMA || LVGL_PORT_COPY_THREAD
+    if (len >= LVGL_PORT_COPY_MIN_ASYNC_BYTES && lvgl_port_copy_engine_accepts(dst, src)) {
+        /* The oldest copy frees its place in the ring (copies are done in order) */
+        lvgl_port_copy_engine_wait(copy, copy->backlog - 1);
+        lvgl_port_copy_job_t *job = &copy->jobs[copy->queued % copy->backlog];
+        job->copy = copy;
+        job->dst = dst;
+        job->src = src;
+        job->len = len;
+        job->done_cb = done_cb;
+        job->user_ctx = user_ctx;
+        if (lvgl_port_copy_engine_queue(copy, job)) {
+#if LVGL_PORT_COPY_DMA
+            copy->queued++;
+#endif
+            copy->stats.async++;
+            copy->stats.async_bytes += len;
+            return;
+        }
+    }
+#endif
+    lvgl_port_copy_cpu(copy, dst, src, len, done_cb, user_ctx);
+}
+
+void lvgl_port_copy_wait(lvgl_port_copy_t *copy)
+{
+#if LVGL_PORT_COPY_DMA || LVGL_PORT_COPY_THREAD
+    lvgl_port_copy_engine_wait(copy, 0);
+#endif
+}
+
+void lvgl_port_copy_get_stats(lvgl_port_copy_t *copy, lvgl_port_copy_stats_t *stats, bool reset)
+{
+    *stats = copy->stats;
+    if (reset) {
+        memset(&copy->stats, 0, sizeof(copy->stats));
+    }
+}
@@ -0,0 +1,199 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "esp_lvgl_port_diff.h"
+
+#define LVGL_PORT_MIN(a, b)     ((a) < (b) ? (a) : (b))
+#define LVGL_PORT_MAX(a, b)     ((a) > (b) ? (a) : (b))
+
+/*******************************************************************************
+* Local functions
+*******************************************************************************/
+
+/* Both steps are bijective, so one changed word always changes the state */
+static inline uint32_t diff_mix(uint32_t h, uint32_t v)
+{
+    h = (h ^ v) * 0x9E3779B1u;
+    return h ^ (h >> 15);
+}
+
+static uint32_t diff_hash(const uint8_t *data, size_t len)
+{
+    uint32_t h = 0x811C9DC5u;
+    size_t i = 0;
+
+    if (((uintptr_t)data & 3) == 0) {
+        const uint32_t *data32 = (const uint32_t *)data;
+        for (; i + 4 <= len; i += 4) {
+            h = diff_mix(h, *data32++);
+        }
+    }
+    for (; i < len; i++) {
+        h = diff_mix(h, data[i]);
+    }
+
+    /* 0 is reserved for unknown content */
+    return h ? h : 1;
+}
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+size_t lvgl_port_diff_get_hashes_count(uint32_t width, uint32_t height)
+{
+    const uint32_t size = LVGL_PORT_MAX(width, height);
+    return (size_t)size * ((size + LVGL_PORT_DIFF_SEG_PX - 1) / LVGL_PORT_DIFF_SEG_PX);
+}
+
+void lvgl_port_diff_reset(lvgl_port_diff_t *diff, uint32_t width, uint32_t height)
+{
+    diff->width = width;
+    diff->height = height;
+    diff->segs = (width + LVGL_PORT_DIFF_SEG_PX - 1) / LVGL_PORT_DIFF_SEG_PX;
+    memset(diff->hashes, 0, (size_t)diff->segs * height * sizeof(uint32_t));
+}
+
+void lvgl_port_diff_round_area(const lvgl_port_diff_t *diff, int32_t *x1, int32_t *x2)
+{
+    *x1 = *x1 / LVGL_PORT_DIFF_SEG_PX * LVGL_PORT_DIFF_SEG_PX;
+    *x2 = LVGL_PORT_MIN((*x2 / LVGL_PORT_DIFF_SEG_PX + 1) * LVGL_PORT_DIFF_SEG_PX, (int32_t)diff->width) - 1;
+}
+
+uint32_t lvgl_port_diff_area(lvgl_port_diff_t *diff, uint8_t *buf, uint32_t px_size, int32_t x1, int32_t y1, int32_t x2, int32_t y2,
+                             lvgl_port_diff_window_t *windows, uint32_t max_windows)
+{
+    const size_t stride = (size_t)(x2 - x1 + 1) * px_size;
+    const int32_t seg_first = x1 / LVGL_PORT_DIFF_SEG_PX;
+    const int32_t seg_last = x2 / LVGL_PORT_DIFF_SEG_PX;
+    lvgl_port_diff_window_t *win = NULL;
+    uint32_t count = 0;
+
+    for (int32_t y = y1; y <= y2; y++) {
+        const uint8_t *row = buf + (y - y1) * stride;
+        uint32_t *hashes = diff->hashes + (size_t)y * diff->segs;
+        int32_t changed_x1 = x2 + 1;
+        int32_t changed_x2 = -1;
+
+        for (int32_t s = seg_first; s <= seg_last; s++) {
+            const int32_t seg_x1 = s * LVGL_PORT_DIFF_SEG_PX;
+            const int32_t seg_x2 = LVGL_PORT_MIN(seg_x1 + LVGL_PORT_DIFF_SEG_PX, (int32_t)diff->width) - 1;
+            const int32_t px1 = LVGL_PORT_MAX(seg_x1, x1);
+            const int32_t px2 = LVGL_PORT_MIN(seg_x2, x2);
+            bool changed = true;
+
+            if (px1 == seg_x1 && px2 == seg_x2) {
+                const uint32_t h = diff_hash(row + (px1 - x1) * px_size, (size_t)(px2 - px1 + 1) * px_size);
+                changed = (h != hashes[s]);
+                hashes[s] = h;
+            } else {
+                /* Rest of the segment is not known */
+                hashes[s] = 0;
+            }
+
+            if (changed) {
+                changed_x1 = LVGL_PORT_MIN(changed_x1, px1);
+                changed_x2 = px2;
+            }
+        }
+
+        if (changed_x2 < 0) {
+            /* Unchanged row closes the window */
+            win = NULL;
+            continue;
+        }
+
+        if (win == NULL) {
+            if (count < max_windows) {
+                win = &windows[count++];
+                win->x1 = changed_x1;
+                win->x2 = changed_x2;
+                win->y1 = y;
+            } else {
+                /* No free window, the last one continues over the unchanged rows */
+                win = &windows[count - 1];
+                win->x1 = x1;
+                win->x2 = x2;
+            }
+        } else {
+            win->x1 = LVGL_PORT_MIN(win->x1, changed_x1);
+            win->x2 = LVGL_PORT_MAX(win->x2, changed_x2);
+        }
+        win->y2 = y;
+    }
+
+    /* Make windows contiguous: rows move only to lower addresses and windows don't share rows */
+    for (uint32_t i = 0; i < count; i++) {
+        const size_t win_stride = (size_t)(windows[i].x2 - windows[i].x1 + 1) * px_size;
+        uint8_t *dst = buf + (windows[i].y1 - y1) * stride;
+        windows[i].data = dst;
+        if (win_stride == stride) {
+            continue;
+        }
+        for (int32_t y = windows[i].y1; y <= windows[i].y2; y++) {
+            memmove(dst, buf + (y - y1) * stride + (windows[i].x1 - x1) * px_size, win_stride);
+            dst += win_stride;
+        }
+    }
+
+    return count;
+}
+
+uint32_t lvgl_port_diff_pages(uint8_t *sent, uint8_t *pages, uint32_t width, uint32_t page_count,
+                              lvgl_port_diff_window_t *spans, uint32_t max_spans)
+{
+    uint32_t count = 0;
+    bool full = false;
+
+    for (uint32_t p = 0; p < page_count && !full; p++) {
+        const uint8_t *cur = pages + p * width;
+        const uint8_t *old = sent + p * width;
+        uint32_t x = 0;
+
+        while (x < width) {
+            if (cur[x] == old[x]) {
+                x++;
+                continue;
+            }
+
+            /* Span ends after LVGL_PORT_DIFF_PAGE_GAP unchanged columns */
+            const uint32_t start = x;
+            uint32_t end = x;
+            for (x++; x < width && x - end <= LVGL_PORT_DIFF_PAGE_GAP; x++) {
+                if (cur[x] != old[x]) {
+                    end = x;
+                }
+            }
+            x = end + 1;
+
+            if (count == max_spans) {
+                full = true;
+                break;
+            }
+            spans[count++] = (lvgl_port_diff_window_t) {
+                .x1 = start,
+                .y1 = p * 8,
+                .x2 = end,
+                .y2 = p * 8 + 7,
+                .data = pages + p * width + start,
+            };
+        }
+    }
+
+    if (full) {
+        /* Last span continues with whole pages */
+        lvgl_port_diff_window_t *last = &spans[count - 1];
+        last->x1 = 0;
+        last->x2 = width - 1;
+        last->y2 = page_count * 8 - 1;
+        last->data = pages + (last->y1 / 8) * width;
+    }
+
+    memcpy(sent, pages, (size_t)width * page_count);
+    return count;
+}
@@ -0,0 +1,107 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_lvgl_port_merge.h"
+
+#define LVGL_PORT_MIN(a, b)     ((a) < (b) ? (a) : (b))
+#define LVGL_PORT_MAX(a, b)     ((a) > (b) ? (a) : (b))
+
+/*******************************************************************************
+* Local functions
+*******************************************************************************/
+
+static inline bool merge_area_is_in(const lvgl_port_merge_area_t *in, const lvgl_port_merge_area_t *holder)
+{
+    return (in->x1 >= holder->x1 && in->y1 >= holder->y1 && in->x2 <= holder->x2 && in->y2 <= holder->y2);
+}
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+void lvgl_port_merge_reset(lvgl_port_merge_t *merge)
+{
+    merge->count = 0;
+}
+
+uint64_t lvgl_port_merge_area_cost(const lvgl_port_merge_t *merge, const lvgl_port_merge_area_t *area, uint32_t *trans)
+{
+    /* The area is split into draw buffer bands and each band is one transaction */
+    const uint32_t w = area->x2 - area->x1 + 1;
+    const uint32_t h = area->y2 - area->y1 + 1;
+    uint32_t band_rows = merge->buff_bytes / (w * merge->px_size);
+    if (band_rows == 0) {
+        band_rows = 1;
+    }
+
+    const uint32_t bands = (h + band_rows - 1) / band_rows;
+    *trans = bands;
+    return (uint64_t)bands * merge->trans_overhead_us * 1000 +
+           (uint64_t)w * h * merge->px_size * 1000 / merge->bytes_per_us;
+}
+
+uint32_t lvgl_port_merge_area(lvgl_port_merge_t *merge, lvgl_port_merge_area_t *area, uint32_t *trans_saved)
+{
+    uint32_t merged_areas = 0;
+
+    /* Grow the area over the cheapest nearby area of this frame. Repeat, while the grown area merges another one. */
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        int best = -1;
+        int64_t best_saving = 0;
+        uint32_t best_trans_saved = 0;
+        lvgl_port_merge_area_t best_area;
+        uint32_t trans_area;
+        const uint64_t cost_area = lvgl_port_merge_area_cost(merge, area, &trans_area);
+
+        for (uint32_t i = 0; i < merge->count; i++) {
+            const lvgl_port_merge_area_t *other = &merge->areas[i];
+            if (merge_area_is_in(area, other)) {
+                /* Already invalidated */
+                return merged_areas;
+            }
+
+            const lvgl_port_merge_area_t joined = {
+                .x1 = LVGL_PORT_MIN(area->x1, other->x1),
+                .y1 = LVGL_PORT_MIN(area->y1, other->y1),
+                .x2 = LVGL_PORT_MAX(area->x2, other->x2),
+                .y2 = LVGL_PORT_MAX(area->y2, other->y2),
+            };
+            uint32_t trans_other;
+            uint32_t trans_joined;
+            const uint64_t cost_other = lvgl_port_merge_area_cost(merge, other, &trans_other);
+            const uint64_t cost_joined = lvgl_port_merge_area_cost(merge, &joined, &trans_joined);
+            const int64_t saving = (int64_t)(cost_area + cost_other) - (int64_t)cost_joined;
+            if (saving > best_saving) {
+                best = i;
+                best_saving = saving;
+                best_area = joined;
+                best_trans_saved = 0;
+                /* Area inside of the new one would be joined by LVGL anyway */
+                if (!merge_area_is_in(other, area) && trans_area + trans_other > trans_joined) {
+                    best_trans_saved = trans_area + trans_other - trans_joined;
+                }
+            }
+        }
+
+        if (best >= 0) {
+            *area = best_area;
+            merge->areas[best] = merge->areas[--merge->count];
+            if (best_trans_saved) {
+                merged_areas++;
+                *trans_saved += best_trans_saved;
+            }
+            merged = true;
+        }
+    }
+
+    if (merge->count < LVGL_PORT_MERGE_AREAS_MAX) {
+        merge->areas[merge->count++] = *area;
+    }
+
+    return merged_areas;
+}
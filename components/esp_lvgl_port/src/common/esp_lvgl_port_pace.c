@@ -0,0 +1,112 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <string.h>
+#include "esp_lvgl_port_pace.h"
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+void lvgl_port_pace_init(lvgl_port_pace_t *pace, uint32_t period_us, int64_t now_us)
+{
+    memset(pace, 0, sizeof(lvgl_port_pace_t));
+    pace->period_us = period_us;
+    lvgl_port_pace_reset_stats(pace, now_us);
+}
+
+uint32_t lvgl_port_pace_get_wait(const lvgl_port_pace_t *pace, int64_t now_us)
+{
+    if (pace->period_us == 0 || !pace->started || now_us >= pace->next_us) {
+        return 0;
+    }
+    return (uint32_t)(pace->next_us - now_us);
+}
+
+void lvgl_port_pace_frame_start(lvgl_port_pace_t *pace, int64_t now_us, bool refresh)
+{
+    const bool in_time = pace->started && now_us < pace->next_us + pace->period_us;
+    if (!in_time) {
+        /* The LVGL task was idle, the cadence starts again */
+        pace->next_us = now_us;
+    } else if (pace->refresh && refresh) {
+        /* Two refreshed frames in a row, the interval shows the frame time seen on the display */
+        const uint64_t interval = (uint64_t)(now_us - pace->start_us);
+        pace->intervals++;
+        pace->interval_sum += interval;
+        pace->interval_sq_sum += interval * interval;
+    }
+
+    pace->started = true;
+    pace->start_us = now_us;
+    pace->refresh = refresh;
+    pace->next_us += pace->period_us;
+}
+
+void lvgl_port_pace_frame_end(lvgl_port_pace_t *pace, int64_t now_us)
+{
+    uint32_t skipped = 0;
+    if (now_us > pace->next_us) {
+        /* Overrun: skip the periods taken, the next frame starts on the cadence */
+        skipped = (uint32_t)((now_us - pace->next_us) / pace->period_us) + 1;
+        pace->next_us += (int64_t)skipped * pace->period_us;
+    }
+
+    if (!pace->refresh) {
+        return;
+    }
+
+    const uint32_t work = (uint32_t)(now_us - pace->start_us);
+    pace->frames++;
+    pace->work_us += work;
+    pace->work_max_us = (work > pace->work_max_us ? work : pace->work_max_us);
+    if (skipped) {
+        pace->late++;
+        pace->missed += skipped;
+    } else {
+        const uint32_t slack = (uint32_t)(pace->next_us - now_us);
+        pace->slack_us += slack;
+        pace->slack_min_us = (slack < pace->slack_min_us ? slack : pace->slack_min_us);
+    }
+}
+
+void lvgl_port_pace_get_stats(const lvgl_port_pace_t *pace, int64_t now_us, lvgl_port_pace_stats_t *stats)
+{
+    memset(stats, 0, sizeof(lvgl_port_pace_stats_t));
+    stats->frames = pace->frames;
+    stats->late = pace->late;
+    stats->missed = pace->missed;
+    stats->work_us = pace->work_us;
+    stats->work_max_us = pace->work_max_us;
+    stats->slack_us = pace->slack_us;
+    stats->slack_min_us = (pace->frames > pace->late ? pace->slack_min_us : 0);
+    stats->intervals = pace->intervals;
+    stats->elapsed_us = (uint64_t)(now_us - pace->reset_us);
+
+    if (pace->intervals) {
+        const double n = (double)pace->intervals;
+        const double mean = (double)pace->interval_sum / n;
+        const double var = (double)pace->interval_sq_sum / n - mean * mean;
+        stats->interval_avg_us = (uint32_t)(mean + 0.5);
+        stats->interval_dev_us = (var > 0 ? (uint32_t)(sqrt(var) + 0.5) : 0);
+    }
+}
+
+void lvgl_port_pace_reset_stats(lvgl_port_pace_t *pace, int64_t now_us)
+{
+    pace->reset_us = now_us;
+    pace->frames = 0;
+    pace->late = 0;
+    pace->missed = 0;
+    pace->work_us = 0;
+    pace->work_max_us = 0;
+    pace->slack_us = 0;
+    pace->slack_min_us = UINT32_MAX;
+    pace->intervals = 0;
+    pace->interval_sum = 0;
+    pace->interval_sq_sum = 0;
+}
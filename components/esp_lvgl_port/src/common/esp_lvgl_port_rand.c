@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include "esp_lvgl_port_rand.h"
+
+/* PCG32 (XSH RR), see https://www.pcg-random.org */
+#define LVGL_PORT_RAND_MULTIPLIER   6364136223846793005ULL
+#define LVGL_PORT_RAND_INCREMENT    1442695040888963407ULL
+
+/*******************************************************************************
+* Local variables
+*******************************************************************************/
+static uint64_t lvgl_port_rand_state = 0x853c49e6748fea9bULL;
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+void lvgl_port_rand_seed(uint64_t seed)
+{
+    lvgl_port_rand_state = 0;
+    lvgl_port_rand();
+    lvgl_port_rand_state += seed;
+    lvgl_port_rand();
+}
+
+uint32_t lvgl_port_rand(void)
+{
+    uint64_t old = lvgl_port_rand_state;
+    lvgl_port_rand_state = old * LVGL_PORT_RAND_MULTIPLIER + LVGL_PORT_RAND_INCREMENT;
+
+    uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+uint32_t lvgl_port_rand_bounded(uint32_t bound)
+{
+    if (bound == 0) {
+        return 0;
+    }
+
+    /* Reject values from the incomplete last range to avoid modulo bias */
+    uint32_t threshold = -bound % bound;
+    while (true) {
+        uint32_t r = lvgl_port_rand();
+        if (r >= threshold) {
+            return r % bound;
+        }
+    }
+}
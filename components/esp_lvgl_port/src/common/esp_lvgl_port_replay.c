@@ -0,0 +1,45 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stddef.h>
+#include "esp_lvgl_port_replay.h"
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+void lvgl_port_replay_init(lvgl_port_replay_t *replay, uint32_t tick_period_ms, const uint32_t *tick_deltas, uint32_t tick_deltas_count)
+{
+    replay->tick_period_ms = tick_period_ms;
+    replay->tick_deltas = tick_deltas;
+    replay->tick_deltas_count = (tick_deltas ? tick_deltas_count : 0);
+    replay->pos = 0;
+}
+
+uint32_t lvgl_port_replay_next(lvgl_port_replay_t *replay)
+{
+    if (replay->pos < replay->tick_deltas_count) {
+        return replay->tick_deltas[replay->pos++];
+    }
+    return replay->tick_period_ms;
+}
+
+void lvgl_port_record_init(lvgl_port_record_t *record, uint32_t *buf, uint32_t len, uint32_t tick)
+{
+    record->buf = buf;
+    record->len = (buf ? len : 0);
+    record->count = 0;
+    record->last_tick = tick;
+}
+
+void lvgl_port_record_tick(lvgl_port_record_t *record, uint32_t tick)
+{
+    if (record->buf && record->count < record->len) {
+        /* Same as lv_tick_elaps(), the difference is right over the overflow too */
+        record->buf[record->count++] = tick - record->last_tick;
+        record->last_tick = tick;
+    }
+}
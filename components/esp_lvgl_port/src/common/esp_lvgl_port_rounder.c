@@ -0,0 +1,63 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_lvgl_port_rounder.h"
+
+/*******************************************************************************
+* Local functions
+*******************************************************************************/
+
+static void rounder_axis_init(lvgl_port_rounder_axis_t *axis, uint32_t res, uint32_t align, uint32_t min)
+{
+    axis->align = (align > 1 ? (int32_t)align : 1);
+    axis->res = (int32_t)res;
+    /* Minimum length is whole cells, at most the screen */
+    int32_t min_len = (int32_t)((min + axis->align - 1) / axis->align) * axis->align;
+    axis->min = (min_len > axis->res ? axis->res : min_len);
+}
+
+static void rounder_axis(const lvgl_port_rounder_axis_t *axis, int32_t *a1, int32_t *a2)
+{
+    int32_t start = (*a1 < 0 ? 0 : *a1);
+    int32_t end = (*a2 >= axis->res ? axis->res - 1 : *a2);
+
+    start -= start % axis->align;
+    end += axis->align - 1 - end % axis->align;
+
+    /* Grow to the minimum length, to the left at the end of the screen */
+    if (end - start + 1 < axis->min) {
+        end = start + axis->min - 1;
+        if (end >= axis->res) {
+            end = axis->res - 1;
+            start = end - axis->min + 1;
+        }
+    }
+
+    *a1 = start;
+    *a2 = end;
+}
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+void lvgl_port_rounder_init(lvgl_port_rounder_t *rounder, uint32_t hres, uint32_t vres, uint32_t x_align, uint32_t y_align, uint32_t min_width, bool swap_xy)
+{
+    /* The grid starts at 0 from both sides of the screen, mirroring doesn't change it */
+    if (swap_xy) {
+        rounder_axis_init(&rounder->x, vres, y_align, 0);
+        rounder_axis_init(&rounder->y, hres, x_align, min_width);
+    } else {
+        rounder_axis_init(&rounder->x, hres, x_align, min_width);
+        rounder_axis_init(&rounder->y, vres, y_align, 0);
+    }
+}
+
+void lvgl_port_rounder_area(const lvgl_port_rounder_t *rounder, int32_t *x1, int32_t *y1, int32_t *x2, int32_t *y2)
+{
+    rounder_axis(&rounder->x, x1, x2);
+    rounder_axis(&rounder->y, y1, y2);
+}
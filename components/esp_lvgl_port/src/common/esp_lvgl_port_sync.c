@@ -0,0 +1,121 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_lvgl_port_sync.h"
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+void lvgl_port_sync_reset(lvgl_port_sync_t *sync)
+{
+    sync->count = 0;
+    sync->full = false;
+}
+
+void lvgl_port_sync_add_area(lvgl_port_sync_t *sync, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    if (sync->full) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < sync->count; i++) {
+        const lvgl_port_sync_area_t *other = &sync->areas[i];
+        if (x1 >= other->x1 && y1 >= other->y1 && x2 <= other->x2 && y2 <= other->y2) {
+            return;
+        }
+    }
+
+    if (sync->count == LVGL_PORT_SYNC_AREAS_MAX) {
+        sync->full = true;
+        return;
+    }
+
+    lvgl_port_sync_area_t *area = &sync->areas[sync->count++];
+    area->x1 = x1;
+    area->y1 = y1;
+    area->x2 = x2;
+    area->y2 = y2;
+}
+
+size_t lvgl_port_sync_copy(const lvgl_port_sync_t *sync, uint8_t *dst, const uint8_t *src, uint32_t hres, uint32_t vres, uint32_t px_size,
+                           lvgl_port_sync_copy_cb_t copy, void *user_ctx)
+{
+    if (sync->full) {
+        copy(dst, src, (size_t)hres * vres * px_size, user_ctx);
+        return (size_t)hres * vres * px_size;
+    }
+
+    /* Rows covered by the areas */
+    int32_t y_min = (int32_t)vres;
+    int32_t y_max = -1;
+    for (uint32_t i = 0; i < sync->count; i++) {
+        y_min = (sync->areas[i].y1 < y_min ? sync->areas[i].y1 : y_min);
+        y_max = (sync->areas[i].y2 > y_max ? sync->areas[i].y2 : y_max);
+    }
+    y_min = (y_min < 0 ? 0 : y_min);
+    y_max = (y_max >= (int32_t)vres ? (int32_t)vres - 1 : y_max);
+
+    size_t copied = 0;
+    size_t span_start = 0;
+    size_t span_len = 0;
+    for (int32_t y = y_min; y <= y_max; y++) {
+        /* Columns of the areas in this row, sorted by the start */
+        int32_t starts[LVGL_PORT_SYNC_AREAS_MAX];
+        int32_t ends[LVGL_PORT_SYNC_AREAS_MAX];
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < sync->count; i++) {
+            const lvgl_port_sync_area_t *area = &sync->areas[i];
+            if (y < area->y1 || y > area->y2) {
+                continue;
+            }
+            const int32_t x1 = (area->x1 < 0 ? 0 : area->x1);
+            const int32_t x2 = (area->x2 >= (int32_t)hres ? (int32_t)hres - 1 : area->x2);
+            if (x1 > x2) {
+                continue;
+            }
+            uint32_t j = count++;
+            while (j > 0 && starts[j - 1] > x1) {
+                starts[j] = starts[j - 1];
+                ends[j] = ends[j - 1];
+                j--;
+            }
+            starts[j] = x1;
+            ends[j] = x2;
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            /* Join overlapping and touching columns */
+            const int32_t x1 = starts[i];
+            int32_t x2 = ends[i];
+            while (i + 1 < count && starts[i + 1] <= x2 + 1) {
+                i++;
+                x2 = (ends[i] > x2 ? ends[i] : x2);
+            }
+            const size_t start = ((size_t)y * hres + x1) * px_size;
+            const size_t len = (size_t)(x2 - x1 + 1) * px_size;
+
+            /* Span continues the previous one in memory (e.g. full-width rows) */
+            if (span_len && start == span_start + span_len) {
+                span_len += len;
+                continue;
+            }
+            if (span_len) {
+                copy(dst + span_start, src + span_start, span_len, user_ctx);
+                copied += span_len;
+            }
+            span_start = start;
+            span_len = len;
+        }
+    }
+
+    if (span_len) {
+        copy(dst + span_start, src + span_start, span_len, user_ctx);
+        copied += span_len;
+    }
+    return copied;
+}
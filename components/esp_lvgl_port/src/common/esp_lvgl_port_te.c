@@ -0,0 +1,51 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_lvgl_port_te.h"
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+uint32_t lvgl_port_te_get_delay(const lvgl_port_te_timing_t *te, uint32_t since_te_us, int32_t y1, int32_t y2, bool down, uint32_t trans_us)
+{
+    if (te->period_us == 0 || te->lines == 0) {
+        return 0;
+    }
+
+    /*
+     * Everything is in the scan time: row y is scanned at y * period / lines after TE.
+     * The distance of the scan in front of the write position goes from 'ahead' to 'ahead + drift' during the transfer,
+     * the scan crosses the write position, when the distance passes a multiple of the period.
+     * One row is kept as a margin at both ends, a row is scanned and written for some time.
+     */
+    const int64_t period = te->period_us;
+    const int64_t margin = (period + te->lines - 1) / te->lines;
+    const int64_t rows = (int64_t)(y2 - y1 + 1) * period / te->lines;
+    const int64_t start = (int64_t)(down ? y1 : y2 + 1) * period / te->lines;
+    const int64_t drift = down ? (int64_t)trans_us - rows : (int64_t)trans_us + rows;
+    const int64_t drift_abs = drift >= 0 ? drift : -drift;
+    if (drift_abs + 2 * margin >= period) {
+        /* Longer than the scan, there is no safe start */
+        return 0;
+    }
+
+    int64_t ahead = ((int64_t)since_te_us - start) % period;
+    if (ahead < 0) {
+        ahead += period;
+    }
+
+    /* Safe distances: scan is faster and must not catch up from behind, or write is faster and must not overtake the scan */
+    const int64_t safe_min = (drift >= 0 ? 0 : drift_abs) + margin;
+    const int64_t safe_max = period - (drift >= 0 ? drift_abs : 0) - margin;
+    if (ahead < safe_min) {
+        return safe_min - ahead;
+    }
+    if (ahead > safe_max) {
+        return period - ahead + safe_min;
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp_lvgl_port_visible.h"
+
+#define LVGL_PORT_MIN(a, b)     ((a) < (b) ? (a) : (b))
+#define LVGL_PORT_MAX(a, b)     ((a) > (b) ? (a) : (b))
+
+/*******************************************************************************
+* Local functions
+*******************************************************************************/
+
+static uint32_t isqrt(uint32_t v)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/*
+ * Invisible pixels at the side of the row (or column), which is d pixels from the edge of the window.
+ * Pixel i of the corner is visible, when (2r - 2i - 1)^2 + (2r - 2d - 1)^2 <= 4r^2 (centers, in half pixels).
+ */
+static int32_t corner_inset(int32_t radius, int32_t d)
+{
+    if (d >= radius) {
+        return 0;
+    }
+    const int32_t a = 2 * radius - 2 * d - 1;
+    const int32_t m = (int32_t)isqrt((uint32_t)(4 * radius * radius - a * a));
+    return (2 * radius - m) / 2;
+}
+
+/* Row (or column) of the range nearest to the center of the window and its distance from the edge */
+static int32_t edge_distance(int32_t lo, int32_t hi, int32_t win_lo, int32_t win_hi)
+{
+    const int32_t mid = win_lo + (win_hi - win_lo) / 2;
+    const int32_t nearest = (hi < mid ? hi : (lo > mid ? lo : mid));
+    return LVGL_PORT_MIN(nearest - win_lo, win_hi - nearest);
+}
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+void lvgl_port_visible_init(lvgl_port_visible_t *vis, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t radius)
+{
+    vis->x1 = x1;
+    vis->y1 = y1;
+    vis->x2 = x2;
+    vis->y2 = y2;
+    const int32_t half = LVGL_PORT_MIN(x2 - x1 + 1, y2 - y1 + 1) / 2;
+    vis->radius = LVGL_PORT_MAX(0, LVGL_PORT_MIN(radius, half));
+}
+
+bool lvgl_port_visible_pixel(const lvgl_port_visible_t *vis, int32_t x, int32_t y)
+{
+    if (x < vis->x1 || x > vis->x2 || y < vis->y1 || y > vis->y2) {
+        return false;
+    }
+    const int32_t inset = corner_inset(vis->radius, LVGL_PORT_MIN(y - vis->y1, vis->y2 - y));
+    return (x >= vis->x1 + inset && x <= vis->x2 - inset);
+}
+
+bool lvgl_port_visible_clip(const lvgl_port_visible_t *vis, int32_t *x1, int32_t *y1, int32_t *x2, int32_t *y2)
+{
+    int32_t cx1 = LVGL_PORT_MAX(*x1, vis->x1);
+    int32_t cy1 = LVGL_PORT_MAX(*y1, vis->y1);
+    int32_t cx2 = LVGL_PORT_MIN(*x2, vis->x2);
+    int32_t cy2 = LVGL_PORT_MIN(*y2, vis->y2);
+    if (cx1 > cx2 || cy1 > cy2) {
+        return false;
+    }
+
+    /* Columns of the widest row, then rows of the highest column in these columns */
+    const int32_t inset_x = corner_inset(vis->radius, edge_distance(cy1, cy2, vis->y1, vis->y2));
+    cx1 = LVGL_PORT_MAX(cx1, vis->x1 + inset_x);
+    cx2 = LVGL_PORT_MIN(cx2, vis->x2 - inset_x);
+    if (cx1 > cx2) {
+        return false;
+    }
+    const int32_t inset_y = corner_inset(vis->radius, edge_distance(cx1, cx2, vis->x1, vis->x2));
+    cy1 = LVGL_PORT_MAX(cy1, vis->y1 + inset_y);
+    cy2 = LVGL_PORT_MIN(cy2, vis->y2 - inset_y);
+
+    *x1 = cx1;
+    *y1 = cy1;
+    *x2 = cx2;
+    *y2 = cy2;
+    return true;
+}
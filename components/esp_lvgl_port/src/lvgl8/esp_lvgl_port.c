@@ -56,6 +56,7 @@ esp_err_t lvgl_port_init(const lvgl_port_cfg_t *cfg)
     esp_err_t ret = ESP_OK;
     ESP_GOTO_ON_FALSE(cfg, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
     ESP_GOTO_ON_FALSE(cfg->task_affinity < (configNUM_CORES), ESP_ERR_INVALID_ARG, err, TAG, "Bad core number for task! Maximum core number is %d", (configNUM_CORES - 1));
+    ESP_GOTO_ON_FALSE(cfg->target_fps == 0, ESP_ERR_NOT_SUPPORTED, err, TAG, "Frame pacing is not supported, when used LVGL8!");
 
     memset(&lvgl_port_ctx, 0, sizeof(lvgl_port_ctx));
 
@@ -116,6 +117,35 @@ esp_err_t lvgl_port_stop(void)
     return ret;
 }
 
+esp_err_t lvgl_port_replay_start(const lvgl_port_replay_cfg_t *cfg)
+{
+    ESP_LOGE(TAG, "Replay is not supported, when used LVGL8!");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t lvgl_port_replay_stop(void)
+{
+    ESP_LOGE(TAG, "Replay is not supported, when used LVGL8!");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t lvgl_port_record_start(uint32_t *buf, uint32_t len)
+{
+    ESP_LOGE(TAG, "Recording is not supported, when used LVGL8!");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+uint32_t lvgl_port_record_stop(void)
+{
+    return 0;
+}
+
+esp_err_t lvgl_port_get_frame_stats(lvgl_port_frame_stats_t *stats, bool reset)
+{
+    ESP_LOGE(TAG, "Frame pacing is not supported, when used LVGL8!");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
 esp_err_t lvgl_port_deinit(void)
 {
     /* Stop and delete timer */
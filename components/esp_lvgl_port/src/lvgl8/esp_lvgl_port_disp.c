@@ -203,6 +203,30 @@ void lvgl_port_flush_ready(lv_disp_t *disp)
     lv_disp_flush_ready(disp->driver);
 }
 
+esp_err_t lvgl_port_disp_get_flush_stats(lv_disp_t *disp, lvgl_port_disp_flush_stats_t *stats, bool reset)
+{
+    ESP_LOGE(TAG, "Flush statistics are not supported, when used LVGL8!");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t lvgl_port_disp_set_area_cost(lv_disp_t *disp, const lvgl_port_area_cost_cfg_t *cost)
+{
+    ESP_LOGE(TAG, "Merging of areas is not supported, when used LVGL8!");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t lvgl_port_disp_get_buff_tune(lv_disp_t *disp, lvgl_port_buff_tune_info_t *info)
+{
+    ESP_LOGE(TAG, "Draw buffer tuning is not supported, when used LVGL8!");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t lvgl_port_disp_get_buff_pool_stats(lvgl_port_buff_pool_stats_t *stats, bool reset)
+{
+    ESP_LOGE(TAG, "Shared draw buffers are not supported, when used LVGL8!");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
 /*******************************************************************************
 * Private functions
 *******************************************************************************/
@@ -231,6 +255,18 @@ static lv_disp_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp_cf
     assert(disp_cfg->hres > 0);
     assert(disp_cfg->vres > 0);
 
+    /* Features of the LVGL 9 port */
+    ESP_RETURN_ON_FALSE(disp_cfg->ring_buffers == 0, NULL, TAG, "Flush ring is not supported, when used LVGL8!");
+    ESP_RETURN_ON_FALSE(!disp_cfg->flags.diff_flush, NULL, TAG, "Diff flush is not supported, when used LVGL8!");
+    ESP_RETURN_ON_FALSE(!disp_cfg->output.rgb444, NULL, TAG, "RGB444 output is not supported, when used LVGL8!");
+    ESP_RETURN_ON_FALSE(!disp_cfg->te.sync, NULL, TAG, "TE synchronization is not supported, when used LVGL8!");
+    ESP_RETURN_ON_FALSE(!disp_cfg->buff_tune.enable, NULL, TAG, "Draw buffer tuning is not supported, when used LVGL8!");
+    ESP_RETURN_ON_FALSE(!disp_cfg->flags.chain_bands, NULL, TAG, "Chained bands are not supported, when used LVGL8!");
+    ESP_RETURN_ON_FALSE(disp_cfg->poll_max_bytes == 0, NULL, TAG, "Polled transfers are not supported, when used LVGL8!");
+    ESP_RETURN_ON_FALSE(!disp_cfg->flags.shared_buffers, NULL, TAG, "Shared draw buffers are not supported, when used LVGL8!");
+    ESP_RETURN_ON_FALSE(disp_cfg->visible.width == 0, NULL, TAG, "Visible window is not supported, when used LVGL8!");
+    ESP_RETURN_ON_FALSE(disp_cfg->rounder.x_align <= 1 && disp_cfg->rounder.y_align <= 1 && disp_cfg->rounder.min_width == 0, NULL, TAG, "Rounder is not supported, when used LVGL8!");
+
     /* Display context */
     lvgl_port_display_ctx_t *disp_ctx = malloc(sizeof(lvgl_port_display_ctx_t));
     ESP_GOTO_ON_FALSE(disp_ctx, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for display context allocation!");
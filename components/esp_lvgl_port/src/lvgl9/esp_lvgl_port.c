@@ -16,6 +16,8 @@
 #include "freertos/semphr.h"
 #include "esp_lvgl_port.h"
 #include "esp_lvgl_port_priv.h"
+#include "esp_lvgl_port_pace.h"
+#include "esp_lvgl_port_replay.h"
 #include "lvgl.h"
 
 static const char *TAG = "LVGL";
@@ -36,6 +38,11 @@ typedef struct lvgl_port_ctx_s {
     bool                running;
     int                 task_max_sleep_ms;
     int                 timer_period_ms;
+    bool                replay_active;  /* LVGL tick driven from recorded/synthetic clock */
+    lvgl_port_replay_t  replay;
+    lvgl_port_record_t  record;         /* Recorded LVGL tick increments per task cycle */
+    lvgl_port_pace_t    pace;           /* Frame pacing (target_fps) */
+    bool                refr_pending;   /* Display was invalidated since the last paced frame */
 } lvgl_port_ctx_t;
 
 /*******************************************************************************
@@ -49,6 +56,7 @@ static lvgl_port_ctx_t lvgl_port_ctx;
 static void lvgl_port_task(void *arg);
 static esp_err_t lvgl_port_tick_init(void);
 static void lvgl_port_task_deinit(void);
+static void lvgl_port_pace_timers_ready(void);
 
 /*******************************************************************************
 * Public API functions
@@ -59,9 +67,13 @@ esp_err_t lvgl_port_init(const lvgl_port_cfg_t *cfg)
     esp_err_t ret = ESP_OK;
     ESP_GOTO_ON_FALSE(cfg, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
     ESP_GOTO_ON_FALSE(cfg->task_affinity < (configNUM_CORES), ESP_ERR_INVALID_ARG, err, TAG, "Bad core number for task! Maximum core number is %d", (configNUM_CORES - 1));
+    ESP_GOTO_ON_FALSE(cfg->target_fps >= 0 && cfg->target_fps <= 1000, ESP_ERR_INVALID_ARG, err, TAG, "Bad target FPS!");
 
     memset(&lvgl_port_ctx, 0, sizeof(lvgl_port_ctx));
 
+    /* Frame pacing */
+    lvgl_port_pace_init(&lvgl_port_ctx.pace, (cfg->target_fps > 0 ? 1000000 / cfg->target_fps : 0), esp_timer_get_time());
+
     /* Tick init */
     lvgl_port_ctx.timer_period_ms = cfg->timer_period_ms;
     /* Create task */
@@ -104,7 +116,8 @@ esp_err_t lvgl_port_resume(void)
 
     if (lvgl_port_ctx.tick_timer != NULL) {
         lv_timer_enable(true);
-        ret = esp_timer_start_periodic(lvgl_port_ctx.tick_timer, lvgl_port_ctx.timer_period_ms * 1000);
+        /* In replay mode, the tick is driven from LVGL task */
+        ret = lvgl_port_ctx.replay_active ? ESP_OK : esp_timer_start_periodic(lvgl_port_ctx.tick_timer, lvgl_port_ctx.timer_period_ms * 1000);
     }
 
     return ret;
@@ -122,6 +135,90 @@ esp_err_t lvgl_port_stop(void)
     return ret;
 }
 
+esp_err_t lvgl_port_replay_start(const lvgl_port_replay_cfg_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(cfg, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(cfg->tick_period_ms > 0 || (cfg->tick_deltas && cfg->tick_deltas_count > 0), ESP_ERR_INVALID_ARG, TAG, "Replay needs a tick period or recorded ticks!");
+    ESP_RETURN_ON_FALSE(lvgl_port_ctx.tick_timer, ESP_ERR_INVALID_STATE, TAG, "LVGL port is not initialized!");
+
+    lvgl_port_lock(0);
+    if (lvgl_port_ctx.replay_active) {
+        lvgl_port_unlock();
+        ESP_LOGE(TAG, "Replay is already running!");
+        return ESP_ERR_INVALID_STATE;
+    }
+    /* Stop the real clock, LVGL task takes over */
+    esp_timer_stop(lvgl_port_ctx.tick_timer);
+    lvgl_port_replay_init(&lvgl_port_ctx.replay, cfg->tick_period_ms, cfg->tick_deltas, cfg->tick_deltas_count);
+    lvgl_port_ctx.replay_active = true;
+    lvgl_port_unlock();
+
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_replay_stop(void)
+{
+    /* Checked and cleared under the lock, only one of racing callers restarts the tick timer */
+    lvgl_port_lock(0);
+    const bool active = lvgl_port_ctx.replay_active;
+    lvgl_port_ctx.replay_active = false;
+    lvgl_port_unlock();
+    ESP_RETURN_ON_FALSE(active, ESP_ERR_INVALID_STATE, TAG, "Replay is not running!");
+
+    return esp_timer_start_periodic(lvgl_port_ctx.tick_timer, lvgl_port_ctx.timer_period_ms * 1000);
+}
+
+esp_err_t lvgl_port_record_start(uint32_t *buf, uint32_t len)
+{
+    ESP_RETURN_ON_FALSE(buf && len > 0, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    lvgl_port_lock(0);
+    lvgl_port_record_init(&lvgl_port_ctx.record, buf, len, lv_tick_get());
+    lvgl_port_unlock();
+
+    return ESP_OK;
+}
+
+uint32_t lvgl_port_record_stop(void)
+{
+    lvgl_port_lock(0);
+    uint32_t count = lvgl_port_ctx.record.count;
+    lvgl_port_record_init(&lvgl_port_ctx.record, NULL, 0, 0);
+    lvgl_port_unlock();
+
+    return count;
+}
+
+esp_err_t lvgl_port_get_frame_stats(lvgl_port_frame_stats_t *stats, bool reset)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(lvgl_port_ctx.pace.period_us > 0, ESP_ERR_INVALID_STATE, TAG, "Frame pacing is not enabled!");
+
+    lvgl_port_pace_stats_t pace_stats;
+    lvgl_port_lock(0);
+    const int64_t now = esp_timer_get_time();
+    lvgl_port_pace_get_stats(&lvgl_port_ctx.pace, now, &pace_stats);
+    if (reset) {
+        lvgl_port_pace_reset_stats(&lvgl_port_ctx.pace, now);
+    }
+    lvgl_port_unlock();
+
+    memset(stats, 0, sizeof(lvgl_port_frame_stats_t));
+    stats->frames = pace_stats.frames;
+    stats->fps = (pace_stats.elapsed_us ? (uint32_t)((uint64_t)pace_stats.frames * 1000000 / pace_stats.elapsed_us) : 0);
+    stats->late = pace_stats.late;
+    stats->missed = pace_stats.missed;
+    stats->work_us = pace_stats.work_us;
+    stats->work_max_us = pace_stats.work_max_us;
+    stats->slack_us = pace_stats.slack_us;
+    stats->slack_min_us = pace_stats.slack_min_us;
+    stats->interval_avg_us = pace_stats.interval_avg_us;
+    stats->interval_dev_us = pace_stats.interval_dev_us;
+    stats->elapsed_us = pace_stats.elapsed_us;
+
+    return ESP_OK;
+}
+
 esp_err_t lvgl_port_deinit(void)
 {
     /* Stop and delete timer */
@@ -200,6 +297,12 @@ IRAM_ATTR bool lvgl_port_task_notify(uint32_t value)
     return (need_yield == pdTRUE);
 }
 
+int lvgl_port_get_task_priority(void)
+{
+    assert(lvgl_port_ctx.lvgl_task);
+    return uxTaskPriorityGet(lvgl_port_ctx.lvgl_task);
+}
+
 /*******************************************************************************
 * Private functions
 *******************************************************************************/
@@ -226,8 +329,16 @@ static void lvgl_port_task(void *arg)
     lvgl_port_ctx.running = true;
     while (lvgl_port_ctx.running) {
         /* Wait for queue or timeout (sleep task) */
-        TickType_t wait = (pdMS_TO_TICKS(task_delay_ms) >= 1 ? pdMS_TO_TICKS(task_delay_ms) : 1);
-        xQueueReceive(lvgl_port_ctx.lvgl_queue, &event, wait);
+        uint32_t sleep_ms = task_delay_ms;
+        if (lvgl_port_ctx.pace.period_us > 0) {
+            /* Sleep until the next frame, or longer, when nothing was invalidated and no LVGL timer is ready before */
+            const uint32_t frame_ms = (lvgl_port_pace_get_wait(&lvgl_port_ctx.pace, esp_timer_get_time()) + 999) / 1000;
+            sleep_ms = (lvgl_port_ctx.refr_pending || frame_ms > task_delay_ms ? frame_ms : task_delay_ms);
+        }
+        TickType_t wait = (pdMS_TO_TICKS(sleep_ms) >= 1 ? pdMS_TO_TICKS(sleep_ms) : 1);
+        if (xQueueReceive(lvgl_port_ctx.lvgl_queue, &event, wait) == pdTRUE && event.type == LVGL_PORT_EVENT_DISPLAY) {
+            lvgl_port_ctx.refr_pending = true;
+        }
 
         if (lv_display_get_default() && lvgl_port_lock(0)) {
 
@@ -246,8 +357,29 @@ static void lvgl_port_task(void *arg)
                 xSemaphoreGive(lvgl_port_ctx.timer_mux);
             }
 
-            /* Handle LVGL */
-            task_delay_ms = lv_timer_handler();
+            /* Between paced frames, the invalidated areas are coalesced into the next frame */
+            if (lvgl_port_ctx.pace.period_us == 0 || lvgl_port_pace_get_wait(&lvgl_port_ctx.pace, esp_timer_get_time()) == 0) {
+                if (lvgl_port_ctx.pace.period_us > 0) {
+                    lvgl_port_pace_frame_start(&lvgl_port_ctx.pace, esp_timer_get_time(), lvgl_port_ctx.refr_pending);
+                    lvgl_port_ctx.refr_pending = false;
+                    lvgl_port_pace_timers_ready();
+                }
+
+                /* Advance LVGL tick from recorded/synthetic clock */
+                if (lvgl_port_ctx.replay_active) {
+                    lv_tick_inc(lvgl_port_replay_next(&lvgl_port_ctx.replay));
+                }
+
+                /* Record LVGL tick increment of this cycle */
+                lvgl_port_record_tick(&lvgl_port_ctx.record, lv_tick_get());
+
+                /* Handle LVGL */
+                task_delay_ms = lv_timer_handler();
+
+                if (lvgl_port_ctx.pace.period_us > 0) {
+                    lvgl_port_pace_frame_end(&lvgl_port_ctx.pace, esp_timer_get_time());
+                }
+            }
             lvgl_port_unlock();
         } else {
             task_delay_ms = 1; /*Keep trying*/
@@ -289,6 +421,27 @@ static void lvgl_port_task_deinit(void)
 #endif
 }
 
+static void lvgl_port_pace_timers_ready(void)
+{
+    /*
+     * LVGL timers run, when their period elapsed in whole LVGL ticks. A frame period, which is not a multiple
+     * of the tick, would skip the display refresh or the animations in some frames, so they run in every paced frame.
+     * Refresh timers of displays without invalidated areas are paused and stay paused.
+     */
+    lv_display_t *disp = lv_display_get_next(NULL);
+    while (disp != NULL) {
+        lv_timer_t *refr_timer = lv_display_get_refr_timer(disp);
+        if (refr_timer) {
+            lv_timer_ready(refr_timer);
+        }
+        disp = lv_display_get_next(disp);
+    }
+    lv_timer_t *anim_timer = lv_anim_get_timer();
+    if (anim_timer) {
+        lv_timer_ready(anim_timer);
+    }
+}
+
 static void lvgl_port_tick_increment(void *arg)
 {
     xSemaphoreTake(lvgl_port_ctx.timer_mux, portMAX_DELAY);
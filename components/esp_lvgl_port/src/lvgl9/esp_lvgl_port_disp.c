@@ -5,6 +5,7 @@
  */
 
 #include <string.h>
+#include <inttypes.h>
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_check.h"
@@ -13,10 +14,30 @@
 #include "freertos/semphr.h"
 #include "esp_heap_caps.h"
 #include "esp_idf_version.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include "esp_memory_utils.h"
+#else
+#include "soc/soc_memory_layout.h"
+#endif
+#include "driver/gpio.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_commands.h"
 #include "esp_lvgl_port.h"
 #include "esp_lvgl_port_priv.h"
+#include "esp_lvgl_port_color.h"
+#include "esp_lvgl_port_diff.h"
+#include "esp_lvgl_port_te.h"
+#include "esp_lvgl_port_buff_tune.h"
+#include "esp_lvgl_port_sync.h"
+#include "esp_lvgl_port_visible.h"
+#include "esp_lvgl_port_copy.h"
+#include "esp_lvgl_port_rounder.h"
+#include "esp_lvgl_port_merge.h"
+#include "esp_lvgl_port_chain.h"
+#include "esp_lvgl_port_buff_pool.h"
 
 #if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
 #include "esp_lcd_panel_rgb.h"
@@ -26,25 +47,68 @@
 #include "esp_lcd_mipi_dsi.h"
 #endif
 
+#if LV_VERSION_CHECK(9, 2, 0)
+/* Private since LVGL 9.2 */
+lv_display_t *lv_refr_get_disp_refreshing(void);
+#endif
+
 #if (ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(4, 4, 4)) || (ESP_IDF_VERSION == ESP_IDF_VERSION_VAL(5, 0, 0))
 #define LVGL_PORT_HANDLE_FLUSH_READY 0
 #else
 #define LVGL_PORT_HANDLE_FLUSH_READY 1
 #endif
 
+/* Maximum number of draw buffers in the flush ring */
+#define LVGL_PORT_RING_BUFFS_MAX        4
+#define LVGL_PORT_RING_TASK_STACK       3072
+/* Shorter waits for flushing are the event overhead, not a stall */
+#define LVGL_PORT_STALL_MIN_US          20
+/* Maximum number of changed windows sent for one flushed area in the diff flush */
+#define LVGL_PORT_DIFF_WINDOWS_MAX      8
+/* COLMOD parameter for 12 bits per pixel (ST7789: 65K RGB interface, 12-bit control interface) */
+#define LVGL_PORT_COLMOD_RGB444         0x53
+/* Write opcodes of QSPI panels, in the first byte of the command word (commands on one line, pixels on four lines) */
+#define LVGL_PORT_QSPI_OPCODE_CMD       0x02
+#define LVGL_PORT_QSPI_OPCODE_COLOR     0x32
+/* TE pulses further apart are not a period (TE was off or the pulse was missed) */
+#define LVGL_PORT_TE_PERIOD_MAX_US      100000
+/* Shorter TE delays are waited actively, a timer wakeup would take longer */
+#define LVGL_PORT_TE_SPIN_MAX_US        200
+/* Added to the estimated band transfer time (task wakeup and command phase jitter) */
+#define LVGL_PORT_TE_MARGIN_US          100
+/* Draw buffer tuning: frames between decisions, defaults of the configuration */
+#define LVGL_PORT_BUFF_TUNE_WINDOW      32
+#define LVGL_PORT_BUFF_TUNE_MIN_LINES   4
+#define LVGL_PORT_BUFF_TUNE_HEAP_RESERVE    (16 * 1024)
+/* Maximum wait for the last band of the frame before resizing */
+#define LVGL_PORT_BUFF_TUNE_WAIT_MS     100
+/* Frame buffer sync: maximum count of spans copied in the background */
+#define LVGL_PORT_SYNC_COPY_BACKLOG     8
+
 static const char *TAG = "LVGL";
 
 /*******************************************************************************
 * Types definitions
 *******************************************************************************/
 
+typedef struct {
+    int             x_start;
+    int             y_start;
+    int             x_end;
+    int             y_end;
+    const void      *color_map;     /* NULL: stop the flush task */
+    TaskHandle_t    notify;         /* Task notified, when the flush task is stopped */
+} lvgl_port_ring_item_t;
+
 typedef struct {
     lvgl_port_disp_type_t     disp_type;    /* Display type */
     esp_lcd_panel_io_handle_t io_handle;      /* LCD panel IO handle */
     esp_lcd_panel_handle_t    panel_handle;   /* LCD panel handle */
     esp_lcd_panel_handle_t    control_handle; /* LCD panel control handle */
     lvgl_port_rotation_cfg_t  rotation;       /* Default values of the screen rotation */
+    lvgl_port_output_cfg_t    output;         /* Reduced color depth output */
     lv_color_t                *draw_buffs[3]; /* Display draw buffers */
+    uint8_t                   *rotate_tile;   /* SW rotation of buffers in PSRAM: tile in internal RAM */
     uint8_t                   *oled_buffer;
     lv_display_t              *disp_drv;      /* LVGL display driver */
     lv_display_rotation_t     current_rotation;
@@ -55,15 +119,106 @@ typedef struct {
         unsigned int full_refresh: 1;   /* Always make the whole screen redrawn */
         unsigned int direct_mode: 1;    /* Use screen-sized buffers and draw to absolute coordinates */
         unsigned int sw_rotate: 1;    /* Use software rotation (slower) or PPA if available */
+        unsigned int diff_flush: 1;   /* Send only rows changed against the panel content */
+        unsigned int te_sync: 1;      /* Band transfers are delayed by the panel scan position */
+        unsigned int buff_tune: 1;    /* Draw buffers are resized between frames */
+        unsigned int fb_sync: 1;      /* Direct mode: the port swaps the frame buffers and synchronizes them */
+        unsigned int chain_bands: 1;  /* Next band of the same area continues the panel window */
+        unsigned int buff_pool: 1;    /* Draw buffers are borrowed from the shared pool for each refresh */
+        unsigned int visible: 1;      /* Invalidated areas are clipped to the visible window */
+        unsigned int rounder: 1;      /* Invalidated areas are extended to the alignment of the panel */
     } flags;
+    struct {
+        uint8_t             count;          /* Number of draw buffers in the ring (0: ring is not used) */
+        uint8_t             render;         /* Index of the buffer, which LVGL renders into */
+        uint32_t            buff_size;      /* Size of one buffer in bytes */
+        lv_color_t          *buffs[LVGL_PORT_RING_BUFFS_MAX];
+        QueueHandle_t       queue;          /* Flushes queued for the flush task */
+        SemaphoreHandle_t   free_sem;       /* Counting semaphore of buffers, which are not in flight */
+        TaskHandle_t        task;           /* Flush task, it sends queued flushes to the panel IO */
+    } ring;                                 /* Partial draw buffers ring */
+    struct {
+        lvgl_port_disp_flush_stats_t counters;
+        int64_t             reset_time;
+        int64_t             wait_start;
+    } stats;                                /* Flush statistics */
+    lvgl_port_merge_t       merge;          /* Merging of invalidated areas by the flush cost model (bytes_per_us 0: merging is disabled) */
+    struct {
+        lvgl_port_diff_t    shadow;         /* Hashes of the panel content */
+        lvgl_port_diff_window_t windows[LVGL_PORT_DIFF_WINDOWS_MAX];
+        volatile uint32_t   pending;        /* Windows in flight, LVGL is notified after the last one */
+        uint8_t             *oled_sent;     /* Monochrome: copy of the pages sent to the panel */
+        bool                oled_sent_valid;
+    } diff;                                 /* Diff flush */
+    struct {
+        int                 gpio_num;       /* TE GPIO */
+        portMUX_TYPE        lock;           /* TE time and period are written in ISR */
+        int64_t             last_us;        /* Time of the last TE pulse (scan of row 0) */
+        uint32_t            period_us;      /* Measured TE period (0: not measured yet) */
+        volatile int64_t    trans_start;    /* Start of the measured band transfer */
+        volatile uint32_t   trans_bytes;    /* Bytes of the measured band transfer (0: no measurement in flight) */
+        volatile uint32_t   ns_per_byte;    /* Measured band transfer time, including the commands */
+        esp_timer_handle_t  timer;          /* Wakes the flushing task after the TE delay */
+        SemaphoreHandle_t   sem;
+        bool                swap_xy;        /* Panel orientation set in lvgl_port_disp_rotation_update() */
+        bool                mirror_rows;    /* Rows are written in reversed order to the panel memory */
+    } te;                                   /* Tearing effect synchronization */
+    struct {
+        lvgl_port_buff_tune_t state;
+        uint32_t            caps;           /* Heap capabilities of the draw buffers */
+        uint32_t            heap_reserve;   /* Free heap left for the application */
+        uint32_t            resizes;
+        int64_t             render_start;   /* LVGL started rendering the band */
+        int64_t             wait_us;        /* Time LVGL waited for flushing while rendering the band */
+        int64_t             flush_start;
+        uint32_t            flush_px;       /* Pixels of the band in flight */
+        volatile int64_t    flush_end;      /* Set in the IO callback (0: no finished flush to measure) */
+        volatile bool       in_flight;
+        SemaphoreHandle_t   done_sem;       /* Given, when the band in flight is done */
+    } tune;                                 /* Draw buffer size tuning */
+    struct {
+        lvgl_port_sync_t    areas;          /* Areas drawn into the back buffer in this frame */
+        lv_color_t          *fbs[2];        /* Frame buffers of the panel */
+        uint8_t             back;           /* Index of the buffer, which LVGL draws into */
+        uint32_t            size;           /* Size of one frame buffer in bytes */
+        lvgl_port_copy_t    *copy;          /* Copies the areas in the background (NULL: CPU copy) */
+    } sync;                                 /* Synchronization of the frame buffers in direct mode */
+    lvgl_port_chain_t       chain;          /* Chained bands: panel window of the last band */
+    struct {
+        uint32_t            max_bytes;      /* Bands up to this size are sent by polling (0: always queued) */
+        uint32_t            sent;           /* Queued transfers, written by the flushing task */
+        volatile uint32_t   done;           /* Finished queued transfers, written in the IO callback */
+        volatile uint32_t   measured;       /* Sequence number of the measured queued transfer (0: none) */
+        int64_t             start;          /* Start of the measured transfer */
+    } poll;                                 /* Polled transfers of small bands */
+    struct {
+        lvgl_port_buff_pool_user_t user;    /* Draw buffers of this display and the band in flight */
+        lv_display_render_mode_t render_mode;
+    } pool;                                 /* Shared draw buffers */
+    struct {
+        lvgl_port_visible_cfg_t cfg;        /* Visible window at rotation 0 */
+        uint32_t            hres;           /* Resolution at rotation 0 */
+        uint32_t            vres;
+        lvgl_port_visible_t window;         /* Visible window in the current rotation */
+    } visible;                              /* Visible window of the panel */
+    struct {
+        lvgl_port_rounder_cfg_t cfg;        /* Alignment at rotation 0 */
+        uint32_t            hres;           /* Resolution at rotation 0 */
+        uint32_t            vres;
+        lvgl_port_rounder_t area;           /* Rounding in the current rotation */
+    } rounder;                              /* Alignment of the windows */
 } lvgl_port_display_ctx_t;
 
+/* Draw buffers shared by the displays, only one display renders at a time in the LVGL task */
+static lvgl_port_buff_pool_t lvgl_port_buff_pool;
+
 /*******************************************************************************
 * Function definitions
 *******************************************************************************/
 static lv_display_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp_cfg, const lvgl_port_disp_priv_cfg_t *priv_cfg);
 #if LVGL_PORT_HANDLE_FLUSH_READY
 static bool lvgl_port_flush_io_ready_callback(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx);
+static bool lvgl_port_flush_done(lv_display_t *disp_drv);
 #if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
 static bool lvgl_port_flush_rgb_vsync_ready_callback(esp_lcd_panel_handle_t panel_io, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx);
 #endif
@@ -76,6 +231,32 @@ static void lvgl_port_flush_callback(lv_display_t *drv, const lv_area_t *area, u
 static void lvgl_port_disp_size_update_callback(lv_event_t *e);
 static void lvgl_port_disp_rotation_update(lvgl_port_display_ctx_t *disp_ctx);
 static void lvgl_port_display_invalidate_callback(lv_event_t *e);
+static esp_err_t lvgl_port_ring_init(lvgl_port_display_ctx_t *disp_ctx);
+static void lvgl_port_ring_deinit(lvgl_port_display_ctx_t *disp_ctx);
+static void lvgl_port_ring_flush(lvgl_port_display_ctx_t *disp_ctx, int x_start, int y_start, int x_end, int y_end, const void *color_map);
+static void lvgl_port_diff_flush(lvgl_port_display_ctx_t *disp_ctx, int x1, int y1, int x2, int y2, uint8_t *color_map);
+static void lvgl_port_diff_pages_flush(lvgl_port_display_ctx_t *disp_ctx, uint8_t *pages);
+static void lvgl_port_panel_draw(lvgl_port_display_ctx_t *disp_ctx, int x_start, int y_start, int x_end, int y_end, void *color_map);
+static int lvgl_port_panel_cmd(const lvgl_port_display_ctx_t *disp_ctx, int dcs_cmd, bool color);
+static void lvgl_port_panel_tx_color(lvgl_port_display_ctx_t *disp_ctx, int dcs_cmd, const void *color_map, size_t len, int64_t start);
+static esp_err_t lvgl_port_te_init(lvgl_port_display_ctx_t *disp_ctx, int gpio_num);
+static void lvgl_port_te_deinit(lvgl_port_display_ctx_t *disp_ctx);
+static void lvgl_port_te_wait(lvgl_port_display_ctx_t *disp_ctx, int x_start, int y_start, int x_end, int y_end, size_t len);
+static uint32_t lvgl_port_buff_tune_start(lvgl_port_display_ctx_t *disp_ctx, const lvgl_port_display_cfg_t *disp_cfg, lv_color_format_t color_format, uint32_t buff_caps);
+static void lvgl_port_buff_tune_band(lvgl_port_display_ctx_t *disp_ctx, const lv_area_t *area);
+static void lvgl_port_disp_buff_tune_callback(lv_event_t *e);
+static void lvgl_port_fb_sync(lvgl_port_display_ctx_t *disp_ctx);
+static void lvgl_port_disp_fb_sync_callback(lv_event_t *e);
+static void lvgl_port_disp_buff_pool_callback(lv_event_t *e);
+#if LV_VERSION_CHECK(9, 2, 0)
+static void lvgl_port_disp_flush_wait_callback(lv_event_t *e);
+#endif
+static void lvgl_port_disp_area_merge_callback(lv_event_t *e);
+static void lvgl_port_disp_diff_round_callback(lv_event_t *e);
+static bool lvgl_port_disp_is_refreshing(lv_display_t *disp);
+static void lvgl_port_disp_visible_update(lvgl_port_display_ctx_t *disp_ctx);
+static void lvgl_port_disp_visible_callback(lv_event_t *e);
+static void lvgl_port_disp_rounder_callback(lv_event_t *e);
 
 /*******************************************************************************
 * Public API functions
@@ -192,7 +373,15 @@ esp_err_t lvgl_port_remove_disp(lv_display_t *disp)
     assert(disp);
     lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
 
+    /* Wait for the queued flushes */
+    lvgl_port_ring_deinit(disp_ctx);
+    lvgl_port_te_deinit(disp_ctx);
+
     lvgl_port_lock(0);
+    /* The last band can be sent from the shared buffers */
+    if (disp_ctx->flags.buff_pool) {
+        lvgl_port_buff_pool_remove(&lvgl_port_buff_pool, &disp_ctx->pool.user);
+    }
     lv_disp_remove(disp);
     lvgl_port_unlock();
 
@@ -208,14 +397,39 @@ esp_err_t lvgl_port_remove_disp(lv_display_t *disp)
         free(disp_ctx->draw_buffs[2]);
     }
 
+    if (disp_ctx->rotate_tile) {
+        free(disp_ctx->rotate_tile);
+    }
+
+    for (int i = 2; i < LVGL_PORT_RING_BUFFS_MAX; i++) {
+        if (disp_ctx->ring.buffs[i]) {
+            free(disp_ctx->ring.buffs[i]);
+        }
+    }
+
     if (disp_ctx->oled_buffer) {
         free(disp_ctx->oled_buffer);
     }
 
+    if (disp_ctx->diff.shadow.hashes) {
+        free(disp_ctx->diff.shadow.hashes);
+    }
+
+    if (disp_ctx->diff.oled_sent) {
+        free(disp_ctx->diff.oled_sent);
+    }
+
     if (disp_ctx->trans_sem) {
         vSemaphoreDelete(disp_ctx->trans_sem);
     }
 
+    if (disp_ctx->tune.done_sem) {
+        vSemaphoreDelete(disp_ctx->tune.done_sem);
+    }
+
+    /* Waits for the copies in the background */
+    lvgl_port_copy_del(disp_ctx->sync.copy);
+
     free(disp_ctx);
 
     return ESP_OK;
@@ -227,6 +441,90 @@ void lvgl_port_flush_ready(lv_display_t *disp)
     lv_disp_flush_ready(disp);
 }
 
+esp_err_t lvgl_port_disp_get_flush_stats(lv_display_t *disp, lvgl_port_disp_flush_stats_t *stats, bool reset)
+{
+    ESP_RETURN_ON_FALSE(disp && stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_ARG, TAG, "invalid display");
+
+    lvgl_port_lock(0);
+    int64_t now = esp_timer_get_time();
+    *stats = disp_ctx->stats.counters;
+    stats->elapsed_us = now - disp_ctx->stats.reset_time;
+    stats->fps = (stats->elapsed_us > 0 ? (uint32_t)((uint64_t)stats->frames * 1000000 / stats->elapsed_us) : 0);
+    if (reset) {
+        memset(&disp_ctx->stats.counters, 0, sizeof(disp_ctx->stats.counters));
+        disp_ctx->stats.reset_time = now;
+    }
+    lvgl_port_unlock();
+
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_disp_set_area_cost(lv_display_t *disp, const lvgl_port_area_cost_cfg_t *cost)
+{
+    ESP_RETURN_ON_FALSE(disp, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_ARG, TAG, "invalid display");
+
+    lvgl_port_lock(0);
+    disp_ctx->merge.trans_overhead_us = (cost ? cost->trans_overhead_us : 0);
+    disp_ctx->merge.bytes_per_us = (cost ? cost->bytes_per_us : 0);
+    lvgl_port_merge_reset(&disp_ctx->merge);
+    lvgl_port_unlock();
+
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_disp_get_buff_tune(lv_display_t *disp, lvgl_port_buff_tune_info_t *info)
+{
+    ESP_RETURN_ON_FALSE(disp && info, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_ARG, TAG, "invalid display");
+    ESP_RETURN_ON_FALSE(disp_ctx->flags.buff_tune, ESP_ERR_INVALID_STATE, TAG, "Draw buffer tuning is not enabled");
+
+    lvgl_port_lock(0);
+    const lvgl_port_buff_tune_t *state = &disp_ctx->tune.state;
+    const uint32_t size = lvgl_port_buff_tune_get_size(state);
+    info->buffer_size = (size + sizeof(lv_color_t) - 1) / sizeof(lv_color_t);
+    info->lines = size / (lv_display_get_horizontal_resolution(disp) * state->px_size);
+    info->buffers = state->buffers;
+    info->frame_us = state->predicted_us[state->current];
+    info->resizes = disp_ctx->tune.resizes;
+    info->stable = (state->stable >= 3);
+    lvgl_port_unlock();
+
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_disp_get_buff_pool_stats(lvgl_port_buff_pool_stats_t *stats, bool reset)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    lvgl_port_buff_pool_t *pool = &lvgl_port_buff_pool;
+
+    lvgl_port_lock(0);
+    memset(stats, 0, sizeof(lvgl_port_buff_pool_stats_t));
+    stats->displays = pool->users;
+    for (int i = 0; i < LVGL_PORT_BUFF_POOL_BUFFS; i++) {
+        if (pool->buffs[i]) {
+            stats->buffers++;
+            stats->pool_bytes += pool->sizes[i];
+        }
+    }
+    stats->private_bytes = pool->private_bytes;
+    stats->borrows = pool->borrows;
+    stats->waits = pool->waits;
+    stats->wait_us = pool->wait_us;
+    if (reset) {
+        pool->borrows = 0;
+        pool->waits = 0;
+        pool->wait_us = 0;
+    }
+    lvgl_port_unlock();
+
+    return ESP_OK;
+}
+
 /*******************************************************************************
 * Private functions
 *******************************************************************************/
@@ -238,6 +536,7 @@ static lv_display_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp
     lv_color_t *buf1 = NULL;
     lv_color_t *buf2 = NULL;
     uint32_t buffer_size = 0;
+    uint32_t buff_bytes = 0;
     SemaphoreHandle_t trans_sem = NULL;
     assert(disp_cfg != NULL);
     assert(disp_cfg->panel_handle != NULL);
@@ -246,6 +545,7 @@ static lv_display_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp
     assert(disp_cfg->vres > 0);
 
     buffer_size = disp_cfg->buffer_size;
+    buff_bytes = buffer_size * sizeof(lv_color_t);
 
     /* Check supported display color formats */
     ESP_RETURN_ON_FALSE(disp_cfg->color_format == 0 || disp_cfg->color_format == LV_COLOR_FORMAT_RGB565 || disp_cfg->color_format == LV_COLOR_FORMAT_RGB888 || disp_cfg->color_format == LV_COLOR_FORMAT_XRGB8888 || disp_cfg->color_format == LV_COLOR_FORMAT_ARGB8888 || disp_cfg->color_format == LV_COLOR_FORMAT_I1, NULL, TAG, "Not supported display color format!");
@@ -261,6 +561,89 @@ static lv_display_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp
         ESP_RETURN_ON_FALSE(display_color_format == LV_COLOR_FORMAT_RGB565, NULL, TAG, "DMA buffer can be used only in display color format RGB565 (not alligned copy)!");
     }
 
+    if (disp_cfg->ring_buffers) {
+        /* Flush ring is used only for partial rendering to the panel IO */
+        ESP_RETURN_ON_FALSE(disp_cfg->ring_buffers >= 3 && disp_cfg->ring_buffers <= LVGL_PORT_RING_BUFFS_MAX, NULL, TAG, "Flush ring must have 3 to %d buffers!", LVGL_PORT_RING_BUFFS_MAX);
+        ESP_RETURN_ON_FALSE(priv_cfg == NULL && LVGL_PORT_HANDLE_FLUSH_READY, NULL, TAG, "Flush ring can be used only with panel IO displays!");
+        ESP_RETURN_ON_FALSE(!disp_cfg->monochrome && !disp_cfg->flags.direct_mode && !disp_cfg->flags.full_refresh && !disp_cfg->flags.sw_rotate, NULL, TAG, "Flush ring can be used only in partial mode without SW rotation!");
+    }
+
+    if (disp_cfg->flags.diff_flush) {
+        /* Diff flush sends more windows per flushed area to the panel IO */
+        ESP_RETURN_ON_FALSE(priv_cfg == NULL && LVGL_PORT_HANDLE_FLUSH_READY, NULL, TAG, "Diff flush can be used only with panel IO displays!");
+        ESP_RETURN_ON_FALSE(!disp_cfg->ring_buffers, NULL, TAG, "Diff flush can't be used with flush ring!");
+        ESP_RETURN_ON_FALSE(!disp_cfg->monochrome || display_color_format == LV_COLOR_FORMAT_I1, NULL, TAG, "Diff flush can be used only with monochrome display in color format I1!");
+        ESP_RETURN_ON_FALSE(disp_cfg->monochrome || (!disp_cfg->flags.direct_mode && !disp_cfg->flags.full_refresh && !disp_cfg->flags.sw_rotate), NULL, TAG, "Diff flush can be used only in partial mode without SW rotation!");
+    }
+
+    if (disp_cfg->output.rgb444) {
+        /* RGB444 pixels are packed from RGB565 and sent directly to the panel IO, the window is moved by the gap in output */
+        ESP_RETURN_ON_FALSE(priv_cfg == NULL && disp_cfg->io_handle, NULL, TAG, "RGB444 output can be used only with panel IO displays, with the panel gap in output!");
+        /* COLMOD 0x53 and packed pixels in the memory write are known only for MIPI DCS panels on SPI/I8080 */
+        ESP_RETURN_ON_FALSE(disp_cfg->output.cmd_set == LVGL_PORT_PANEL_CMD_DCS, NULL, TAG, "RGB444 output can be used only with MIPI DCS panels on SPI/I8080!");
+        ESP_RETURN_ON_FALSE(display_color_format == LV_COLOR_FORMAT_RGB565 && !disp_cfg->monochrome, NULL, TAG, "RGB444 output can be used only in display color format RGB565!");
+        ESP_RETURN_ON_FALSE(!disp_cfg->flags.swap_bytes, NULL, TAG, "RGB444 output is packed in panel byte order, swap bytes must not be used!");
+    }
+
+    if (disp_cfg->flags.chain_bands) {
+        /* The window and RAMWRC are sent directly to the panel IO, the window is moved by the gap in output */
+        ESP_RETURN_ON_FALSE(priv_cfg == NULL && disp_cfg->io_handle, NULL, TAG, "Chained bands can be used only with panel IO displays, with the panel gap in output!");
+        ESP_RETURN_ON_FALSE(disp_cfg->output.cmd_set != LVGL_PORT_PANEL_CMD_NONE, NULL, TAG, "Chained bands can be used only with MIPI DCS panels, with the command set in output!");
+        ESP_RETURN_ON_FALSE(!disp_cfg->monochrome && !disp_cfg->flags.direct_mode && !disp_cfg->flags.full_refresh, NULL, TAG, "Chained bands can be used only in partial mode!");
+    }
+
+    if (disp_cfg->poll_max_bytes) {
+        /* The window (moved by the gap in output) and pixels are sent directly to the panel IO, a polled band is done before the flush callback returns */
+        ESP_RETURN_ON_FALSE(priv_cfg == NULL && disp_cfg->io_handle && LVGL_PORT_HANDLE_FLUSH_READY, NULL, TAG, "Polled transfers can be used only with panel IO displays, with the panel gap in output!");
+        /* Parameters of QSPI panels are sent on one line, polled pixels would be four times slower than queued */
+        ESP_RETURN_ON_FALSE(disp_cfg->output.cmd_set == LVGL_PORT_PANEL_CMD_DCS, NULL, TAG, "Polled transfers can be used only with MIPI DCS panels on SPI!");
+        ESP_RETURN_ON_FALSE(!disp_cfg->monochrome && !disp_cfg->flags.direct_mode && !disp_cfg->flags.full_refresh, NULL, TAG, "Polled transfers can be used only in partial mode!");
+    }
+
+    if (disp_cfg->te.sync) {
+        /* RGB and MIPI-DSI panels use avoid_tearing, monochrome displays don't have TE output */
+        ESP_RETURN_ON_FALSE(priv_cfg == NULL && disp_cfg->io_handle && LVGL_PORT_HANDLE_FLUSH_READY, NULL, TAG, "TE synchronization can be used only with panel IO displays!");
+        /* TE output is enabled by TEON */
+        ESP_RETURN_ON_FALSE(disp_cfg->output.cmd_set != LVGL_PORT_PANEL_CMD_NONE, NULL, TAG, "TE synchronization can be used only with MIPI DCS panels, with the command set in output!");
+        ESP_RETURN_ON_FALSE(!disp_cfg->monochrome, NULL, TAG, "TE synchronization can't be used with monochrome display!");
+        /* The scan direction is taken from the panel orientation set by the LVGL port */
+        ESP_RETURN_ON_FALSE(!disp_cfg->flags.sw_rotate, NULL, TAG, "TE synchronization can't be used with SW rotation!");
+        ESP_RETURN_ON_FALSE(GPIO_IS_VALID_GPIO(disp_cfg->te.gpio_num), NULL, TAG, "Invalid TE GPIO!");
+    }
+
+    if (disp_cfg->buff_tune.enable) {
+        /* Band times are measured from the flush to the panel IO callback and without the waits for flushing (LVGL 9.2 events) */
+        ESP_RETURN_ON_FALSE(LV_VERSION_CHECK(9, 2, 0), NULL, TAG, "Draw buffer tuning needs LVGL 9.2!");
+        ESP_RETURN_ON_FALSE(priv_cfg == NULL && LVGL_PORT_HANDLE_FLUSH_READY, NULL, TAG, "Draw buffer tuning can be used only with panel IO displays!");
+        ESP_RETURN_ON_FALSE(!disp_cfg->monochrome && !disp_cfg->flags.direct_mode && !disp_cfg->flags.full_refresh && !disp_cfg->flags.sw_rotate, NULL, TAG, "Draw buffer tuning can be used only in partial mode without SW rotation!");
+        ESP_RETURN_ON_FALSE(!disp_cfg->ring_buffers && !disp_cfg->flags.diff_flush, NULL, TAG, "Draw buffer tuning can't be used with flush ring or diff flush!");
+    }
+
+    if (disp_cfg->visible.width) {
+        /* Areas are clipped before LVGL renders them, direct mode and full refresh render the whole screen */
+        ESP_RETURN_ON_FALSE(!disp_cfg->monochrome && !disp_cfg->flags.direct_mode && !disp_cfg->flags.full_refresh, NULL, TAG, "Visible window can be used only in partial mode!");
+        ESP_RETURN_ON_FALSE(disp_cfg->visible.height && disp_cfg->visible.x + disp_cfg->visible.width <= disp_cfg->hres && disp_cfg->visible.y + disp_cfg->visible.height <= disp_cfg->vres, NULL, TAG, "Visible window must be inside of the screen!");
+    }
+
+    if (disp_cfg->rounder.x_align > 1 || disp_cfg->rounder.y_align > 1 || disp_cfg->rounder.min_width) {
+        const uint32_t x_align = (disp_cfg->rounder.x_align ? disp_cfg->rounder.x_align : 1);
+        const uint32_t y_align = (disp_cfg->rounder.y_align ? disp_cfg->rounder.y_align : 1);
+        ESP_RETURN_ON_FALSE(!disp_cfg->monochrome && !disp_cfg->flags.direct_mode && !disp_cfg->flags.full_refresh, NULL, TAG, "Rounder can be used only in partial mode!");
+        /* Diff flush sends changed rows and the tuning resizes the buffers under the alignment */
+        ESP_RETURN_ON_FALSE(!disp_cfg->flags.diff_flush && !disp_cfg->buff_tune.enable, NULL, TAG, "Rounder can't be used with diff flush or draw buffer tuning!");
+        ESP_RETURN_ON_FALSE(disp_cfg->hres % x_align == 0 && disp_cfg->vres % y_align == 0 && disp_cfg->rounder.min_width <= disp_cfg->hres, NULL, TAG, "Resolution must be a multiple of the rounder alignment!");
+        /* LVGL renders bands of aligned height, in any rotation */
+        const uint32_t x_lines = (x_align > disp_cfg->rounder.min_width ? x_align : disp_cfg->rounder.min_width);
+        ESP_RETURN_ON_FALSE(disp_cfg->buffer_size >= disp_cfg->hres * y_align && disp_cfg->buffer_size >= disp_cfg->vres * x_lines, NULL, TAG, "Draw buffer is too small for the rounder alignment!");
+    }
+
+    if (disp_cfg->flags.shared_buffers) {
+        /* The last band of the previous display must be sent, before the next display renders into the buffers */
+        ESP_RETURN_ON_FALSE(priv_cfg == NULL && LVGL_PORT_HANDLE_FLUSH_READY, NULL, TAG, "Shared draw buffers can be used only with panel IO displays!");
+        ESP_RETURN_ON_FALSE(!disp_cfg->flags.direct_mode, NULL, TAG, "Shared draw buffers can't be used in direct mode!");
+        ESP_RETURN_ON_FALSE(!disp_cfg->ring_buffers && !disp_cfg->buff_tune.enable, NULL, TAG, "Shared draw buffers can't be used with flush ring or draw buffer tuning!");
+    }
+
     /* Display context */
     lvgl_port_display_ctx_t *disp_ctx = malloc(sizeof(lvgl_port_display_ctx_t));
     ESP_GOTO_ON_FALSE(disp_ctx, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for display context allocation!");
@@ -271,8 +654,23 @@ static lv_display_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp
     disp_ctx->rotation.swap_xy = disp_cfg->rotation.swap_xy;
     disp_ctx->rotation.mirror_x = disp_cfg->rotation.mirror_x;
     disp_ctx->rotation.mirror_y = disp_cfg->rotation.mirror_y;
+    disp_ctx->output = disp_cfg->output;
     disp_ctx->flags.swap_bytes = disp_cfg->flags.swap_bytes;
     disp_ctx->flags.sw_rotate = disp_cfg->flags.sw_rotate;
+    disp_ctx->flags.diff_flush = disp_cfg->flags.diff_flush;
+    disp_ctx->flags.te_sync = disp_cfg->te.sync;
+    disp_ctx->flags.buff_tune = disp_cfg->buff_tune.enable;
+    disp_ctx->flags.chain_bands = disp_cfg->flags.chain_bands;
+    disp_ctx->flags.buff_pool = disp_cfg->flags.shared_buffers;
+    disp_ctx->flags.visible = (disp_cfg->visible.width > 0);
+    disp_ctx->visible.cfg = disp_cfg->visible;
+    disp_ctx->visible.hres = disp_cfg->hres;
+    disp_ctx->visible.vres = disp_cfg->vres;
+    disp_ctx->flags.rounder = (disp_cfg->rounder.x_align > 1 || disp_cfg->rounder.y_align > 1 || disp_cfg->rounder.min_width);
+    disp_ctx->rounder.cfg = disp_cfg->rounder;
+    disp_ctx->rounder.hres = disp_cfg->hres;
+    disp_ctx->rounder.vres = disp_cfg->vres;
+    disp_ctx->poll.max_bytes = disp_cfg->poll_max_bytes;
     disp_ctx->current_rotation = LV_DISPLAY_ROTATION_0;
 
     uint32_t buff_caps = 0;
@@ -305,17 +703,44 @@ static lv_display_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp
         ESP_GOTO_ON_FALSE(trans_sem, ESP_ERR_NO_MEM, err, TAG, "Failed to create transport counting Semaphore");
         disp_ctx->trans_sem = trans_sem;
     } else {
-        /* alloc draw buffers used by LVGL */
-        /* it's recommended to choose the size of the draw buffer(s) to be at least 1/10 screen sized */
-        buf1 = heap_caps_malloc(buffer_size * sizeof(lv_color_t), buff_caps);
-        ESP_GOTO_ON_FALSE(buf1, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (buf1) allocation!");
-        if (disp_cfg->double_buffer) {
-            buf2 = heap_caps_malloc(buffer_size * sizeof(lv_color_t), buff_caps);
-            ESP_GOTO_ON_FALSE(buf2, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (buf2) allocation!");
+        /* Draw buffer tuning starts from the configured size, which fits into the RAM ceiling and the free heap */
+        if (disp_cfg->buff_tune.enable) {
+            buff_bytes = lvgl_port_buff_tune_start(disp_ctx, disp_cfg, display_color_format, buff_caps);
         }
 
-        disp_ctx->draw_buffs[0] = buf1;
-        disp_ctx->draw_buffs[1] = buf2;
+        if (disp_ctx->flags.buff_pool) {
+            /* Buffers of the pool are owned by the pool, the display gets them for each refresh */
+            const uint8_t count = (disp_cfg->double_buffer ? 2 : 1);
+            ESP_GOTO_ON_FALSE(lvgl_port_buff_pool.users == 0 || lvgl_port_buff_pool.caps == buff_caps, ESP_ERR_INVALID_ARG, err, TAG, "Displays with shared draw buffers must use the same buffer capabilities!");
+            /* Bigger buffers of this display free the buffers, which the displays added before have set in LVGL, they set the new ones at their next refresh */
+            ESP_GOTO_ON_FALSE(lvgl_port_buff_pool_add(&lvgl_port_buff_pool, &disp_ctx->pool.user, buff_bytes, count, buff_caps), ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (shared buffer) allocation!");
+            buf1 = lvgl_port_buff_pool.buffs[0];
+            buf2 = (count > 1 ? lvgl_port_buff_pool.buffs[1] : NULL);
+        } else {
+            /* alloc draw buffers used by LVGL */
+            /* it's recommended to choose the size of the draw buffer(s) to be at least 1/10 screen sized */
+            buf1 = heap_caps_malloc(buff_bytes, buff_caps);
+            ESP_GOTO_ON_FALSE(buf1, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (buf1) allocation!");
+            if (disp_cfg->double_buffer || disp_cfg->ring_buffers) {
+                buf2 = heap_caps_malloc(buff_bytes, buff_caps);
+                ESP_GOTO_ON_FALSE(buf2, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (buf2) allocation!");
+            }
+
+            disp_ctx->draw_buffs[0] = buf1;
+            disp_ctx->draw_buffs[1] = buf2;
+        }
+
+        /* LVGL gets two of the ring buffers, the others are swapped in during flush */
+        if (disp_cfg->ring_buffers) {
+            disp_ctx->ring.count = disp_cfg->ring_buffers;
+            disp_ctx->ring.buff_size = buff_bytes;
+            disp_ctx->ring.buffs[0] = buf1;
+            disp_ctx->ring.buffs[1] = buf2;
+            for (int i = 2; i < disp_ctx->ring.count; i++) {
+                disp_ctx->ring.buffs[i] = heap_caps_malloc(disp_ctx->ring.buff_size, buff_caps);
+                ESP_GOTO_ON_FALSE(disp_ctx->ring.buffs[i], ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (ring buffer) allocation!");
+            }
+        }
     }
 
     disp = lv_display_create(disp_cfg->hres, disp_cfg->vres);
@@ -330,7 +755,7 @@ static lv_display_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp
 #endif
 
         /* Monochrome can be used only in RGB565 color format */
-        ESP_RETURN_ON_FALSE(display_color_format == LV_COLOR_FORMAT_RGB565 || display_color_format == LV_COLOR_FORMAT_I1, NULL, TAG, "Monochrome can be used only in display color format RGB565 or I1!");
+        ESP_GOTO_ON_FALSE(display_color_format == LV_COLOR_FORMAT_RGB565 || display_color_format == LV_COLOR_FORMAT_I1, ESP_ERR_INVALID_ARG, err, TAG, "Monochrome can be used only in display color format RGB565 or I1!");
 
         /* When using monochromatic display, there must be used full bufer! */
         ESP_GOTO_ON_FALSE((disp_cfg->hres * disp_cfg->vres == buffer_size), ESP_ERR_INVALID_ARG, err, TAG, "Monochromatic display must using full buffer!");
@@ -343,6 +768,12 @@ static lv_display_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp
             // To use LV_COLOR_FORMAT_I1, we need an extra buffer to hold the converted data
             disp_ctx->oled_buffer = heap_caps_malloc(buffer_size, buff_caps);
             ESP_GOTO_ON_FALSE(disp_ctx->oled_buffer, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (OLED buffer) allocation!");
+
+            /* Diff flush: copy of the sent pages, only changed spans of pages are sent */
+            if (disp_ctx->flags.diff_flush) {
+                disp_ctx->diff.oled_sent = heap_caps_malloc(buffer_size / 8, MALLOC_CAP_DEFAULT);
+                ESP_GOTO_ON_FALSE(disp_ctx->diff.oled_sent, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for diff flush pages allocation!");
+            }
         }
 
     } else if (disp_cfg->flags.direct_mode) {
@@ -350,7 +781,17 @@ static lv_display_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp
         ESP_GOTO_ON_FALSE((disp_cfg->hres * disp_cfg->vres == buffer_size), ESP_ERR_INVALID_ARG, err, TAG, "Direct mode must using full buffer!");
 
         disp_ctx->flags.direct_mode = 1;
-        lv_display_set_buffers(disp, buf1, buf2, buffer_size * sizeof(lv_color_t), LV_DISPLAY_RENDER_MODE_DIRECT);
+        if (priv_cfg && priv_cfg->avoid_tearing && buf2 && !disp_cfg->flags.sw_rotate) {
+            /* LVGL gets one frame buffer, the port swaps them and copies only the areas of the last frame */
+            disp_ctx->flags.fb_sync = 1;
+            disp_ctx->sync.fbs[0] = buf1;
+            disp_ctx->sync.fbs[1] = buf2;
+            disp_ctx->sync.size = buffer_size * sizeof(lv_color_t);
+            lvgl_port_sync_reset(&disp_ctx->sync.areas);
+            lv_display_set_buffers(disp, buf1, NULL, disp_ctx->sync.size, LV_DISPLAY_RENDER_MODE_DIRECT);
+        } else {
+            lv_display_set_buffers(disp, buf1, buf2, buffer_size * sizeof(lv_color_t), LV_DISPLAY_RENDER_MODE_DIRECT);
+        }
     } else if (disp_cfg->flags.full_refresh) {
         /* When using full_refresh, there must be used full bufer! */
         ESP_GOTO_ON_FALSE((disp_cfg->hres * disp_cfg->vres == buffer_size), ESP_ERR_INVALID_ARG, err, TAG, "Full refresh must using full buffer!");
@@ -358,7 +799,30 @@ static lv_display_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp
         disp_ctx->flags.full_refresh = 1;
         lv_display_set_buffers(disp, buf1, buf2, buffer_size * sizeof(lv_color_t), LV_DISPLAY_RENDER_MODE_FULL);
     } else {
-        lv_display_set_buffers(disp, buf1, buf2, buffer_size * sizeof(lv_color_t), LV_DISPLAY_RENDER_MODE_PARTIAL);
+        lv_display_set_buffers(disp, buf1, buf2, buff_bytes, LV_DISPLAY_RENDER_MODE_PARTIAL);
+
+        /* Visible window: invalidated areas are clipped first, the other callbacks get the clipped area */
+        if (disp_ctx->flags.visible) {
+            lv_display_add_event_cb(disp, lvgl_port_disp_visible_callback, LV_EVENT_INVALIDATE_AREA, disp_ctx);
+        }
+
+        /* Rounder: areas are extended to the alignment of the panel, LVGL rounds the height of the bands by it too */
+        if (disp_ctx->flags.rounder) {
+            lv_display_add_event_cb(disp, lvgl_port_disp_rounder_callback, LV_EVENT_INVALIDATE_AREA, disp_ctx);
+        }
+
+        /* Diff flush: hashes of the panel content for any rotation, invalidated areas are rounded to hashed segments */
+        if (disp_ctx->flags.diff_flush) {
+            disp_ctx->diff.shadow.hashes = heap_caps_malloc(lvgl_port_diff_get_hashes_count(disp_cfg->hres, disp_cfg->vres) * sizeof(uint32_t), MALLOC_CAP_DEFAULT);
+            ESP_GOTO_ON_FALSE(disp_ctx->diff.shadow.hashes, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for diff flush hashes allocation!");
+            lvgl_port_diff_reset(&disp_ctx->diff.shadow, disp_cfg->hres, disp_cfg->vres);
+            lv_display_add_event_cb(disp, lvgl_port_disp_diff_round_callback, LV_EVENT_INVALIDATE_AREA, disp_ctx);
+        }
+
+        /* Merging of invalidated areas (enabled by lvgl_port_disp_set_area_cost) */
+        disp_ctx->merge.buff_bytes = buff_bytes;
+        lv_display_add_event_cb(disp, lvgl_port_disp_area_merge_callback, LV_EVENT_INVALIDATE_AREA, disp_ctx);
+        lv_display_add_event_cb(disp, lvgl_port_disp_area_merge_callback, LV_EVENT_REFR_READY, disp_ctx);
     }
 
     lv_display_set_flush_cb(disp, lvgl_port_flush_callback);
@@ -369,28 +833,107 @@ static lv_display_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp
     lv_display_set_user_data(disp, disp_ctx);
     disp_ctx->disp_drv = disp;
 
+    /* Flush statistics */
+    disp_ctx->stats.reset_time = esp_timer_get_time();
+#if LV_VERSION_CHECK(9, 2, 0)
+    if (disp_ctx->ring.count == 0) {
+        lv_display_add_event_cb(disp, lvgl_port_disp_flush_wait_callback, LV_EVENT_FLUSH_WAIT_START, disp_ctx);
+        lv_display_add_event_cb(disp, lvgl_port_disp_flush_wait_callback, LV_EVENT_FLUSH_WAIT_FINISH, disp_ctx);
+    }
+#endif
+
+    /* RGB444 output: panel was initialized for 16 bits per pixel */
+    if (disp_ctx->output.rgb444) {
+        const uint8_t colmod = LVGL_PORT_COLMOD_RGB444;
+        ESP_GOTO_ON_ERROR(esp_lcd_panel_io_tx_param(disp_ctx->io_handle, lvgl_port_panel_cmd(disp_ctx, LCD_CMD_COLMOD, false), &colmod, 1), err, TAG, "Set RGB444 color mode failed");
+    }
+
+    /* Draw buffer tuning: band times are measured from the start of the frame, buffers are resized at its end */
+    if (disp_ctx->flags.buff_tune) {
+        disp_ctx->tune.done_sem = xSemaphoreCreateBinary();
+        ESP_GOTO_ON_FALSE(disp_ctx->tune.done_sem, ESP_ERR_NO_MEM, err, TAG, "Failed to create draw buffer tuning semaphore");
+        lv_display_add_event_cb(disp, lvgl_port_disp_buff_tune_callback, LV_EVENT_REFR_START, disp_ctx);
+        lv_display_add_event_cb(disp, lvgl_port_disp_buff_tune_callback, LV_EVENT_REFR_READY, disp_ctx);
+    }
+
+    /* Shared draw buffers: the display takes the buffers at the start of each refresh */
+    if (disp_ctx->flags.buff_pool) {
+        disp_ctx->pool.render_mode = (disp_ctx->flags.monochrome || disp_ctx->flags.full_refresh ? LV_DISPLAY_RENDER_MODE_FULL : LV_DISPLAY_RENDER_MODE_PARTIAL);
+        lv_display_add_event_cb(disp, lvgl_port_disp_buff_pool_callback, LV_EVENT_REFR_START, disp_ctx);
+    }
+
+    /* Frame buffer sync: the areas are copied in the background, LVGL waits for them at the start of the next refresh */
+    if (disp_ctx->flags.fb_sync) {
+        disp_ctx->sync.copy = lvgl_port_copy_new(LVGL_PORT_SYNC_COPY_BACKLOG);
+        ESP_GOTO_ON_FALSE(disp_ctx->sync.copy, ESP_ERR_NO_MEM, err, TAG, "Failed to create frame buffer sync copy");
+        lv_display_add_event_cb(disp, lvgl_port_disp_fb_sync_callback, LV_EVENT_REFR_START, disp_ctx);
+    }
+
+    /* TE synchronization, before the flush ring task can send anything */
+    if (disp_cfg->te.sync) {
+        ESP_GOTO_ON_ERROR(lvgl_port_te_init(disp_ctx, disp_cfg->te.gpio_num), err, TAG, "TE synchronization init failed");
+    }
+
+    /* Flush ring */
+    if (disp_ctx->ring.count) {
+        ESP_GOTO_ON_ERROR(lvgl_port_ring_init(disp_ctx), err, TAG, "Flush ring init failed");
+    }
+
     /* Use SW rotation */
     if (disp_cfg->flags.sw_rotate) {
         disp_ctx->draw_buffs[2] = heap_caps_malloc(buffer_size * sizeof(lv_color_t), buff_caps);
         ESP_GOTO_ON_FALSE(disp_ctx->draw_buffs[2], ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (rotation buffer) allocation!");
+
+        /* Buffers in PSRAM are rotated through a tile in internal RAM, so they are accessed only by whole cache lines */
+        if ((buf1 && esp_ptr_external_ram(buf1)) || esp_ptr_external_ram(disp_ctx->draw_buffs[2])) {
+            disp_ctx->rotate_tile = heap_caps_malloc(LVGL_PORT_ROTATE_TILE_BYTES, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            ESP_GOTO_ON_FALSE(disp_ctx->rotate_tile, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for rotation tile allocation!");
+        }
     }
 
 
 err:
     if (ret != ESP_OK) {
-        if (disp_ctx->draw_buffs[0]) {
-            free(disp_ctx->draw_buffs[0]);
-        }
-        if (disp_ctx->draw_buffs[1]) {
-            free(disp_ctx->draw_buffs[1]);
-        }
-        if (disp_ctx->draw_buffs[2]) {
-            free(disp_ctx->draw_buffs[2]);
-        }
-        if (disp_ctx->oled_buffer) {
-            free(disp_ctx->oled_buffer);
+        /* The callbacks of the display use its context */
+        if (disp) {
+            lv_display_delete(disp);
+            disp = NULL;
         }
         if (disp_ctx) {
+            if (disp_ctx->draw_buffs[0]) {
+                free(disp_ctx->draw_buffs[0]);
+            }
+            if (disp_ctx->draw_buffs[1]) {
+                free(disp_ctx->draw_buffs[1]);
+            }
+            if (disp_ctx->draw_buffs[2]) {
+                free(disp_ctx->draw_buffs[2]);
+            }
+            if (disp_ctx->rotate_tile) {
+                free(disp_ctx->rotate_tile);
+            }
+            for (int i = 2; i < LVGL_PORT_RING_BUFFS_MAX; i++) {
+                if (disp_ctx->ring.buffs[i]) {
+                    free(disp_ctx->ring.buffs[i]);
+                }
+            }
+            if (disp_ctx->oled_buffer) {
+                free(disp_ctx->oled_buffer);
+            }
+            if (disp_ctx->diff.shadow.hashes) {
+                free(disp_ctx->diff.shadow.hashes);
+            }
+            if (disp_ctx->diff.oled_sent) {
+                free(disp_ctx->diff.oled_sent);
+            }
+            lvgl_port_te_deinit(disp_ctx);
+            if (disp_ctx->tune.done_sem) {
+                vSemaphoreDelete(disp_ctx->tune.done_sem);
+            }
+            if (disp_ctx->flags.buff_pool && disp_ctx->pool.user.count) {
+                lvgl_port_buff_pool_remove(&lvgl_port_buff_pool, &disp_ctx->pool.user);
+            }
+            lvgl_port_copy_del(disp_ctx->sync.copy);
             free(disp_ctx);
         }
         if (trans_sem) {
@@ -406,6 +949,59 @@ static bool lvgl_port_flush_io_ready_callback(esp_lcd_panel_io_handle_t panel_io
 {
     lv_display_t *disp_drv = (lv_display_t *)user_ctx;
     assert(disp_drv != NULL);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp_drv);
+
+    /* Polled transfers: time of the queued transfer, which didn't wait for other ones */
+    if (disp_ctx && disp_ctx->poll.max_bytes && ++disp_ctx->poll.done == disp_ctx->poll.measured) {
+        disp_ctx->stats.counters.queued_measured++;
+        disp_ctx->stats.counters.queued_us += esp_timer_get_time() - disp_ctx->poll.start;
+        disp_ctx->poll.measured = 0;
+    }
+
+    return lvgl_port_flush_done(disp_drv);
+}
+
+/* Transfer of a band is done: called from the IO callback, or from the flushing task after a polled transfer */
+static bool lvgl_port_flush_done(lv_display_t *disp_drv)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp_drv);
+
+    /* TE synchronization: time of the measured band transfer */
+    if (disp_ctx && disp_ctx->flags.te_sync && disp_ctx->te.trans_bytes) {
+        const uint32_t ns_per_byte = (uint32_t)((esp_timer_get_time() - disp_ctx->te.trans_start) * 1000 / disp_ctx->te.trans_bytes);
+        disp_ctx->te.ns_per_byte = (disp_ctx->te.ns_per_byte ? (disp_ctx->te.ns_per_byte * 3 + ns_per_byte) / 4 : ns_per_byte);
+        disp_ctx->te.trans_bytes = 0;
+    }
+
+    /* Draw buffer tuning: flush time of the band, the buffers can be resized after the last band */
+    if (disp_ctx && disp_ctx->flags.buff_tune && disp_ctx->tune.in_flight) {
+        BaseType_t need_yield = pdFALSE;
+        disp_ctx->tune.flush_end = esp_timer_get_time();
+        disp_ctx->tune.in_flight = false;
+        xSemaphoreGiveFromISR(disp_ctx->tune.done_sem, &need_yield);
+        lv_disp_flush_ready(disp_drv);
+        return (need_yield == pdTRUE);
+    }
+
+    /* Flush ring: transfers are finished in order, so the oldest buffer in flight is free now */
+    if (disp_ctx && disp_ctx->ring.count) {
+        BaseType_t need_yield = pdFALSE;
+        xSemaphoreGiveFromISR(disp_ctx->ring.free_sem, &need_yield);
+        return (need_yield == pdTRUE);
+    }
+
+    /* Diff flush: the flushed area is done with its last window */
+    if (disp_ctx && disp_ctx->flags.diff_flush && --disp_ctx->diff.pending > 0) {
+        return false;
+    }
+
+    /* Shared draw buffers: another display can render into them now */
+    if (disp_ctx && disp_ctx->flags.buff_pool && disp_ctx->pool.user.in_flight) {
+        const bool need_yield = lvgl_port_buff_pool_done(&disp_ctx->pool.user);
+        lv_disp_flush_ready(disp_drv);
+        return need_yield;
+    }
+
     lv_disp_flush_ready(disp_drv);
     return false;
 }
@@ -479,17 +1075,16 @@ static void _lvgl_port_transform_monochrome(lv_display_t *display, const lv_area
         src += 8;
         /*Use oled_buffer as output */
         *color_map = disp_ctx->oled_buffer;
+
+        /* 8x8 blocks are transposed to pages with word operations */
+        lvgl_port_i1_to_pages(src, hor_res >> 3, *color_map, swap_xy ? ver_res : hor_res, x1, y1, x2, y2, swap_xy);
+        return;
     }
 
     int out_x, out_y;
     for (int y = y1; y <= y2; y++) {
         for (int x = x1; x <= x2; x++) {
-            bool chroma_color = 0;
-            if (color_format == LV_COLOR_FORMAT_I1) {
-                chroma_color = (src[(hor_res >> 3) * y  + (x >> 3)] & 1 << (7 - x % 8));
-            } else {
-                chroma_color = (color[hor_res * y + x].blue > 16);
-            }
+            bool chroma_color = (color[hor_res * y + x].blue > 16);
 
             if (swap_xy) {
                 out_x = y;
@@ -566,6 +1161,34 @@ static void lvgl_port_flush_callback(lv_display_t *drv, const lv_area_t *area, u
     int offsety1 = area->y1;
     int offsety2 = area->y2;
 
+    disp_ctx->stats.counters.flushes++;
+    if (lv_display_flush_is_last(drv)) {
+        disp_ctx->stats.counters.frames++;
+    }
+
+    /* Visible window: area without visible pixels (it was invalidated as one hidden pixel) is not sent */
+    if (disp_ctx->flags.visible) {
+        int32_t x1 = area->x1;
+        int32_t y1 = area->y1;
+        int32_t x2 = area->x2;
+        int32_t y2 = area->y2;
+        if (!lvgl_port_visible_clip(&disp_ctx->visible.window, &x1, &y1, &x2, &y2)) {
+            disp_ctx->stats.counters.visible_skipped_px += lv_area_get_size(area);
+            lv_display_flush_ready(drv);
+            return;
+        }
+    }
+    disp_ctx->stats.counters.flushed_px += lv_area_get_size(area);
+
+    if (disp_ctx->flags.buff_tune) {
+        lvgl_port_buff_tune_band(disp_ctx, area);
+    }
+
+    /* Shared draw buffers: the band is in flight until the IO callback */
+    if (disp_ctx->flags.buff_pool) {
+        lvgl_port_buff_pool_send(&disp_ctx->pool.user);
+    }
+
     /* SW rotation enabled */
     if (disp_ctx->flags.sw_rotate && (disp_ctx->current_rotation > LV_DISPLAY_ROTATION_0 || disp_ctx->flags.swap_bytes)) {
         /* SW rotation */
@@ -575,7 +1198,13 @@ static void lvgl_port_flush_callback(lv_display_t *drv, const lv_area_t *area, u
             lv_color_format_t cf = lv_display_get_color_format(drv);
             uint32_t w_stride = lv_draw_buf_width_to_stride(ww, cf);
             uint32_t h_stride = lv_draw_buf_width_to_stride(hh, cf);
-            if (disp_ctx->current_rotation == LV_DISPLAY_ROTATION_180) {
+            uint32_t px_size = lv_color_format_get_size(cf);
+            if (px_size >= 2 && px_size <= 4) {
+                /* Rotate (and swap bytes of RGB565) in one pass over the flushed area, in tiles */
+                uint32_t dst_stride = (disp_ctx->current_rotation == LV_DISPLAY_ROTATION_90 || disp_ctx->current_rotation == LV_DISPLAY_ROTATION_270) ? h_stride : w_stride;
+                lvgl_port_rotate(color_map, disp_ctx->draw_buffs[2], ww, hh, w_stride, dst_stride, px_size,
+                                 (lvgl_port_color_rotation_t)disp_ctx->current_rotation, disp_ctx->flags.swap_bytes, disp_ctx->rotate_tile);
+            } else if (disp_ctx->current_rotation == LV_DISPLAY_ROTATION_180) {
                 lv_draw_sw_rotate(color_map, disp_ctx->draw_buffs[2], hh, ww, h_stride, h_stride, LV_DISPLAY_ROTATION_180, cf);
             } else if (disp_ctx->current_rotation == LV_DISPLAY_ROTATION_90) {
                 lv_draw_sw_rotate(color_map, disp_ctx->draw_buffs[2], ww, hh, w_stride, h_stride, LV_DISPLAY_ROTATION_90, cf);
@@ -591,7 +1220,7 @@ static void lvgl_port_flush_callback(lv_display_t *drv, const lv_area_t *area, u
         }
     } else if (disp_ctx->flags.swap_bytes) {
         size_t len = lv_area_get_size(area);
-        lv_draw_sw_rgb565_swap(color_map, len);
+        lvgl_port_rgb565_swap(color_map, len);
     }
 
     /* Transfer data in buffer for monochromatic screen */
@@ -600,20 +1229,40 @@ static void lvgl_port_flush_callback(lv_display_t *drv, const lv_area_t *area, u
     }
 
     if ((disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_RGB || disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_DSI) && (disp_ctx->flags.direct_mode || disp_ctx->flags.full_refresh)) {
+        if (disp_ctx->flags.fb_sync) {
+            lvgl_port_sync_add_area(&disp_ctx->sync.areas, offsetx1, offsety1, offsetx2, offsety2);
+        }
         if (lv_disp_flush_is_last(drv)) {
             /* If the interface is I80 or SPI, this step cannot be used for drawing. */
             esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, 0, 0, lv_disp_get_hor_res(drv), lv_disp_get_ver_res(drv), color_map);
             /* Waiting for the last frame buffer to complete transmission */
             xSemaphoreTake(disp_ctx->trans_sem, 0);
             xSemaphoreTake(disp_ctx->trans_sem, portMAX_DELAY);
+            /* The other frame buffer is not shown anymore, it gets the areas of this frame and LVGL draws into it */
+            if (disp_ctx->flags.fb_sync) {
+                lvgl_port_fb_sync(disp_ctx);
+            }
         }
+    } else if (disp_ctx->ring.count) {
+        /* Queue the flush and continue rendering into the next free buffer */
+        lvgl_port_ring_flush(disp_ctx, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1, color_map);
+    } else if (disp_ctx->flags.diff_flush && disp_ctx->flags.monochrome) {
+        lvgl_port_diff_pages_flush(disp_ctx, color_map);
+    } else if (disp_ctx->flags.diff_flush) {
+        lvgl_port_diff_flush(disp_ctx, offsetx1, offsety1, offsetx2, offsety2, color_map);
     } else {
-        esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1, color_map);
+        lvgl_port_panel_draw(disp_ctx, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1, color_map);
     }
 
     if (disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_RGB || (disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_DSI && (disp_ctx->flags.direct_mode || disp_ctx->flags.full_refresh))) {
         lv_disp_flush_ready(drv);
     }
+
+    /* LVGL renders the next band after this callback (into the other buffer, or after the flush is ready) */
+    if (disp_ctx->flags.buff_tune) {
+        disp_ctx->tune.render_start = esp_timer_get_time();
+        disp_ctx->tune.wait_us = 0;
+    }
 }
 
 static void lvgl_port_disp_rotation_update(lvgl_port_display_ctx_t *disp_ctx)
@@ -621,43 +1270,58 @@ static void lvgl_port_disp_rotation_update(lvgl_port_display_ctx_t *disp_ctx)
     assert(disp_ctx != NULL);
 
     disp_ctx->current_rotation = lv_display_get_rotation(disp_ctx->disp_drv);
+    if (disp_ctx->flags.visible) {
+        lvgl_port_disp_visible_update(disp_ctx);
+    }
+    if (disp_ctx->flags.rounder) {
+        const bool swap_xy = (disp_ctx->current_rotation == LV_DISPLAY_ROTATION_90 || disp_ctx->current_rotation == LV_DISPLAY_ROTATION_270);
+        lvgl_port_rounder_init(&disp_ctx->rounder.area, disp_ctx->rounder.hres, disp_ctx->rounder.vres, disp_ctx->rounder.cfg.x_align,
+                               disp_ctx->rounder.cfg.y_align, disp_ctx->rounder.cfg.min_width, swap_xy);
+    }
     if (disp_ctx->flags.sw_rotate) {
         return;
     }
 
     esp_lcd_panel_handle_t control_handle = (disp_ctx->control_handle ? disp_ctx->control_handle : disp_ctx->panel_handle);
+    bool swap_xy = disp_ctx->rotation.swap_xy;
+    bool mirror_x = disp_ctx->rotation.mirror_x;
+    bool mirror_y = disp_ctx->rotation.mirror_y;
     /* Solve rotation screen and touch */
     switch (lv_display_get_rotation(disp_ctx->disp_drv)) {
     case LV_DISPLAY_ROTATION_0:
-        /* Rotate LCD display */
-        esp_lcd_panel_swap_xy(control_handle, disp_ctx->rotation.swap_xy);
-        esp_lcd_panel_mirror(control_handle, disp_ctx->rotation.mirror_x, disp_ctx->rotation.mirror_y);
         break;
     case LV_DISPLAY_ROTATION_90:
-        /* Rotate LCD display */
-        esp_lcd_panel_swap_xy(control_handle, !disp_ctx->rotation.swap_xy);
+        swap_xy = !disp_ctx->rotation.swap_xy;
         if (disp_ctx->rotation.swap_xy) {
-            esp_lcd_panel_mirror(control_handle, !disp_ctx->rotation.mirror_x, disp_ctx->rotation.mirror_y);
+            mirror_x = !disp_ctx->rotation.mirror_x;
         } else {
-            esp_lcd_panel_mirror(control_handle, disp_ctx->rotation.mirror_x, !disp_ctx->rotation.mirror_y);
+            mirror_y = !disp_ctx->rotation.mirror_y;
         }
         break;
     case LV_DISPLAY_ROTATION_180:
-        /* Rotate LCD display */
-        esp_lcd_panel_swap_xy(control_handle, disp_ctx->rotation.swap_xy);
-        esp_lcd_panel_mirror(control_handle, !disp_ctx->rotation.mirror_x, !disp_ctx->rotation.mirror_y);
+        mirror_x = !disp_ctx->rotation.mirror_x;
+        mirror_y = !disp_ctx->rotation.mirror_y;
         break;
     case LV_DISPLAY_ROTATION_270:
-        /* Rotate LCD display */
-        esp_lcd_panel_swap_xy(control_handle, !disp_ctx->rotation.swap_xy);
+        swap_xy = !disp_ctx->rotation.swap_xy;
         if (disp_ctx->rotation.swap_xy) {
-            esp_lcd_panel_mirror(control_handle, disp_ctx->rotation.mirror_x, !disp_ctx->rotation.mirror_y);
+            mirror_y = !disp_ctx->rotation.mirror_y;
         } else {
-            esp_lcd_panel_mirror(control_handle, !disp_ctx->rotation.mirror_x, disp_ctx->rotation.mirror_y);
+            mirror_x = !disp_ctx->rotation.mirror_x;
         }
         break;
     }
 
+    /* Rotate LCD display */
+    esp_lcd_panel_swap_xy(control_handle, swap_xy);
+    esp_lcd_panel_mirror(control_handle, mirror_x, mirror_y);
+
+    /* With swapped XY, the columns of the area are the rows of the panel memory */
+    disp_ctx->te.swap_xy = swap_xy;
+    disp_ctx->te.mirror_rows = (swap_xy ? mirror_x : mirror_y);
+    /* Panel orientation changed, the next band opens a new window */
+    lvgl_port_chain_reset(&disp_ctx->chain);
+
     /* Wake LVGL task, if needed */
     lvgl_port_task_wake(LVGL_PORT_EVENT_DISPLAY, disp_ctx->disp_drv);
 }
@@ -667,6 +1331,13 @@ static void lvgl_port_disp_size_update_callback(lv_event_t *e)
     assert(e);
     lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_event_get_user_data(e);
     lvgl_port_disp_rotation_update(disp_ctx);
+
+    /* Panel is redrawn in the new orientation */
+    if (disp_ctx->flags.diff_flush && disp_ctx->flags.monochrome) {
+        disp_ctx->diff.oled_sent_valid = false;
+    } else if (disp_ctx->flags.diff_flush) {
+        lvgl_port_diff_reset(&disp_ctx->diff.shadow, lv_display_get_horizontal_resolution(disp_ctx->disp_drv), lv_display_get_vertical_resolution(disp_ctx->disp_drv));
+    }
 }
 
 static void lvgl_port_display_invalidate_callback(lv_event_t *e)
@@ -674,3 +1345,734 @@ static void lvgl_port_display_invalidate_callback(lv_event_t *e)
     /* Wake LVGL task, if needed */
     lvgl_port_task_wake(LVGL_PORT_EVENT_DISPLAY, NULL);
 }
+
+#if LV_VERSION_CHECK(9, 2, 0)
+static void lvgl_port_disp_flush_wait_callback(lv_event_t *e)
+{
+    assert(e);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_event_get_user_data(e);
+    assert(disp_ctx != NULL);
+
+    if (lv_event_get_code(e) == LV_EVENT_FLUSH_WAIT_START) {
+        disp_ctx->stats.wait_start = esp_timer_get_time();
+    } else {
+        int64_t wait_us = esp_timer_get_time() - disp_ctx->stats.wait_start;
+        if (wait_us >= LVGL_PORT_STALL_MIN_US) {
+            disp_ctx->stats.counters.stalls++;
+            disp_ctx->stats.counters.stall_us += wait_us;
+        }
+        disp_ctx->tune.wait_us += wait_us;
+    }
+}
+#endif
+
+static void lvgl_port_ring_task(void *arg)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)arg;
+    lvgl_port_ring_item_t item;
+
+    while (xQueueReceive(disp_ctx->ring.queue, &item, portMAX_DELAY) == pdTRUE) {
+        if (item.color_map == NULL) {
+            break;
+        }
+        /* It blocks, until the previous transfer is done (panel IO sends commands after queued color transfers), chained bands are only queued */
+        lvgl_port_panel_draw(disp_ctx, item.x_start, item.y_start, item.x_end, item.y_end, (void *)item.color_map);
+    }
+
+    if (item.notify) {
+        xTaskNotifyGive(item.notify);
+    }
+    vTaskDelete(NULL);
+}
+
+static esp_err_t lvgl_port_ring_init(lvgl_port_display_ctx_t *disp_ctx)
+{
+    esp_err_t ret = ESP_OK;
+    assert(disp_ctx != NULL);
+
+    /* One buffer is always rendered, the others can be queued or in flight */
+    disp_ctx->ring.queue = xQueueCreate(disp_ctx->ring.count, sizeof(lvgl_port_ring_item_t));
+    ESP_GOTO_ON_FALSE(disp_ctx->ring.queue, ESP_ERR_NO_MEM, err, TAG, "Failed to create flush ring queue");
+    disp_ctx->ring.free_sem = xSemaphoreCreateCounting(disp_ctx->ring.count - 1, disp_ctx->ring.count - 1);
+    ESP_GOTO_ON_FALSE(disp_ctx->ring.free_sem, ESP_ERR_NO_MEM, err, TAG, "Failed to create flush ring semaphore");
+
+    /* Higher priority than LVGL task, so the queued flush is sent right after LVGL task releases CPU */
+    BaseType_t res = xTaskCreate(lvgl_port_ring_task, "taskLVGLFlush", LVGL_PORT_RING_TASK_STACK, disp_ctx, lvgl_port_get_task_priority() + 1, &disp_ctx->ring.task);
+    ESP_GOTO_ON_FALSE(res == pdPASS, ESP_FAIL, err, TAG, "Failed to create flush ring task");
+
+    disp_ctx->ring.render = 0;
+    return ESP_OK;
+
+err:
+    if (disp_ctx->ring.free_sem) {
+        vSemaphoreDelete(disp_ctx->ring.free_sem);
+        disp_ctx->ring.free_sem = NULL;
+    }
+    if (disp_ctx->ring.queue) {
+        vQueueDelete(disp_ctx->ring.queue);
+        disp_ctx->ring.queue = NULL;
+    }
+    return ret;
+}
+
+static void lvgl_port_ring_deinit(lvgl_port_display_ctx_t *disp_ctx)
+{
+    assert(disp_ctx != NULL);
+    if (disp_ctx->ring.task == NULL) {
+        return;
+    }
+
+    /* Stop the flush task after the queued flushes */
+    const lvgl_port_ring_item_t stop = {
+        .color_map = NULL,
+        .notify = xTaskGetCurrentTaskHandle(),
+    };
+    xQueueSend(disp_ctx->ring.queue, &stop, portMAX_DELAY);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    disp_ctx->ring.task = NULL;
+
+    /* Wait for the transfers in flight */
+    for (int i = 0; i < disp_ctx->ring.count - 1; i++) {
+        if (xSemaphoreTake(disp_ctx->ring.free_sem, pdMS_TO_TICKS(1000)) != pdTRUE) {
+            ESP_LOGW(TAG, "Flush ring transfer was not finished");
+            break;
+        }
+    }
+
+    vSemaphoreDelete(disp_ctx->ring.free_sem);
+    disp_ctx->ring.free_sem = NULL;
+    vQueueDelete(disp_ctx->ring.queue);
+    disp_ctx->ring.queue = NULL;
+}
+
+static void lvgl_port_ring_flush(lvgl_port_display_ctx_t *disp_ctx, int x_start, int y_start, int x_end, int y_end, const void *color_map)
+{
+    assert(disp_ctx != NULL);
+
+    const lvgl_port_ring_item_t item = {
+        .x_start = x_start,
+        .y_start = y_start,
+        .x_end = x_end,
+        .y_end = y_end,
+        .color_map = color_map,
+    };
+    xQueueSend(disp_ctx->ring.queue, &item, portMAX_DELAY);
+
+    /* Rendering stalls only here, when all other buffers are in flight */
+    if (xSemaphoreTake(disp_ctx->ring.free_sem, 0) != pdTRUE) {
+        int64_t wait_start = esp_timer_get_time();
+        xSemaphoreTake(disp_ctx->ring.free_sem, portMAX_DELAY);
+        disp_ctx->stats.counters.stalls++;
+        disp_ctx->stats.counters.stall_us += esp_timer_get_time() - wait_start;
+    }
+
+    /*
+     * Buffers are used in ring order and transfers finish in order, so the next buffer is the free one.
+     * LVGL swaps buf1 and buf2 after this callback: flushed buffer goes to buf1, next buffer to buf2.
+     */
+    lv_color_t *flushed = disp_ctx->ring.buffs[disp_ctx->ring.render];
+    disp_ctx->ring.render = (disp_ctx->ring.render + 1) % disp_ctx->ring.count;
+    lv_display_set_buffers(disp_ctx->disp_drv, flushed, disp_ctx->ring.buffs[disp_ctx->ring.render], disp_ctx->ring.buff_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_flush_ready(disp_ctx->disp_drv);
+}
+
+/*
+ * LVGL renders the display. Its invalidations in this time are mostly the probes of the band height (area from row 0,
+ * one column wide), which must be only rounded, not clipped or merged.
+ */
+static bool lvgl_port_disp_is_refreshing(lv_display_t *disp)
+{
+#if LV_VERSION_CHECK(9, 2, 0)
+    return (lv_refr_get_disp_refreshing() == disp);
+#else
+    return (_lv_refr_get_disp_refreshing() == disp);
+#endif
+}
+
+static void lvgl_port_disp_area_merge_callback(lv_event_t *e)
+{
+    assert(e);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_event_get_user_data(e);
+    assert(disp_ctx != NULL);
+
+    if (disp_ctx->merge.bytes_per_us == 0) {
+        return;
+    }
+
+    /* New frame */
+    if (lv_event_get_code(e) == LV_EVENT_REFR_READY) {
+        lvgl_port_merge_reset(&disp_ctx->merge);
+        return;
+    }
+
+    /* Probe of the band height is not an area of the next frame, it must not be merged or remembered */
+    if (lvgl_port_disp_is_refreshing(disp_ctx->disp_drv)) {
+        return;
+    }
+
+    /* The invalidated area can be modified in this event, LVGL drops or joins the areas inside of the grown one */
+    lv_area_t *area = (lv_area_t *)lv_event_get_param(e);
+    lvgl_port_merge_area_t merged = {
+        .x1 = area->x1,
+        .y1 = area->y1,
+        .x2 = area->x2,
+        .y2 = area->y2,
+    };
+    disp_ctx->merge.px_size = lv_color_format_get_size(lv_display_get_color_format(disp_ctx->disp_drv));
+    disp_ctx->stats.counters.merged_areas += lvgl_port_merge_area(&disp_ctx->merge, &merged, &disp_ctx->stats.counters.trans_saved);
+    area->x1 = merged.x1;
+    area->y1 = merged.y1;
+    area->x2 = merged.x2;
+    area->y2 = merged.y2;
+}
+
+static void lvgl_port_disp_diff_round_callback(lv_event_t *e)
+{
+    assert(e);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_event_get_user_data(e);
+    assert(disp_ctx != NULL);
+
+    /* Whole segments are rendered, so their hashes can be compared */
+    lv_area_t *area = (lv_area_t *)lv_event_get_param(e);
+    lvgl_port_diff_round_area(&disp_ctx->diff.shadow, &area->x1, &area->x2);
+}
+
+static void lvgl_port_diff_flush(lvgl_port_display_ctx_t *disp_ctx, int x1, int y1, int x2, int y2, uint8_t *color_map)
+{
+    const uint32_t px_size = lv_color_format_get_size(lv_display_get_color_format(disp_ctx->disp_drv));
+    const uint32_t count = lvgl_port_diff_area(&disp_ctx->diff.shadow, color_map, px_size, x1, y1, x2, y2,
+                           disp_ctx->diff.windows, LVGL_PORT_DIFF_WINDOWS_MAX);
+
+    uint32_t sent_px = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        sent_px += (disp_ctx->diff.windows[i].x2 - disp_ctx->diff.windows[i].x1 + 1) * (disp_ctx->diff.windows[i].y2 - disp_ctx->diff.windows[i].y1 + 1);
+    }
+    disp_ctx->stats.counters.diff_skipped_bytes += (uint64_t)((x2 - x1 + 1) * (y2 - y1 + 1) - sent_px) * px_size;
+
+    /* Nothing changed, the panel already shows this area */
+    if (count == 0) {
+        if (disp_ctx->flags.buff_pool) {
+            lvgl_port_buff_pool_done(&disp_ctx->pool.user);
+        }
+        lv_display_flush_ready(disp_ctx->disp_drv);
+        return;
+    }
+
+    /* All windows must be counted before the first one can finish */
+    disp_ctx->diff.pending = count;
+    for (uint32_t i = 0; i < count; i++) {
+        const lvgl_port_diff_window_t *win = &disp_ctx->diff.windows[i];
+        lvgl_port_panel_draw(disp_ctx, win->x1, win->y1, win->x2 + 1, win->y2 + 1, win->data);
+    }
+}
+
+static void lvgl_port_diff_pages_flush(lvgl_port_display_ctx_t *disp_ctx, uint8_t *pages)
+{
+    /* Same layout as the monochrome transform: pages of 8 rows, stride is the width in the panel orientation */
+    lv_display_t *disp = disp_ctx->disp_drv;
+    const bool swap_xy = (lv_display_get_rotation(disp) == LV_DISPLAY_ROTATION_90 || lv_display_get_rotation(disp) == LV_DISPLAY_ROTATION_270);
+    const uint32_t width = swap_xy ? lv_display_get_physical_vertical_resolution(disp) : lv_display_get_physical_horizontal_resolution(disp);
+    const uint32_t height = swap_xy ? lv_display_get_physical_horizontal_resolution(disp) : lv_display_get_physical_vertical_resolution(disp);
+    const uint32_t page_count = height / 8;
+    uint32_t count;
+
+    if (disp_ctx->diff.oled_sent_valid) {
+        count = lvgl_port_diff_pages(disp_ctx->diff.oled_sent, pages, width, page_count, disp_ctx->diff.windows, LVGL_PORT_DIFF_WINDOWS_MAX);
+    } else {
+        /* Panel content is not known, send all pages */
+        memcpy(disp_ctx->diff.oled_sent, pages, width * page_count);
+        disp_ctx->diff.oled_sent_valid = true;
+        disp_ctx->diff.windows[0] = (lvgl_port_diff_window_t) {
+            .x1 = 0, .y1 = 0, .x2 = width - 1, .y2 = height - 1, .data = pages,
+        };
+        count = 1;
+    }
+
+    uint32_t sent_bytes = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        sent_bytes += (disp_ctx->diff.windows[i].x2 - disp_ctx->diff.windows[i].x1 + 1) * (disp_ctx->diff.windows[i].y2 - disp_ctx->diff.windows[i].y1 + 1) / 8;
+    }
+    disp_ctx->stats.counters.diff_skipped_bytes += width * page_count - sent_bytes;
+
+    /* Nothing changed, the panel already shows these pages */
+    if (count == 0) {
+        if (disp_ctx->flags.buff_pool) {
+            lvgl_port_buff_pool_done(&disp_ctx->pool.user);
+        }
+        lv_display_flush_ready(disp);
+        return;
+    }
+
+    /* Panel driver sets column and page range of each span, it swaps the coordinates back in swap_xy */
+    disp_ctx->diff.pending = count;
+    for (uint32_t i = 0; i < count; i++) {
+        const lvgl_port_diff_window_t *span = &disp_ctx->diff.windows[i];
+        if (swap_xy) {
+            esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, span->y1, span->x1, span->y2 + 1, span->x2 + 1, span->data);
+        } else {
+            esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, span->x1, span->y1, span->x2 + 1, span->y2 + 1, span->data);
+        }
+    }
+}
+
+/* Command word of the panel IO for the MIPI DCS command, QSPI panels take the command in bits 8..15 and the write opcode in the top byte */
+static int lvgl_port_panel_cmd(const lvgl_port_display_ctx_t *disp_ctx, int dcs_cmd, bool color)
+{
+    if (disp_ctx->output.cmd_set == LVGL_PORT_PANEL_CMD_DCS_QSPI) {
+        return ((color ? LVGL_PORT_QSPI_OPCODE_COLOR : LVGL_PORT_QSPI_OPCODE_CMD) << 24) | (dcs_cmd << 8);
+    }
+    return dcs_cmd;
+}
+
+/* Send pixels of the band, small bands by polling: the queue and the done interrupt would take longer than their transfer */
+static void lvgl_port_panel_tx_color(lvgl_port_display_ctx_t *disp_ctx, int dcs_cmd, const void *color_map, size_t len, int64_t start)
+{
+    if (len > disp_ctx->poll.max_bytes) {
+        /* Time is measured on transfers, which don't wait for other ones in the queue */
+        if (disp_ctx->poll.max_bytes) {
+            if (disp_ctx->poll.measured == 0 && disp_ctx->poll.sent == disp_ctx->poll.done) {
+                disp_ctx->poll.start = start;
+                disp_ctx->poll.measured = disp_ctx->poll.sent + 1;
+            }
+            disp_ctx->poll.sent++;
+            disp_ctx->stats.counters.queued_trans++;
+        }
+        esp_lcd_panel_io_tx_color(disp_ctx->io_handle, lvgl_port_panel_cmd(disp_ctx, dcs_cmd, true), color_map, len);
+        return;
+    }
+
+    /* Panel IO sends parameters by polling (after the queued transfers), the pixels are the parameters of the write command */
+    esp_lcd_panel_io_tx_param(disp_ctx->io_handle, lvgl_port_panel_cmd(disp_ctx, dcs_cmd, false), color_map, len);
+    disp_ctx->stats.counters.poll_trans++;
+    disp_ctx->stats.counters.poll_us += esp_timer_get_time() - start;
+
+#if LVGL_PORT_HANDLE_FLUSH_READY
+    /* There is no IO callback, the band is done now (the FromISR calls are safe in the task too) */
+    lvgl_port_flush_done(disp_ctx->disp_drv);
+#endif
+}
+
+/* Draw to the panel, coordinates are the same as in esp_lcd_panel_draw_bitmap() (end is exclusive) */
+static void lvgl_port_panel_draw(lvgl_port_display_ctx_t *disp_ctx, int x_start, int y_start, int x_end, int y_end, void *color_map)
+{
+    if (!disp_ctx->output.rgb444 && !disp_ctx->flags.chain_bands && !disp_ctx->poll.max_bytes) {
+        if (disp_ctx->flags.te_sync) {
+            const size_t len = (size_t)(x_end - x_start) * (y_end - y_start) * lv_color_format_get_size(lv_display_get_color_format(disp_ctx->disp_drv));
+            lvgl_port_te_wait(disp_ctx, x_start, y_start, x_end, y_end, len);
+        }
+        esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, x_start, y_start, x_end, y_end, color_map);
+        return;
+    }
+
+    /* Panel driver computes the size from its bits per pixel, so the window and the packed pixels are sent directly */
+    size_t len;
+    if (disp_ctx->output.rgb444) {
+        len = lvgl_port_rgb565_to_rgb444(color_map, color_map, x_end - x_start, y_end - y_start, x_start, y_start, disp_ctx->output.dither);
+    } else {
+        len = (size_t)(x_end - x_start) * (y_end - y_start) * lv_color_format_get_size(lv_display_get_color_format(disp_ctx->disp_drv));
+    }
+    if (disp_ctx->flags.te_sync) {
+        lvgl_port_te_wait(disp_ctx, x_start, y_start, x_end, y_end, len);
+    }
+    const int64_t start = esp_timer_get_time();
+
+    /*
+     * Next band of the same area is sent with RAMWRC, queued behind the transfer in flight. Commands (CASET, RASET)
+     * would wait for all queued transfers and leave the bus idle between them.
+     */
+    if (disp_ctx->flags.chain_bands) {
+        /* Packed RGB444 continues in the middle of a byte after an odd pixel count */
+        const bool byte_end = !disp_ctx->output.rgb444 || ((x_end - x_start) * (y_end - y_start)) % 2 == 0;
+        int32_t win_y_end;
+        if (lvgl_port_chain_band(&disp_ctx->chain, x_start, y_start, x_end, y_end, lv_display_get_vertical_resolution(disp_ctx->disp_drv), byte_end, &win_y_end)) {
+            disp_ctx->stats.counters.chained_bands++;
+            lvgl_port_panel_tx_color(disp_ctx, LCD_CMD_RAMWRC, color_map, len, start);
+            return;
+        }
+        y_end = win_y_end;
+    }
+    x_start += disp_ctx->output.x_gap;
+    x_end += disp_ctx->output.x_gap;
+    y_start += disp_ctx->output.y_gap;
+    y_end += disp_ctx->output.y_gap;
+
+    esp_lcd_panel_io_tx_param(disp_ctx->io_handle, lvgl_port_panel_cmd(disp_ctx, LCD_CMD_CASET, false), (uint8_t[]) {
+        (x_start >> 8) & 0xFF, x_start & 0xFF, ((x_end - 1) >> 8) & 0xFF, (x_end - 1) & 0xFF,
+    }, 4);
+    esp_lcd_panel_io_tx_param(disp_ctx->io_handle, lvgl_port_panel_cmd(disp_ctx, LCD_CMD_RASET, false), (uint8_t[]) {
+        (y_start >> 8) & 0xFF, y_start & 0xFF, ((y_end - 1) >> 8) & 0xFF, (y_end - 1) & 0xFF,
+    }, 4);
+    lvgl_port_panel_tx_color(disp_ctx, LCD_CMD_RAMWR, color_map, len, start);
+}
+
+static void lvgl_port_te_isr(void *arg)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)arg;
+    const int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL_ISR(&disp_ctx->te.lock);
+    const int64_t period = now - disp_ctx->te.last_us;
+    if (disp_ctx->te.last_us && period < LVGL_PORT_TE_PERIOD_MAX_US) {
+        disp_ctx->te.period_us = (disp_ctx->te.period_us ? (disp_ctx->te.period_us * 7 + (uint32_t)period) / 8 : (uint32_t)period);
+    }
+    disp_ctx->te.last_us = now;
+    portEXIT_CRITICAL_ISR(&disp_ctx->te.lock);
+}
+
+static void lvgl_port_te_timer_callback(void *arg)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)arg;
+    xSemaphoreGive(disp_ctx->te.sem);
+}
+
+static esp_err_t lvgl_port_te_init(lvgl_port_display_ctx_t *disp_ctx, int gpio_num)
+{
+    esp_err_t ret = ESP_OK;
+    assert(disp_ctx != NULL);
+
+    portMUX_INITIALIZE(&disp_ctx->te.lock);
+    disp_ctx->te.gpio_num = gpio_num;
+    disp_ctx->te.sem = xSemaphoreCreateBinary();
+    ESP_RETURN_ON_FALSE(disp_ctx->te.sem, ESP_ERR_NO_MEM, TAG, "Failed to create TE semaphore");
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = lvgl_port_te_timer_callback,
+        .arg = disp_ctx,
+        .name = "LVGL TE",
+    };
+    ESP_GOTO_ON_ERROR(esp_timer_create(&timer_args, &disp_ctx->te.timer), err, TAG, "Failed to create TE timer");
+
+    /* TE output of the panel: pulse at the start of the scan (V-blanking only) */
+    ESP_GOTO_ON_ERROR(esp_lcd_panel_io_tx_param(disp_ctx->io_handle, lvgl_port_panel_cmd(disp_ctx, LCD_CMD_TEON, false), (uint8_t[]) {
+        0x00
+    }, 1), err, TAG, "Enable TE output failed");
+
+    const gpio_config_t te_gpio = {
+        .pin_bit_mask = 1ULL << gpio_num,
+        .mode = GPIO_MODE_INPUT,
+        .intr_type = GPIO_INTR_POSEDGE,
+    };
+    ESP_GOTO_ON_ERROR(gpio_config(&te_gpio), err, TAG, "TE GPIO config failed");
+    /* ISR service can be installed by other drivers already */
+    ret = gpio_install_isr_service(0);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK || ret == ESP_ERR_INVALID_STATE, ret, err, TAG, "Install GPIO ISR service failed");
+    ESP_GOTO_ON_ERROR(gpio_isr_handler_add(gpio_num, lvgl_port_te_isr, disp_ctx), err, TAG, "Add TE GPIO ISR failed");
+
+    return ESP_OK;
+
+err:
+    if (disp_ctx->te.timer) {
+        esp_timer_delete(disp_ctx->te.timer);
+        disp_ctx->te.timer = NULL;
+    }
+    vSemaphoreDelete(disp_ctx->te.sem);
+    disp_ctx->te.sem = NULL;
+    return ret;
+}
+
+static void lvgl_port_te_deinit(lvgl_port_display_ctx_t *disp_ctx)
+{
+    assert(disp_ctx != NULL);
+    if (disp_ctx->te.sem == NULL) {
+        return;
+    }
+
+    gpio_isr_handler_remove(disp_ctx->te.gpio_num);
+    gpio_set_intr_type(disp_ctx->te.gpio_num, GPIO_INTR_DISABLE);
+    esp_timer_stop(disp_ctx->te.timer);
+    esp_timer_delete(disp_ctx->te.timer);
+    disp_ctx->te.timer = NULL;
+    vSemaphoreDelete(disp_ctx->te.sem);
+    disp_ctx->te.sem = NULL;
+}
+
+/* Delay the band transfer, so that the panel scan doesn't cross the written rows. It is called right before the transfer */
+static void lvgl_port_te_wait(lvgl_port_display_ctx_t *disp_ctx, int x_start, int y_start, int x_end, int y_end, size_t len)
+{
+    portENTER_CRITICAL(&disp_ctx->te.lock);
+    const int64_t last_us = disp_ctx->te.last_us;
+    const uint32_t period_us = disp_ctx->te.period_us;
+    portEXIT_CRITICAL(&disp_ctx->te.lock);
+
+    const int64_t now = esp_timer_get_time();
+    const uint32_t ns_per_byte = disp_ctx->te.ns_per_byte;
+    if (disp_ctx->te.trans_bytes == 0) {
+        /* Measure this transfer. Panel IO sends the commands after queued color transfers, so a transfer queued behind another one is measured longer (safe side) */
+        disp_ctx->te.trans_start = now;
+        disp_ctx->te.trans_bytes = len;
+    }
+
+    /* TE is not running, or the transfer time is not known yet */
+    if (period_us == 0 || now - last_us > 2 * (int64_t)period_us || ns_per_byte == 0) {
+        return;
+    }
+
+    /* Rows of the panel memory in the scan direction */
+    lv_display_t *disp = disp_ctx->disp_drv;
+    const int32_t lines = (disp_ctx->te.swap_xy ? lv_display_get_horizontal_resolution(disp) : lv_display_get_vertical_resolution(disp));
+    int32_t y1 = (disp_ctx->te.swap_xy ? x_start : y_start);
+    int32_t y2 = (disp_ctx->te.swap_xy ? x_end : y_end) - 1;
+    if (disp_ctx->te.mirror_rows) {
+        const int32_t y1_mirrored = lines - 1 - y2;
+        y2 = lines - 1 - y1;
+        y1 = y1_mirrored;
+    }
+
+    /* With swapped XY, all rows of the band are written during the whole transfer */
+    const lvgl_port_te_timing_t timing = {
+        .period_us = period_us,
+        .lines = lines,
+    };
+    const bool down = !disp_ctx->te.swap_xy && !disp_ctx->te.mirror_rows;
+    const uint32_t trans_us = (uint32_t)((uint64_t)len * ns_per_byte / 1000) + LVGL_PORT_TE_MARGIN_US;
+    const uint32_t delay_us = lvgl_port_te_get_delay(&timing, (uint32_t)(now - last_us), y1, y2, down, trans_us);
+    if (delay_us == 0) {
+        return;
+    }
+
+    if (delay_us <= LVGL_PORT_TE_SPIN_MAX_US) {
+        esp_rom_delay_us(delay_us);
+    } else {
+        xSemaphoreTake(disp_ctx->te.sem, 0);
+        esp_timer_start_once(disp_ctx->te.timer, delay_us);
+        if (xSemaphoreTake(disp_ctx->te.sem, pdMS_TO_TICKS(LVGL_PORT_TE_PERIOD_MAX_US / 1000)) != pdTRUE) {
+            esp_timer_stop(disp_ctx->te.timer);
+        }
+    }
+    disp_ctx->stats.counters.te_delay_us += delay_us;
+
+    /* Measured transfer starts after the delay */
+    if (disp_ctx->te.trans_start == now) {
+        disp_ctx->te.trans_start = esp_timer_get_time();
+    }
+}
+
+/* Size of one draw buffer to start with: the configured size, limited by the RAM ceiling and the free heap */
+static uint32_t lvgl_port_buff_tune_start(lvgl_port_display_ctx_t *disp_ctx, const lvgl_port_display_cfg_t *disp_cfg, lv_color_format_t color_format, uint32_t buff_caps)
+{
+    const lvgl_port_buff_tune_cfg_t *cfg = &disp_cfg->buff_tune;
+    const uint8_t buffers = (disp_cfg->double_buffer ? 2 : 1);
+    const uint32_t px_size = lv_color_format_get_size(color_format);
+    const uint32_t line_bytes = disp_cfg->hres * px_size;
+    const uint32_t buff_bytes = disp_cfg->buffer_size * sizeof(lv_color_t);
+
+    uint32_t max_bytes = (cfg->max_bytes ? cfg->max_bytes / buffers : buff_bytes);
+    max_bytes = LV_MIN(max_bytes, disp_cfg->vres * line_bytes);
+    const uint32_t min_bytes = (cfg->min_lines ? cfg->min_lines : LVGL_PORT_BUFF_TUNE_MIN_LINES) * line_bytes;
+
+    disp_ctx->tune.caps = buff_caps;
+    disp_ctx->tune.heap_reserve = (cfg->heap_reserve ? cfg->heap_reserve : LVGL_PORT_BUFF_TUNE_HEAP_RESERVE);
+    const size_t free_bytes = heap_caps_get_free_size(buff_caps);
+    size_t heap_bytes = (free_bytes > disp_ctx->tune.heap_reserve ? (free_bytes - disp_ctx->tune.heap_reserve) / buffers : 0);
+    heap_bytes = LV_MIN(heap_bytes, heap_caps_get_largest_free_block(buff_caps));
+
+    lvgl_port_buff_tune_init(&disp_ctx->tune.state, px_size, buffers, line_bytes, min_bytes, max_bytes,
+                             LV_MIN(buff_bytes, heap_bytes), LVGL_PORT_BUFF_TUNE_WINDOW);
+    return lvgl_port_buff_tune_get_size(&disp_ctx->tune.state);
+}
+
+/* Called at the start of the flush callback: render time of the band and flush time of the previous one */
+static void lvgl_port_buff_tune_band(lvgl_port_display_ctx_t *disp_ctx, const lv_area_t *area)
+{
+    const int64_t now = esp_timer_get_time();
+    if (disp_ctx->tune.flush_end) {
+        lvgl_port_buff_tune_add_flush(&disp_ctx->tune.state, disp_ctx->tune.flush_px, (uint32_t)(disp_ctx->tune.flush_end - disp_ctx->tune.flush_start));
+        disp_ctx->tune.flush_end = 0;
+    }
+
+    const int64_t render_us = now - disp_ctx->tune.render_start - disp_ctx->tune.wait_us;
+    lvgl_port_buff_tune_add_band(&disp_ctx->tune.state, area->x1, area->y1, area->x2, area->y2, (uint32_t)LV_MAX(render_us, 0));
+
+    disp_ctx->tune.flush_start = now;
+    disp_ctx->tune.flush_px = lv_area_get_size(area);
+    xSemaphoreTake(disp_ctx->tune.done_sem, 0);
+    disp_ctx->tune.in_flight = true;
+}
+
+/* Replace the draw buffers between frames, LVGL doesn't use them now */
+static void lvgl_port_buff_tune_resize(lvgl_port_display_ctx_t *disp_ctx, uint32_t size)
+{
+    lvgl_port_buff_tune_t *state = &disp_ctx->tune.state;
+    const uint32_t old_size = disp_ctx->merge.buff_bytes;
+
+    /* The last band of the frame can be in flight */
+    if (disp_ctx->tune.in_flight && xSemaphoreTake(disp_ctx->tune.done_sem, pdMS_TO_TICKS(LVGL_PORT_BUFF_TUNE_WAIT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "Draw buffers were not resized, the flush is not finished");
+        lvgl_port_buff_tune_limit(state, old_size);
+        return;
+    }
+
+    free(disp_ctx->draw_buffs[0]);
+    free(disp_ctx->draw_buffs[1]);
+    disp_ctx->draw_buffs[0] = NULL;
+    disp_ctx->draw_buffs[1] = NULL;
+
+    /* Bigger size must leave the heap reserve, the old size fits always */
+    const size_t free_bytes = heap_caps_get_free_size(disp_ctx->tune.caps);
+    if (size > old_size && free_bytes < (size_t)size * state->buffers + disp_ctx->tune.heap_reserve) {
+        size = old_size;
+    }
+    for (int i = 0; i < state->buffers; i++) {
+        disp_ctx->draw_buffs[i] = heap_caps_malloc(size, disp_ctx->tune.caps);
+    }
+    if (disp_ctx->draw_buffs[0] == NULL || (state->buffers > 1 && disp_ctx->draw_buffs[1] == NULL)) {
+        free(disp_ctx->draw_buffs[0]);
+        free(disp_ctx->draw_buffs[1]);
+        size = old_size;
+        for (int i = 0; i < state->buffers; i++) {
+            disp_ctx->draw_buffs[i] = heap_caps_malloc(size, disp_ctx->tune.caps);
+        }
+    }
+    if (size != lvgl_port_buff_tune_get_size(state)) {
+        ESP_LOGW(TAG, "Not enough memory for draw buffers of %"PRIu32" bytes", lvgl_port_buff_tune_get_size(state));
+        lvgl_port_buff_tune_limit(state, size);
+    }
+    assert(disp_ctx->draw_buffs[0]);
+
+    lv_display_set_buffers(disp_ctx->disp_drv, disp_ctx->draw_buffs[0], disp_ctx->draw_buffs[1], size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    disp_ctx->merge.buff_bytes = size;
+    disp_ctx->tune.resizes++;
+}
+
+static void lvgl_port_disp_buff_tune_callback(lv_event_t *e)
+{
+    assert(e);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_event_get_user_data(e);
+    assert(disp_ctx != NULL);
+
+    /* First band of the frame is rendered from here */
+    if (lv_event_get_code(e) == LV_EVENT_REFR_START) {
+        disp_ctx->tune.render_start = esp_timer_get_time();
+        disp_ctx->tune.wait_us = 0;
+        return;
+    }
+
+    const uint32_t size = lvgl_port_buff_tune_frame_done(&disp_ctx->tune.state);
+    if (size) {
+        lvgl_port_buff_tune_resize(disp_ctx, size);
+    }
+}
+
+static void lvgl_port_fb_sync_copy(void *dst, const void *src, size_t len, void *user_ctx)
+{
+    lvgl_port_copy_submit((lvgl_port_copy_t *)user_ctx, dst, src, len, NULL, NULL);
+}
+
+static void lvgl_port_fb_sync(lvgl_port_display_ctx_t *disp_ctx)
+{
+    lv_display_t *disp = disp_ctx->disp_drv;
+    const uint8_t back = disp_ctx->sync.back;
+    const uint32_t px_size = lv_color_format_get_size(lv_display_get_color_format(disp));
+
+    /* The back buffer is shown now, the other one is one frame old */
+    lvgl_port_sync_copy(&disp_ctx->sync.areas, (uint8_t *)disp_ctx->sync.fbs[back ^ 1], (const uint8_t *)disp_ctx->sync.fbs[back],
+                        lv_display_get_horizontal_resolution(disp), lv_display_get_vertical_resolution(disp), px_size, lvgl_port_fb_sync_copy, disp_ctx->sync.copy);
+    lvgl_port_sync_reset(&disp_ctx->sync.areas);
+
+    disp_ctx->sync.back = back ^ 1;
+    lv_display_set_buffers(disp, disp_ctx->sync.fbs[disp_ctx->sync.back], NULL, disp_ctx->sync.size, LV_DISPLAY_RENDER_MODE_DIRECT);
+}
+
+/* LVGL draws into the back buffer from here, the areas of the last frame must be copied into it */
+static void lvgl_port_disp_fb_sync_callback(lv_event_t *e)
+{
+    assert(e);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_event_get_user_data(e);
+    assert(disp_ctx != NULL);
+
+    lvgl_port_copy_wait(disp_ctx->sync.copy);
+}
+
+static void lvgl_port_disp_buff_pool_callback(lv_event_t *e)
+{
+    assert(e);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_event_get_user_data(e);
+    assert(disp_ctx != NULL);
+    lvgl_port_buff_pool_t *pool = &lvgl_port_buff_pool;
+
+    /* The last band of the display, which rendered into the buffers before, is waited for */
+    const uint32_t timeouts = pool->timeouts;
+    if (!lvgl_port_buff_pool_borrow(pool, &disp_ctx->pool.user)) {
+        return;
+    }
+    if (pool->timeouts != timeouts) {
+        ESP_LOGW(TAG, "Shared draw buffers were taken, the flush is not finished");
+    }
+    lv_display_set_buffers(disp_ctx->disp_drv, pool->buffs[0], (disp_ctx->pool.user.count > 1 ? pool->buffs[1] : NULL),
+                           disp_ctx->pool.user.size, disp_ctx->pool.render_mode);
+}
+
+/* Visible window in the coordinates of the current rotation (inverse of lvgl_port_rotate_area) */
+static void lvgl_port_disp_visible_update(lvgl_port_display_ctx_t *disp_ctx)
+{
+    const lvgl_port_visible_cfg_t *cfg = &disp_ctx->visible.cfg;
+    const int32_t x1 = cfg->x;
+    const int32_t y1 = cfg->y;
+    const int32_t x2 = cfg->x + cfg->width - 1;
+    const int32_t y2 = cfg->y + cfg->height - 1;
+    const int32_t hres = disp_ctx->visible.hres;
+    const int32_t vres = disp_ctx->visible.vres;
+    lvgl_port_visible_t *window = &disp_ctx->visible.window;
+
+    switch (lv_display_get_rotation(disp_ctx->disp_drv)) {
+    case LV_DISPLAY_ROTATION_90:
+        lvgl_port_visible_init(window, vres - 1 - y2, x1, vres - 1 - y1, x2, cfg->radius);
+        break;
+    case LV_DISPLAY_ROTATION_180:
+        lvgl_port_visible_init(window, hres - 1 - x2, vres - 1 - y2, hres - 1 - x1, vres - 1 - y1, cfg->radius);
+        break;
+    case LV_DISPLAY_ROTATION_270:
+        lvgl_port_visible_init(window, y1, hres - 1 - x2, y2, hres - 1 - x1, cfg->radius);
+        break;
+    default:
+        lvgl_port_visible_init(window, x1, y1, x2, y2, cfg->radius);
+        break;
+    }
+}
+
+static void lvgl_port_disp_visible_callback(lv_event_t *e)
+{
+    assert(e);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_event_get_user_data(e);
+    assert(disp_ctx != NULL);
+
+    /* Column 0 of the probe may be hidden, the clipped probe would give bands of one line */
+    if (lvgl_port_disp_is_refreshing(disp_ctx->disp_drv)) {
+        return;
+    }
+
+    lv_area_t *area = (lv_area_t *)lv_event_get_param(e);
+    const uint32_t size = lv_area_get_size(area);
+    int32_t x1 = area->x1;
+    int32_t y1 = area->y1;
+    int32_t x2 = area->x2;
+    int32_t y2 = area->y2;
+    if (!lvgl_port_visible_clip(&disp_ctx->visible.window, &x1, &y1, &x2, &y2)) {
+        /* The invalidation can't be dropped here, one hidden pixel is rendered and not sent */
+        x2 = x1 = area->x1;
+        y2 = y1 = area->y1;
+    }
+    area->x1 = x1;
+    area->y1 = y1;
+    area->x2 = x2;
+    area->y2 = y2;
+    disp_ctx->stats.counters.visible_skipped_px += size - lv_area_get_size(area);
+}
+
+static void lvgl_port_disp_rounder_callback(lv_event_t *e)
+{
+    assert(e);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_event_get_user_data(e);
+    assert(disp_ctx != NULL);
+
+    lv_area_t *area = (lv_area_t *)lv_event_get_param(e);
+    int32_t x1 = area->x1;
+    int32_t y1 = area->y1;
+    int32_t x2 = area->x2;
+    int32_t y2 = area->y2;
+    lvgl_port_rounder_area(&disp_ctx->rounder.area, &x1, &y1, &x2, &y2);
+    area->x1 = x1;
+    area->y1 = y1;
+    area->x2 = x2;
+    area->y2 = y2;
+}
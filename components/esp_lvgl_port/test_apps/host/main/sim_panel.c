@@ -0,0 +1,372 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test_common.h"
+#include "sim_panel.h"
+
+#define SIM_PANEL_MIN(a, b)     ((a) < (b) ? (a) : (b))
+#define SIM_PANEL_MAX(a, b)     ((a) > (b) ? (a) : (b))
+
+typedef struct {
+    int         cmd;
+    const uint8_t *color;
+    size_t      size;
+} sim_panel_trans_t;
+
+struct sim_panel_t {
+    sim_panel_config_t  config;
+    uint16_t            *frame;
+    /* Address window and write cursor */
+    int32_t             x1, y1, x2, y2;
+    int32_t             cx, cy;
+    uint32_t            bpp;
+    uint32_t            acc;            /* Bits of a pixel, which is not complete yet */
+    uint32_t            acc_bits;
+    /* Scan of the current color transfer */
+    int64_t             scan_first;     /* Scan, which shows the first row of the transfer (INT64_MIN: no row yet) */
+    bool                torn;
+    uint64_t            scan_start_ns;  /* TE pulse of the first scan */
+    /* Queue of color transfers */
+    sim_panel_trans_t   *queue;
+    uint32_t            head;
+    uint32_t            count;
+    bool                stop;
+    uint64_t            bus_free_ns;    /* End of the last transfer on the bus */
+    sim_panel_stats_t   stats;
+    pthread_t           dma_thread;
+    pthread_t           scan_thread;
+    pthread_mutex_t     lock;
+    pthread_cond_t      queued;         /* New transfer or stop */
+    pthread_cond_t      done;           /* Transfer finished */
+};
+
+/*******************************************************************************
+* Local functions
+*******************************************************************************/
+
+/* Occupy the bus for a transfer, called with the lock held */
+static uint64_t sim_panel_bus_reserve(sim_panel_t *panel, size_t size)
+{
+    const uint64_t trans_ns = sim_panel_get_trans_ns(panel, size);
+    const uint64_t end = SIM_PANEL_MAX(test_time_ns(), panel->bus_free_ns) + trans_ns;
+    panel->bus_free_ns = end;
+    panel->stats.busy_ns += trans_ns;
+    panel->stats.transactions++;
+    return end;
+}
+
+static uint16_t sim_panel_rgb444_to_rgb565(uint32_t px)
+{
+    const uint32_t r = (px >> 8) & 0xF;
+    const uint32_t g = (px >> 4) & 0xF;
+    const uint32_t b = px & 0xF;
+    return ((r << 1 | r >> 3) << 11) | ((g << 2 | g >> 2) << 5) | (b << 1 | b >> 3);
+}
+
+/* Check the scan, which shows the new content of the row written at the time */
+static void sim_panel_scan_check(sim_panel_t *panel, int32_t row, uint64_t time_ns)
+{
+    if (panel->config.refresh_us == 0) {
+        return;
+    }
+
+    const int64_t period = (int64_t)panel->config.refresh_us * 1000;
+    const int64_t since = (int64_t)(time_ns - panel->scan_start_ns) - row * period / panel->config.height;
+    const int64_t scan = (since >= 0) ? since / period : -((-since + period - 1) / period);
+    if (panel->scan_first == INT64_MIN) {
+        panel->scan_first = scan;
+    } else if (scan != panel->scan_first) {
+        panel->torn = true;
+    }
+}
+
+/* Write bytes from the bus to the address window, MSB of a pixel is sent first. Bytes are sent evenly from data_start_ns to data_end_ns */
+static void sim_panel_write(sim_panel_t *panel, const uint8_t *data, size_t size, uint64_t data_start_ns, uint64_t data_end_ns)
+{
+    const uint32_t mask = (1u << panel->bpp) - 1;
+
+    for (size_t i = 0; i < size; i++) {
+        panel->acc = (panel->acc << 8) | data[i];
+        panel->acc_bits += 8;
+        while (panel->acc_bits >= panel->bpp) {
+            panel->acc_bits -= panel->bpp;
+            const uint32_t px = (panel->acc >> panel->acc_bits) & mask;
+            if (panel->cy > panel->y2) {
+                /* Behind the window, the pixel is dropped */
+                continue;
+            }
+            panel->frame[panel->cy * panel->config.width + panel->cx] = (panel->bpp == 12) ? sim_panel_rgb444_to_rgb565(px) : px;
+            if (panel->cx == panel->x2 || i == size - 1) {
+                sim_panel_scan_check(panel, panel->cy, data_start_ns + (data_end_ns - data_start_ns) * (i + 1) / size);
+            }
+            if (++panel->cx > panel->x2) {
+                panel->cx = panel->x1;
+                panel->cy++;
+            }
+        }
+    }
+}
+
+static void *sim_panel_dma_task(void *arg)
+{
+    sim_panel_t *panel = arg;
+
+    pthread_mutex_lock(&panel->lock);
+    while (true) {
+        while (panel->count == 0 && !panel->stop) {
+            pthread_cond_wait(&panel->queued, &panel->lock);
+        }
+        if (panel->count == 0) {
+            break;
+        }
+
+        const sim_panel_trans_t trans = panel->queue[panel->head];
+        const uint64_t end = sim_panel_bus_reserve(panel, trans.size + 1);
+        pthread_mutex_unlock(&panel->lock);
+
+        /* DMA reads the buffer during the whole transfer, the content at its end is taken */
+        test_sleep_until_ns(end);
+
+        pthread_mutex_lock(&panel->lock);
+        if (trans.cmd == SIM_PANEL_CMD_RAMWR) {
+            panel->cx = panel->x1;
+            panel->cy = panel->y1;
+            panel->acc_bits = 0;
+        }
+        if (trans.cmd == SIM_PANEL_CMD_RAMWR || trans.cmd == SIM_PANEL_CMD_RAMWRC) {
+            panel->scan_first = INT64_MIN;
+            panel->torn = false;
+            sim_panel_write(panel, trans.color, trans.size, end - sim_panel_get_trans_ns(panel, trans.size + 1) + panel->config.trans_overhead_us * 1000, end);
+            panel->stats.torn_trans += panel->torn;
+        }
+        panel->stats.color_bytes += trans.size;
+        pthread_mutex_unlock(&panel->lock);
+
+        /* Callback is called before the transfer leaves the queue, so the idle panel has no pending callback */
+        if (panel->config.on_color_trans_done) {
+            panel->config.on_color_trans_done(panel, panel->config.user_ctx);
+        }
+
+        pthread_mutex_lock(&panel->lock);
+        panel->head = (panel->head + 1) % panel->config.trans_queue_depth;
+        panel->count--;
+        pthread_cond_broadcast(&panel->done);
+    }
+    pthread_mutex_unlock(&panel->lock);
+
+    return NULL;
+}
+
+static void *sim_panel_scan_task(void *arg)
+{
+    sim_panel_t *panel = arg;
+    uint64_t te_ns = panel->scan_start_ns;
+
+    pthread_mutex_lock(&panel->lock);
+    while (!panel->stop) {
+        pthread_mutex_unlock(&panel->lock);
+        test_sleep_until_ns(te_ns);
+        if (panel->config.on_te) {
+            panel->config.on_te(panel, te_ns, panel->config.user_ctx);
+        }
+        te_ns += (uint64_t)panel->config.refresh_us * 1000;
+        pthread_mutex_lock(&panel->lock);
+    }
+    pthread_mutex_unlock(&panel->lock);
+
+    return NULL;
+}
+
+static void sim_panel_wait_idle_locked(sim_panel_t *panel)
+{
+    while (panel->count) {
+        pthread_cond_wait(&panel->done, &panel->lock);
+    }
+}
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+sim_panel_t *sim_panel_new(const sim_panel_config_t *config)
+{
+    sim_panel_t *panel = calloc(1, sizeof(sim_panel_t));
+    if (panel == NULL) {
+        return NULL;
+    }
+    panel->config = *config;
+    panel->config.trans_queue_depth = SIM_PANEL_MAX(config->trans_queue_depth, 1);
+    panel->config.bus_width = SIM_PANEL_MAX(config->bus_width, 1);
+    panel->frame = calloc((size_t)config->width * config->height, sizeof(uint16_t));
+    panel->queue = calloc(panel->config.trans_queue_depth, sizeof(sim_panel_trans_t));
+    if (panel->frame == NULL || panel->queue == NULL) {
+        goto err;
+    }
+
+    panel->x2 = config->width - 1;
+    panel->y2 = config->height - 1;
+    panel->bpp = 16;
+    pthread_mutex_init(&panel->lock, NULL);
+    pthread_cond_init(&panel->queued, NULL);
+    pthread_cond_init(&panel->done, NULL);
+    panel->scan_start_ns = test_time_ns();
+    if (pthread_create(&panel->dma_thread, NULL, sim_panel_dma_task, panel) != 0) {
+        pthread_cond_destroy(&panel->done);
+        pthread_cond_destroy(&panel->queued);
+        pthread_mutex_destroy(&panel->lock);
+        goto err;
+    }
+    if (config->refresh_us && pthread_create(&panel->scan_thread, NULL, sim_panel_scan_task, panel) != 0) {
+        panel->config.refresh_us = 0;
+        sim_panel_del(panel);
+        return NULL;
+    }
+
+    return panel;
+err:
+    free(panel->frame);
+    free(panel->queue);
+    free(panel);
+    return NULL;
+}
+
+void sim_panel_del(sim_panel_t *panel)
+{
+    pthread_mutex_lock(&panel->lock);
+    panel->stop = true;
+    pthread_cond_signal(&panel->queued);
+    pthread_mutex_unlock(&panel->lock);
+    pthread_join(panel->dma_thread, NULL);
+    if (panel->config.refresh_us) {
+        pthread_join(panel->scan_thread, NULL);
+    }
+
+    pthread_cond_destroy(&panel->done);
+    pthread_cond_destroy(&panel->queued);
+    pthread_mutex_destroy(&panel->lock);
+    free(panel->frame);
+    free(panel->queue);
+    free(panel);
+}
+
+void sim_panel_tx_param(sim_panel_t *panel, int cmd, const void *param, size_t size)
+{
+    const uint8_t *p = param;
+
+    pthread_mutex_lock(&panel->lock);
+    sim_panel_wait_idle_locked(panel);
+    const uint64_t end = sim_panel_bus_reserve(panel, size + 1);
+    panel->stats.param_bytes += size;
+
+    if ((cmd == SIM_PANEL_CMD_CASET || cmd == SIM_PANEL_CMD_RASET) && size == 4) {
+        const int32_t limit = (cmd == SIM_PANEL_CMD_CASET ? panel->config.width : panel->config.height) - 1;
+        const int32_t start = SIM_PANEL_MIN((p[0] << 8) | p[1], limit);
+        const int32_t end_addr = SIM_PANEL_MIN((p[2] << 8) | p[3], limit);
+        if (cmd == SIM_PANEL_CMD_CASET) {
+            panel->x1 = start;
+            panel->x2 = SIM_PANEL_MAX(end_addr, start);
+        } else {
+            panel->y1 = start;
+            panel->y2 = SIM_PANEL_MAX(end_addr, start);
+        }
+    } else if (cmd == SIM_PANEL_CMD_COLMOD && size == 1) {
+        panel->bpp = (p[0] == SIM_PANEL_COLMOD_RGB444) ? 12 : 16;
+    } else if (cmd == SIM_PANEL_CMD_RAMWR || cmd == SIM_PANEL_CMD_RAMWRC) {
+        if (cmd == SIM_PANEL_CMD_RAMWR) {
+            panel->cx = panel->x1;
+            panel->cy = panel->y1;
+            panel->acc_bits = 0;
+        }
+        panel->scan_first = INT64_MIN;
+        panel->torn = false;
+        sim_panel_write(panel, p, size, end - sim_panel_get_trans_ns(panel, size + 1) + panel->config.trans_overhead_us * 1000, end);
+        panel->stats.torn_trans += panel->torn;
+        panel->stats.color_bytes += size;
+        panel->stats.param_bytes -= size;
+    }
+    pthread_mutex_unlock(&panel->lock);
+
+    /* Parameters are sent by polling */
+    test_sleep_until_ns(end);
+}
+
+void sim_panel_tx_color(sim_panel_t *panel, int cmd, const void *color, size_t size)
+{
+    pthread_mutex_lock(&panel->lock);
+    while (panel->count == panel->config.trans_queue_depth) {
+        pthread_cond_wait(&panel->done, &panel->lock);
+    }
+    panel->queue[(panel->head + panel->count) % panel->config.trans_queue_depth] = (sim_panel_trans_t) {
+        .cmd = cmd,
+        .color = color,
+        .size = size,
+    };
+    panel->count++;
+    pthread_cond_signal(&panel->queued);
+    pthread_mutex_unlock(&panel->lock);
+}
+
+void sim_panel_draw_bitmap(sim_panel_t *panel, int x_start, int y_start, int x_end, int y_end, const void *color)
+{
+    const uint8_t caset[4] = {x_start >> 8, x_start & 0xFF, (x_end - 1) >> 8, (x_end - 1) & 0xFF};
+    const uint8_t raset[4] = {y_start >> 8, y_start & 0xFF, (y_end - 1) >> 8, (y_end - 1) & 0xFF};
+
+    sim_panel_tx_param(panel, SIM_PANEL_CMD_CASET, caset, sizeof(caset));
+    sim_panel_tx_param(panel, SIM_PANEL_CMD_RASET, raset, sizeof(raset));
+    sim_panel_tx_color(panel, SIM_PANEL_CMD_RAMWR, color, ((size_t)(x_end - x_start) * (y_end - y_start) * panel->bpp + 7) / 8);
+}
+
+void sim_panel_wait_idle(sim_panel_t *panel)
+{
+    pthread_mutex_lock(&panel->lock);
+    sim_panel_wait_idle_locked(panel);
+    pthread_mutex_unlock(&panel->lock);
+}
+
+const uint16_t *sim_panel_get_frame(const sim_panel_t *panel)
+{
+    return panel->frame;
+}
+
+void sim_panel_get_stats(const sim_panel_t *panel, sim_panel_stats_t *stats)
+{
+    pthread_mutex_lock((pthread_mutex_t *)&panel->lock);
+    *stats = panel->stats;
+    pthread_mutex_unlock((pthread_mutex_t *)&panel->lock);
+}
+
+uint64_t sim_panel_get_trans_ns(const sim_panel_t *panel, size_t size)
+{
+    const uint64_t bits = (uint64_t)size * 8;
+    const uint64_t cycles = (bits + panel->config.bus_width - 1) / panel->config.bus_width;
+    return (uint64_t)panel->config.trans_overhead_us * 1000 + cycles * 1000000000ULL / panel->config.pclk_hz;
+}
+
+bool sim_panel_dump_ppm(const sim_panel_t *panel, const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        return false;
+    }
+
+    bool ok = fprintf(f, "P6\n%"PRIu32" %"PRIu32"\n255\n", panel->config.width, panel->config.height) > 0;
+    const size_t count = (size_t)panel->config.width * panel->config.height;
+    for (size_t i = 0; i < count && ok; i++) {
+        const uint16_t px = panel->frame[i];
+        const uint8_t r = (px >> 11) & 0x1F;
+        const uint8_t g = (px >> 5) & 0x3F;
+        const uint8_t b = px & 0x1F;
+        const uint8_t rgb[3] = {r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2};
+        ok = fwrite(rgb, sizeof(rgb), 1, f) == 1;
+    }
+
+    return (fclose(f) == 0) && ok;
+}
@@ -0,0 +1,146 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Simulated MIPI DCS panel with a panel IO timing model
+ *
+ * The simulated panel follows the contract of esp_lcd panel IO on SPI/I80: parameters are sent synchronously
+ * after all queued color transfers, color transfers are queued and a "DMA" thread finishes them after the time
+ * they take on the bus. Pixels are read from the caller's buffer at the end of the transfer, so a buffer reused
+ * before on_color_trans_done shows up as wrong content in the frame buffer.
+ *
+ * Optionally, the panel scans its memory once per refresh period, with a TE pulse (simulated GPIO interrupt) at the scan
+ * of row 0. A color transfer, whose rows are shown partly in one scan and partly in the next one, is counted as torn.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIM_PANEL_CMD_CASET     0x2A
+#define SIM_PANEL_CMD_RASET     0x2B
+#define SIM_PANEL_CMD_RAMWR     0x2C
+#define SIM_PANEL_CMD_COLMOD    0x3A
+#define SIM_PANEL_CMD_RAMWRC    0x3C
+
+#define SIM_PANEL_COLMOD_RGB444 0x53
+#define SIM_PANEL_COLMOD_RGB565 0x55
+
+typedef struct sim_panel_t sim_panel_t;
+
+/**
+ * @brief Color transfer done callback, called from the simulated DMA thread (the same as on_color_trans_done)
+ *
+ * @return Ignored, kept for the same signature as in esp_lcd
+ */
+typedef bool (*sim_panel_trans_done_cb_t)(sim_panel_t *panel, void *user_ctx);
+
+/**
+ * @brief TE pulse callback, called from the simulated scan thread (the same as a GPIO interrupt)
+ *
+ * The host thread can wake up milliseconds after the pulse, time of the pulse is passed as the interrupt would take it.
+ */
+typedef void (*sim_panel_te_cb_t)(sim_panel_t *panel, uint64_t te_ns, void *user_ctx);
+
+/**
+ * @brief Simulated panel configuration
+ */
+typedef struct {
+    uint32_t    width;              /*!< Panel width in pixels */
+    uint32_t    height;             /*!< Panel height in pixels */
+    uint32_t    pclk_hz;            /*!< Bus clock */
+    uint32_t    bus_width;          /*!< Data lines of the bus (1: SPI, 8: I80) */
+    uint32_t    trans_overhead_us;  /*!< Fixed time of each transaction (command phase, driver and DMA setup) */
+    uint32_t    trans_queue_depth;  /*!< Color transfers, which can be queued (at least 1) */
+    uint32_t    refresh_us;         /*!< Scan period of the panel memory (0: the panel doesn't scan, no TE and no tearing check) */
+    sim_panel_trans_done_cb_t on_color_trans_done;  /*!< Callback after each color transfer */
+    sim_panel_te_cb_t on_te;        /*!< Callback at each TE pulse (optional) */
+    void        *user_ctx;          /*!< User data passed to the callbacks */
+} sim_panel_config_t;
+
+/**
+ * @brief Bus statistics of the simulated panel
+ */
+typedef struct {
+    uint64_t    color_bytes;        /*!< Bytes sent in color transfers */
+    uint64_t    param_bytes;        /*!< Bytes sent in parameter transfers */
+    uint32_t    transactions;       /*!< Count of all transfers */
+    uint64_t    busy_ns;            /*!< Time the bus was busy */
+    uint32_t    torn_trans;         /*!< Color transfers shown in two scans (tearing) */
+} sim_panel_stats_t;
+
+/**
+ * @brief Create simulated panel, its frame buffer (RGB565, native endian) and DMA thread
+ *
+ * @param config    Panel configuration
+ * @return Panel or NULL, when there is not enough memory
+ */
+sim_panel_t *sim_panel_new(const sim_panel_config_t *config);
+
+/**
+ * @brief Wait for all transfers and delete the panel
+ */
+void sim_panel_del(sim_panel_t *panel);
+
+/**
+ * @brief Send command with parameters (the same as esp_lcd_panel_io_tx_param())
+ *
+ * It waits for all queued color transfers and then for its own transfer.
+ * CASET, RASET and COLMOD (RGB565 and RGB444) are decoded, RAMWR and RAMWRC write the parameters as pixels (polled color transfer),
+ * other commands are only timed.
+ */
+void sim_panel_tx_param(sim_panel_t *panel, int cmd, const void *param, size_t size);
+
+/**
+ * @brief Queue color transfer (the same as esp_lcd_panel_io_tx_color())
+ *
+ * It blocks while the queue is full. RAMWR starts at the top left corner of the window, RAMWRC continues.
+ * The buffer must not be modified until the done callback.
+ */
+void sim_panel_tx_color(sim_panel_t *panel, int cmd, const void *color, size_t size);
+
+/**
+ * @brief Draw bitmap as a MIPI DCS panel driver does it (CASET, RASET, RAMWR), end is exclusive
+ */
+void sim_panel_draw_bitmap(sim_panel_t *panel, int x_start, int y_start, int x_end, int y_end, const void *color);
+
+/**
+ * @brief Wait until all queued transfers are done
+ */
+void sim_panel_wait_idle(sim_panel_t *panel);
+
+/**
+ * @brief Get the frame buffer (RGB565, native endian, stride is the panel width)
+ */
+const uint16_t *sim_panel_get_frame(const sim_panel_t *panel);
+
+/**
+ * @brief Get bus statistics
+ */
+void sim_panel_get_stats(const sim_panel_t *panel, sim_panel_stats_t *stats);
+
+/**
+ * @brief Get time of a transfer of the size on the bus
+ */
+uint64_t sim_panel_get_trans_ns(const sim_panel_t *panel, size_t size);
+
+/**
+ * @brief Save the frame buffer as a binary PPM image
+ *
+ * @return true on success
+ */
+bool sim_panel_dump_ppm(const sim_panel_t *panel, const char *path);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
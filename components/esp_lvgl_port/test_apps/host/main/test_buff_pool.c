@@ -0,0 +1,266 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "test_common.h"
+#include "esp_lvgl_port_buff_pool.h"
+
+#define POOL_REFRESHES      400
+#define POOL_TRANS_US       150     /* Transfer of one band */
+#define POOL_QUEUE          4
+
+/* Display as LVGL drives it: one band is flushed at a time, the next flush waits for the flush ready */
+typedef struct {
+    lvgl_port_buff_pool_user_t user;
+    uint8_t         *buffs[LVGL_PORT_BUFF_POOL_BUFFS];  /* Buffers set in LVGL */
+    int             act;
+    bool            flushing;
+} pool_display_t;
+
+typedef struct {
+    pool_display_t  *disp;
+    const uint8_t   *buf;
+    uint32_t        len;
+} pool_band_t;
+
+/* Panel IO: sends the bands in order, the done callback of each band runs in the IO thread */
+typedef struct {
+    pthread_t       thread;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    pool_band_t     queue[POOL_QUEUE];
+    uint32_t        queued;
+    uint32_t        done;
+    uint32_t        trans_us;
+    uint32_t        torn;           /* Bands changed during their transfer */
+    bool            stop;
+} pool_io_t;
+
+static uint32_t band_sum(const uint8_t *buf, uint32_t len)
+{
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        sum = sum * 31 + buf[i];
+    }
+    return sum;
+}
+
+static void *pool_io_task(void *arg)
+{
+    pool_io_t *io = arg;
+    pthread_mutex_lock(&io->lock);
+    while (true) {
+        while (!io->stop && io->done == io->queued) {
+            pthread_cond_wait(&io->cond, &io->lock);
+        }
+        if (io->done == io->queued) {
+            break;
+        }
+        const pool_band_t band = io->queue[io->done % POOL_QUEUE];
+        pthread_mutex_unlock(&io->lock);
+
+        /* The pixels must not change, until the transfer is done */
+        const uint32_t sum = band_sum(band.buf, band.len);
+        test_sleep_until_ns(test_time_ns() + io->trans_us * 1000ULL);
+        const bool torn = (band_sum(band.buf, band.len) != sum);
+
+        pthread_mutex_lock(&io->lock);
+        io->torn += torn;
+        io->done++;
+        /* Same order as the IO callback of the port: the pool first, then the flush ready */
+        lvgl_port_buff_pool_done(&band.disp->user);
+        band.disp->flushing = false;
+        pthread_cond_broadcast(&io->cond);
+    }
+    pthread_mutex_unlock(&io->lock);
+    return NULL;
+}
+
+static void pool_io_start(pool_io_t *io, uint32_t trans_us)
+{
+    memset(io, 0, sizeof(pool_io_t));
+    io->trans_us = trans_us;
+    pthread_mutex_init(&io->lock, NULL);
+    pthread_cond_init(&io->cond, NULL);
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&io->thread, NULL, pool_io_task, io));
+}
+
+static void pool_io_stop(pool_io_t *io)
+{
+    pthread_mutex_lock(&io->lock);
+    io->stop = true;
+    pthread_cond_broadcast(&io->cond);
+    pthread_mutex_unlock(&io->lock);
+    pthread_join(io->thread, NULL);
+    pthread_cond_destroy(&io->cond);
+    pthread_mutex_destroy(&io->lock);
+}
+
+/* The buffer is not sent and not queued */
+static bool pool_io_is_free(pool_io_t *io, const uint8_t *buf)
+{
+    bool free = true;
+    pthread_mutex_lock(&io->lock);
+    for (uint32_t i = io->done; i != io->queued; i++) {
+        free &= (io->queue[i % POOL_QUEUE].buf != buf);
+    }
+    pthread_mutex_unlock(&io->lock);
+    return free;
+}
+
+static void pool_wait_for_flushing(pool_io_t *io, pool_display_t *disp)
+{
+    pthread_mutex_lock(&io->lock);
+    while (disp->flushing) {
+        pthread_cond_wait(&io->cond, &io->lock);
+    }
+    pthread_mutex_unlock(&io->lock);
+}
+
+static void pool_flush(pool_io_t *io, pool_display_t *disp, const uint8_t *buf, uint32_t len)
+{
+    pthread_mutex_lock(&io->lock);
+    TEST_ASSERT_TRUE(io->queued - io->done < POOL_QUEUE);
+    lvgl_port_buff_pool_send(&disp->user);
+    disp->flushing = true;
+    io->queue[io->queued++ % POOL_QUEUE] = (pool_band_t) {
+        .disp = disp, .buf = buf, .len = len,
+    };
+    pthread_cond_broadcast(&io->cond);
+    pthread_mutex_unlock(&io->lock);
+}
+
+/* Refresh of the display as LVGL does it, the refresh ends with the last band in flight */
+static void pool_refresh(lvgl_port_buff_pool_t *pool, pool_io_t *io, pool_display_t *disp, uint32_t *x, uint32_t *rendered_in_flight)
+{
+    /* Start of the refresh (LV_EVENT_REFR_START) */
+    if (lvgl_port_buff_pool_borrow(pool, &disp->user)) {
+        for (int i = 0; i < LVGL_PORT_BUFF_POOL_BUFFS; i++) {
+            disp->buffs[i] = (i < disp->user.count ? pool->buffs[i] : NULL);
+        }
+        disp->act = 0;
+    }
+
+    const uint32_t bands = 1 + test_rand_next(x) % 6;
+    for (uint32_t b = 0; b < bands; b++) {
+        /* One buffer: rendering waits for the band in flight of this display */
+        if (disp->user.count == 1) {
+            pool_wait_for_flushing(io, disp);
+        }
+        uint8_t *buf = disp->buffs[disp->act];
+        const uint32_t len = 1 + test_rand_next(x) % disp->user.size;
+        *rendered_in_flight += !pool_io_is_free(io, buf);
+        memset(buf, (int)test_rand_next(x), len);
+
+        pool_wait_for_flushing(io, disp);
+        if (test_rand_next(x) % 4 == 0) {
+            /* Diff flush found nothing changed, the band is done without a transfer */
+            lvgl_port_buff_pool_send(&disp->user);
+            lvgl_port_buff_pool_done(&disp->user);
+        } else {
+            pool_flush(io, disp, buf, len);
+        }
+        disp->act = (disp->act + 1) % disp->user.count;
+    }
+}
+
+/*
+Functionality test
+
+Purpose:
+    - Test that no display renders into a shared draw buffer, which is still sent for another display
+
+Procedure:
+    - Two displays (two buffers of 2 kB, one buffer of 3 kB) share the pool and alternate refreshes, a refresh ends
+      with its last band in flight and some bands are done without a transfer (diff flush found no change)
+    - A thread sends the bands with a transfer time and checks that their pixels don't change during the transfer
+    - Before each band is rendered, its buffer must not be queued or sent
+    - Each change of the display is a borrow with a wait and no wait times out
+*/
+TEST_CASE("Shared draw buffers are not rendered while in flight", "[buff_pool][functionality]")
+{
+    lvgl_port_buff_pool_t pool = { 0 };
+    pool_display_t displays[2] = { 0 };
+    pool_io_t io;
+    uint32_t x = 0x1234567;
+    uint32_t rendered_in_flight = 0;
+
+    TEST_ASSERT_TRUE(lvgl_port_buff_pool_add(&pool, &displays[0].user, 2048, 2, 0));
+    TEST_ASSERT_TRUE(lvgl_port_buff_pool_add(&pool, &displays[1].user, 3072, 1, 0));
+    TEST_ASSERT_EQUAL_UINT32(2, pool.users);
+    TEST_ASSERT_EQUAL_UINT32(3072, pool.sizes[0]);
+    TEST_ASSERT_EQUAL_UINT32(2048, pool.sizes[1]);
+    TEST_ASSERT_EQUAL_UINT32(2 * 2048 + 3072, pool.private_bytes);
+
+    pool_io_start(&io, POOL_TRANS_US);
+    for (int r = 0; r < POOL_REFRESHES; r++) {
+        pool_refresh(&pool, &io, &displays[r % 2], &x, &rendered_in_flight);
+    }
+    pool_wait_for_flushing(&io, &displays[0]);
+    pool_wait_for_flushing(&io, &displays[1]);
+    pool_io_stop(&io);
+
+    printf("Shared buffers, %d refreshes: %"PRIu32" bands sent, %"PRIu32" borrows, %"PRIu32" waits in %"PRIu64" us\n",
+           POOL_REFRESHES, io.done, pool.borrows, pool.waits, pool.wait_us);
+    TEST_ASSERT_EQUAL_UINT32(0, rendered_in_flight);
+    TEST_ASSERT_EQUAL_UINT32(0, io.torn);
+    TEST_ASSERT_EQUAL_UINT32(POOL_REFRESHES - 1, pool.borrows);
+    TEST_ASSERT_TRUE(pool.waits > 0);
+    TEST_ASSERT_EQUAL_UINT32(0, pool.timeouts);
+
+    lvgl_port_buff_pool_remove(&pool, &displays[0].user);
+    lvgl_port_buff_pool_remove(&pool, &displays[1].user);
+    TEST_ASSERT_EQUAL_UINT32(0, pool.users);
+    TEST_ASSERT_EQUAL_UINT32(0, pool.private_bytes);
+    TEST_ASSERT_NULL(pool.buffs[0]);
+    TEST_ASSERT_NULL(pool.buffs[1]);
+}
+
+/*
+Functionality test
+
+Purpose:
+    - Test that a display with bigger buffers replaces the buffers of the pool only after the band in flight is sent
+
+Procedure:
+    - The first display borrows the buffers and sends a band with a long transfer
+    - The second display with bigger buffers is added: the band must be done, when the add returns
+    - Nobody owns the buffers then, the first display must set the new buffers at its next refresh
+*/
+TEST_CASE("Shared draw buffers are replaced after the band in flight", "[buff_pool][functionality]")
+{
+    lvgl_port_buff_pool_t pool = { 0 };
+    pool_display_t displays[2] = { 0 };
+    pool_io_t io;
+
+    TEST_ASSERT_TRUE(lvgl_port_buff_pool_add(&pool, &displays[0].user, 1024, 2, 0));
+    TEST_ASSERT_TRUE(lvgl_port_buff_pool_borrow(&pool, &displays[0].user));
+    TEST_ASSERT_FALSE(lvgl_port_buff_pool_borrow(&pool, &displays[0].user));
+
+    pool_io_start(&io, 20000);
+    pool_flush(&io, &displays[0], pool.buffs[0], 1024);
+    TEST_ASSERT_TRUE(lvgl_port_buff_pool_add(&pool, &displays[1].user, 4096, 2, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, io.done);
+    TEST_ASSERT_FALSE(displays[0].user.in_flight);
+    TEST_ASSERT_EQUAL_UINT32(1, pool.waits);
+    TEST_ASSERT_NULL(pool.owner);
+    TEST_ASSERT_EQUAL_UINT32(4096, pool.sizes[0]);
+    TEST_ASSERT_EQUAL_UINT32(4096, pool.sizes[1]);
+    TEST_ASSERT_TRUE(lvgl_port_buff_pool_borrow(&pool, &displays[0].user));
+    pool_io_stop(&io);
+
+    /* Other heap capabilities can't share the buffers */
+    lvgl_port_buff_pool_user_t other = { 0 };
+    TEST_ASSERT_FALSE(lvgl_port_buff_pool_add(&pool, &other, 1024, 1, 1));
+
+    lvgl_port_buff_pool_remove(&pool, &displays[0].user);
+    lvgl_port_buff_pool_remove(&pool, &displays[1].user);
+    TEST_ASSERT_NULL(pool.buffs[0]);
+}
@@ -0,0 +1,223 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_common.h"
+#include "esp_lvgl_port_buff_tune.h"
+
+#define PANEL_W         240
+#define PANEL_H         240
+#define PX_SIZE         2
+#define LINE_BYTES      (PANEL_W * PX_SIZE)
+#define MAX_AREAS       3
+#define WINDOW          16
+#define WINDOWS         40
+
+typedef struct {
+    int32_t x1, y1, x2, y2;
+} test_area_t;
+
+/* Render and flush time of a band: per band overhead [us] and time per pixel [ns] */
+typedef struct {
+    const char  *name;
+    uint32_t    render_band_us;
+    uint32_t    render_px_ns;
+    uint32_t    flush_band_us;
+    uint32_t    flush_px_ns;
+    uint8_t     buffers;
+} test_costs_t;
+
+/* Areas invalidated in a frame: full screen in every 8th frame, otherwise a few random rectangles */
+static int frame_areas(uint32_t *x, int frame, test_area_t *areas)
+{
+    if (frame % 8 == 0) {
+        areas[0] = (test_area_t) {
+            0, 0, PANEL_W - 1, PANEL_H - 1
+        };
+        return 1;
+    }
+
+    const int count = 1 + test_rand_next(x) % MAX_AREAS;
+    for (int i = 0; i < count; i++) {
+        const int32_t w = 16 + test_rand_next(x) % (PANEL_W - 16);
+        const int32_t h = 16 + test_rand_next(x) % (PANEL_H - 16);
+        areas[i].x1 = test_rand_next(x) % (PANEL_W - w + 1);
+        areas[i].y1 = test_rand_next(x) % (PANEL_H - h + 1);
+        areas[i].x2 = areas[i].x1 + w - 1;
+        areas[i].y2 = areas[i].y1 + h - 1;
+    }
+    return count;
+}
+
+/*
+ * Frame time of the areas flushed through draw buffers of the size, by events of the pipeline:
+ * rendering into a buffer waits for its previous flush, a flush waits for the previous one (LVGL waits for flush ready).
+ * Band times are passed to the tuning, when it is set.
+ */
+static uint64_t pipeline_frame_us(const test_costs_t *costs, const test_area_t *areas, int count, uint32_t size,
+                                  lvgl_port_buff_tune_t *tune, uint32_t *x)
+{
+    uint64_t render_end = 0;
+    uint64_t flush_end[2] = {0, 0};
+    int act = 0;
+
+    for (int i = 0; i < count; i++) {
+        const int32_t w = areas[i].x2 - areas[i].x1 + 1;
+        int32_t rows = size / (w * PX_SIZE);
+        rows = (rows ? rows : 1);
+        for (int32_t y = areas[i].y1; y <= areas[i].y2; y += rows) {
+            const int32_t y2 = (y + rows - 1 > areas[i].y2 ? areas[i].y2 : y + rows - 1);
+            const uint64_t px = (uint64_t)w * (y2 - y + 1);
+            /* Measured times are noisy, +-3% */
+            uint64_t render = costs->render_band_us + px * costs->render_px_ns / 1000;
+            uint64_t flush = costs->flush_band_us + px * costs->flush_px_ns / 1000;
+            if (tune) {
+                render = render * (97 + test_rand_next(x) % 7) / 100;
+                flush = flush * (97 + test_rand_next(x) % 7) / 100;
+            }
+
+            /* One buffer: rendering waits for the previous flush, two buffers: for the flush of the same buffer */
+            const uint64_t buff_free = (costs->buffers == 1 ? flush_end[0] : flush_end[act]);
+            const uint64_t render_start = (render_end > buff_free ? render_end : buff_free);
+            render_end = render_start + render;
+            const uint64_t last_flush = (costs->buffers == 1 ? flush_end[0] : flush_end[act ^ 1]);
+            const uint64_t flush_start = (render_end > last_flush ? render_end : last_flush);
+            flush_end[costs->buffers == 1 ? 0 : act] = flush_start + flush;
+            act = (costs->buffers == 1 ? 0 : act ^ 1);
+
+            if (tune) {
+                lvgl_port_buff_tune_add_band(tune, areas[i].x1, y, areas[i].x2, y2, render);
+                lvgl_port_buff_tune_add_flush(tune, px, flush);
+            }
+        }
+    }
+    return (flush_end[0] > flush_end[1] ? flush_end[0] : flush_end[1]);
+}
+
+/* Average frame time of the same frames with a fixed size */
+static uint64_t pipeline_avg_us(const test_costs_t *costs, uint32_t size, int frames)
+{
+    uint32_t x = 5;
+    uint64_t total = 0;
+    test_area_t areas[MAX_AREAS];
+    for (int frame = 0; frame < frames; frame++) {
+        const int count = frame_areas(&x, frame, areas);
+        total += pipeline_frame_us(costs, areas, count, size, NULL, NULL);
+    }
+    return total / frames;
+}
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Functionality test
+
+Purpose:
+    - Test that the tuning chooses a buffer size, whose frame time is close to the best one, with the least memory
+
+Procedure:
+    - Flush frames of random areas through a modelled pipeline of one or two buffers, pass the noisy band times to the tuning
+      and resize the buffer, when the tuning chooses another size
+    - Compare the frame time of the chosen size with the frame times of all candidates on the same frames
+    - The chosen size must be within 10% of the best frame time and no candidate within 3% may be smaller by more than one step
+*/
+TEST_CASE("Buffer tuning functionality", "[buff_tune][functionality]")
+{
+    const test_costs_t cases[] = {
+        /* LVGL has a big overhead per band (many objects), SPI panel */
+        {"render overhead", 1500, 60, 30, 400, 2},
+        {"render overhead", 1500, 60, 30, 400, 1},
+        /* Simple screen, slow transfers: the overhead of a band is small against the transfer */
+        {"flush bound", 40, 60, 30, 400, 2},
+        /* Parallel panel: fast transfers, the flush overhead counts */
+        {"fast bus", 200, 120, 150, 25, 2},
+    };
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        const test_costs_t *costs = &cases[c];
+        lvgl_port_buff_tune_t tune;
+        lvgl_port_buff_tune_init(&tune, PX_SIZE, costs->buffers, LINE_BYTES, 4 * LINE_BYTES, PANEL_H / 2 * LINE_BYTES, 40 * LINE_BYTES, WINDOW);
+        TEST_ASSERT_TRUE(tune.steps > 1 && tune.steps <= LVGL_PORT_BUFF_TUNE_STEPS);
+        TEST_ASSERT_EQUAL_UINT32(4 * LINE_BYTES, tune.sizes[0]);
+        TEST_ASSERT_EQUAL_UINT32(PANEL_H / 2 * LINE_BYTES, tune.sizes[tune.steps - 1]);
+        TEST_ASSERT_TRUE(lvgl_port_buff_tune_get_size(&tune) <= 40 * LINE_BYTES);
+
+        uint32_t x = 1;
+        uint32_t size = lvgl_port_buff_tune_get_size(&tune);
+        uint32_t resizes = 0;
+        test_area_t areas[MAX_AREAS];
+        for (int frame = 0; frame < WINDOW * WINDOWS; frame++) {
+            const int count = frame_areas(&x, frame, areas);
+            pipeline_frame_us(costs, areas, count, size, &tune, &x);
+            const uint32_t new_size = lvgl_port_buff_tune_frame_done(&tune);
+            if (new_size) {
+                TEST_ASSERT_EQUAL_UINT32(new_size, lvgl_port_buff_tune_get_size(&tune));
+                size = new_size;
+                resizes++;
+            }
+        }
+
+        uint64_t best = UINT64_MAX;
+        uint64_t times[LVGL_PORT_BUFF_TUNE_STEPS];
+        for (int i = 0; i < tune.steps; i++) {
+            times[i] = pipeline_avg_us(costs, tune.sizes[i], 64);
+            best = (times[i] < best ? times[i] : best);
+        }
+        const uint64_t chosen = pipeline_avg_us(costs, size, 64);
+        printf("Buffer tuning, %s, %d buffer(s): %"PRIu32" lines, %"PRIu64" us per frame (best %"PRIu64" us), %"PRIu32" resizes\n",
+               costs->name, costs->buffers, size / LINE_BYTES, chosen, best, resizes);
+        for (int i = 0; i < tune.steps; i++) {
+            printf("    %3"PRIu32" lines: %6"PRIu64" us, predicted %6"PRIu32" us\n", tune.sizes[i] / LINE_BYTES, times[i], tune.predicted_us[i]);
+        }
+
+        TEST_ASSERT_TRUE(chosen * 10 <= best * 11);
+        for (int i = 0; i + 1 < tune.current; i++) {
+            TEST_ASSERT_TRUE(times[i] * 100 > best * 103);
+        }
+        TEST_ASSERT_TRUE(tune.stable >= 2);
+    }
+}
+
+/*
+Functionality test
+
+Purpose:
+    - Test that the candidates are limited by the size, which could be allocated
+
+Procedure:
+    - Limit the tuning to a size between candidates and to a size smaller than all candidates
+    - The limited size must be the current and the biggest candidate
+*/
+TEST_CASE("Buffer tuning limit", "[buff_tune][functionality]")
+{
+    lvgl_port_buff_tune_t tune;
+    lvgl_port_buff_tune_init(&tune, PX_SIZE, 2, LINE_BYTES, 10 * LINE_BYTES, 100 * LINE_BYTES, 100 * LINE_BYTES, WINDOW);
+    TEST_ASSERT_EQUAL_UINT32(100 * LINE_BYTES, lvgl_port_buff_tune_get_size(&tune));
+    for (int i = 1; i < tune.steps; i++) {
+        TEST_ASSERT_TRUE(tune.sizes[i] > tune.sizes[i - 1]);
+        TEST_ASSERT_EQUAL_UINT32(0, tune.sizes[i] % LINE_BYTES);
+    }
+
+    lvgl_port_buff_tune_limit(&tune, 33 * LINE_BYTES);
+    TEST_ASSERT_EQUAL_UINT32(33 * LINE_BYTES, lvgl_port_buff_tune_get_size(&tune));
+    TEST_ASSERT_EQUAL_UINT32(33 * LINE_BYTES, tune.sizes[tune.steps - 1]);
+    for (int i = 1; i < tune.steps; i++) {
+        TEST_ASSERT_TRUE(tune.sizes[i] > tune.sizes[i - 1]);
+    }
+
+    lvgl_port_buff_tune_limit(&tune, 5 * LINE_BYTES);
+    TEST_ASSERT_EQUAL_UINT32(1, tune.steps);
+    TEST_ASSERT_EQUAL_UINT32(5 * LINE_BYTES, lvgl_port_buff_tune_get_size(&tune));
+
+    /* One candidate, nothing to choose */
+    lvgl_port_buff_tune_add_band(&tune, 0, 0, PANEL_W - 1, 4, 100);
+    lvgl_port_buff_tune_add_flush(&tune, PANEL_W * 5, 100);
+    TEST_ASSERT_EQUAL_UINT32(0, lvgl_port_buff_tune_frame_done(&tune));
+}
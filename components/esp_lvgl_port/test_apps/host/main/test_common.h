@@ -0,0 +1,89 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Monotonic time in nanoseconds, used by the benchmark tests
+ */
+static inline uint64_t test_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief Sleep until the monotonic time in nanoseconds, used to model time of the target in the host tests
+ */
+static inline void test_sleep_until_ns(uint64_t time_ns)
+{
+    struct timespec ts = {
+        .tv_sec = time_ns / 1000000000ULL,
+        .tv_nsec = time_ns % 1000000000ULL,
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {
+    }
+}
+
+/**
+ * @brief Next pseudo-random value (xorshift32), the state must not be 0
+ */
+static inline uint32_t test_rand_next(uint32_t *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 17;
+    *x ^= *x << 5;
+    return *x;
+}
+
+/**
+ * @brief Fill buffer with pseudo-random bytes (xorshift32, fixed seed)
+ */
+static inline void test_fill_random(void *buf, size_t len, uint32_t seed)
+{
+    uint8_t *p = (uint8_t *)buf;
+    uint32_t x = seed ? seed : 1;
+    for (size_t i = 0; i < len; i++) {
+        p[i] = (uint8_t)test_rand_next(&x);
+    }
+}
+
+/**
+ * @brief Random invalidated area of the screen, end is inclusive
+ *
+ * Mostly small areas (up to 40x40), some of any size, whole screen in 1/16 and full-width rows in 1/16 of the cases.
+ * Areas cross the edges of the screen by up to margin pixels (0: inside of the screen).
+ */
+static inline void test_random_area(uint32_t *x, int32_t hres, int32_t vres, int32_t margin, int32_t *x1, int32_t *y1, int32_t *x2, int32_t *y2)
+{
+    const uint32_t kind = test_rand_next(x) % 16;
+    if (kind == 0) {
+        *x1 = 0;
+        *y1 = 0;
+        *x2 = hres - 1;
+        *y2 = vres - 1;
+        return;
+    }
+    const int32_t w = (kind == 1 ? hres : 1 + (int32_t)(test_rand_next(x) % (kind % 4 ? (hres < 40 ? hres : 40) : hres)));
+    const int32_t h = 1 + (int32_t)(test_rand_next(x) % (kind % 4 ? (vres < 40 ? vres : 40) : vres));
+    *x1 = (kind == 1 ? 0 : (int32_t)(test_rand_next(x) % (hres - w + 1 + 2 * margin)) - margin);
+    *y1 = (int32_t)(test_rand_next(x) % (vres - h + 1 + 2 * margin)) - margin;
+    *x2 = *x1 + w - 1;
+    *y2 = *y1 + h - 1;
+}
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
@@ -0,0 +1,193 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_common.h"
+#include "esp_lvgl_port_copy.h"
+#include "esp_lvgl_port_sync.h"
+
+#define BUF_LEN         (256 * 1024)
+#define BACKLOG         4
+#define MAX_SPANS       512
+#define FRAME_W         480
+#define FRAME_H         320
+#define FRAMES          20
+
+typedef struct {
+    atomic_uint     calls;
+    atomic_uchar    done[MAX_SPANS];
+} copy_done_t;
+
+static copy_done_t copy_done;
+
+static void copy_done_cb(void *user_ctx)
+{
+    atomic_uchar *done = user_ctx;
+    atomic_fetch_add(done, 1);
+    atomic_fetch_add(&copy_done.calls, 1);
+}
+
+static void sync_copy_async(void *dst, const void *src, size_t len, void *user_ctx)
+{
+    lvgl_port_copy_submit((lvgl_port_copy_t *)user_ctx, dst, src, len, NULL, NULL);
+}
+
+static void sync_copy_memcpy(void *dst, const void *src, size_t len, void *user_ctx)
+{
+    memcpy(dst, src, len);
+}
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Functionality test
+
+Purpose:
+    - Test that all queued copies are done once, in the destination, with their callbacks, and that small copies are
+      done by the CPU before the submit returns
+
+Procedure:
+    - Split a buffer into spans of random length (from 1 byte up to several times LVGL_PORT_COPY_MIN_ASYNC_BYTES)
+    - Queue all spans into a copy service with a short backlog (more copies wait for the oldest one), then wait
+    - Destination must be the same as the source, every callback must be called once, statistics must count all bytes
+*/
+TEST_CASE("Async copy functionality", "[copy][functionality]")
+{
+    uint8_t *src = malloc(BUF_LEN);
+    uint8_t *dst = malloc(BUF_LEN);
+    TEST_ASSERT_NOT_NULL(src);
+    TEST_ASSERT_NOT_NULL(dst);
+    test_fill_random(src, BUF_LEN, 5);
+
+    lvgl_port_copy_t *copy = lvgl_port_copy_new(BACKLOG);
+    TEST_ASSERT_NOT_NULL(copy);
+
+    uint32_t x = 3;
+    for (int round = 0; round < 4; round++) {
+        memset(dst, 0, BUF_LEN);
+        memset(&copy_done, 0, sizeof(copy_done));
+
+        uint32_t spans = 0;
+        uint32_t small = 0;
+        size_t small_bytes = 0;
+        size_t pos = 0;
+        while (pos < BUF_LEN) {
+            TEST_ASSERT_TRUE(spans < MAX_SPANS);
+            const uint32_t kind = test_rand_next(&x) % 4;
+            size_t len = (kind == 0 ? 1 + test_rand_next(&x) % LVGL_PORT_COPY_MIN_ASYNC_BYTES : LVGL_PORT_COPY_MIN_ASYNC_BYTES + test_rand_next(&x) % (4 * LVGL_PORT_COPY_MIN_ASYNC_BYTES));
+            len = (pos + len > BUF_LEN ? BUF_LEN - pos : len);
+            lvgl_port_copy_submit(copy, dst + pos, src + pos, len, copy_done_cb, &copy_done.done[spans]);
+            if (len < LVGL_PORT_COPY_MIN_ASYNC_BYTES) {
+                /* CPU copy is done before the submit returns */
+                TEST_ASSERT_EQUAL_UINT8(1, atomic_load(&copy_done.done[spans]));
+                TEST_ASSERT_EQUAL_UINT8_ARRAY(src + pos, dst + pos, len);
+                small++;
+                small_bytes += len;
+            }
+            pos += len;
+            spans++;
+        }
+        lvgl_port_copy_wait(copy);
+
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(src, dst, BUF_LEN);
+        TEST_ASSERT_EQUAL_UINT32(spans, atomic_load(&copy_done.calls));
+        for (uint32_t i = 0; i < spans; i++) {
+            TEST_ASSERT_EQUAL_UINT8(1, atomic_load(&copy_done.done[i]));
+        }
+
+        lvgl_port_copy_stats_t stats;
+        lvgl_port_copy_get_stats(copy, &stats, true);
+        TEST_ASSERT_EQUAL_UINT32(spans, stats.async + stats.cpu);
+        TEST_ASSERT_EQUAL_UINT64(BUF_LEN, stats.async_bytes + stats.cpu_bytes);
+        /* Host build copies in a worker thread, it never falls back to the CPU for bigger copies */
+        TEST_ASSERT_EQUAL_UINT32(small, stats.cpu);
+        TEST_ASSERT_EQUAL_UINT64(small_bytes, stats.cpu_bytes);
+    }
+
+    /* Wait without queued copies returns, delete waits for the queued copies */
+    lvgl_port_copy_wait(copy);
+    memset(dst, 0, BUF_LEN);
+    lvgl_port_copy_submit(copy, dst, src, BUF_LEN, NULL, NULL);
+    lvgl_port_copy_del(copy);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(src, dst, BUF_LEN);
+
+    free(dst);
+    free(src);
+}
+
+/*
+Benchmark test
+
+Purpose:
+    - Compare the time the caller is blocked by the frame buffer sync in direct mode with the CPU copy and with the
+      async copy (queued in the sync, waited for before the next frame is rendered)
+
+Procedure:
+    - Frame of 480x320 RGB565 with random areas (half of them full-width), synchronized by lvgl_port_sync_copy() into the other buffer
+    - CPU: memcpy of each span. Async: spans are queued, the caller waits before the next frame
+    - Both must give the same buffer, the blocked time per frame is printed
+*/
+TEST_CASE("Async copy frame buffer sync benchmark", "[copy][benchmark]")
+{
+    const size_t frame_len = FRAME_W * FRAME_H * sizeof(uint16_t);
+    uint8_t *fbs[3] = {malloc(frame_len), malloc(frame_len), malloc(frame_len)};
+    TEST_ASSERT_NOT_NULL(fbs[0]);
+    TEST_ASSERT_NOT_NULL(fbs[1]);
+    TEST_ASSERT_NOT_NULL(fbs[2]);
+    test_fill_random(fbs[0], frame_len, 9);
+
+    lvgl_port_copy_t *copy = lvgl_port_copy_new(16);
+    TEST_ASSERT_NOT_NULL(copy);
+
+    uint32_t x = 21;
+    uint64_t cpu_ns = 0;
+    uint64_t submit_ns = 0;
+    uint64_t wait_ns = 0;
+    size_t bytes = 0;
+    for (int frame = 0; frame < FRAMES; frame++) {
+        lvgl_port_sync_t sync;
+        lvgl_port_sync_reset(&sync);
+        for (int i = 0; i < 6; i++) {
+            /* Every other area is full-width (e.g. scrolled list), its rows are one span */
+            const int32_t w = (i % 2 ? FRAME_W : 40 + (int32_t)(test_rand_next(&x) % (FRAME_W - 40)));
+            const int32_t h = 10 + test_rand_next(&x) % (FRAME_H / 2);
+            const int32_t x1 = test_rand_next(&x) % (FRAME_W - w + 1);
+            const int32_t y1 = test_rand_next(&x) % (FRAME_H - h + 1);
+            lvgl_port_sync_add_area(&sync, x1, y1, x1 + w - 1, y1 + h - 1);
+        }
+
+        uint64_t start = test_time_ns();
+        bytes += lvgl_port_sync_copy(&sync, fbs[1], fbs[0], FRAME_W, FRAME_H, sizeof(uint16_t), sync_copy_memcpy, NULL);
+        cpu_ns += test_time_ns() - start;
+
+        start = test_time_ns();
+        lvgl_port_sync_copy(&sync, fbs[2], fbs[0], FRAME_W, FRAME_H, sizeof(uint16_t), sync_copy_async, copy);
+        const uint64_t submitted = test_time_ns();
+        submit_ns += submitted - start;
+        /* LVGL renders the next frame here, it waits only before drawing into the buffer */
+        lvgl_port_copy_wait(copy);
+        wait_ns += test_time_ns() - submitted;
+
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(fbs[1], fbs[2], frame_len);
+    }
+
+    lvgl_port_copy_stats_t stats;
+    lvgl_port_copy_get_stats(copy, &stats, false);
+    printf("Async copy, frame buffer sync %dx%d: %zu kB per frame, CPU copy %" PRIu64 " us, async submit %" PRIu64 " us + wait %" PRIu64 " us | %" PRIu64 "%% of bytes in %" PRIu32 " async copies\n",
+           FRAME_W, FRAME_H, bytes / FRAMES / 1024, cpu_ns / FRAMES / 1000, submit_ns / FRAMES / 1000, wait_ns / FRAMES / 1000,
+           stats.async_bytes * 100 / bytes, stats.async);
+    TEST_ASSERT_EQUAL_UINT64(bytes, stats.async_bytes + stats.cpu_bytes);
+
+    lvgl_port_copy_del(copy);
+    free(fbs[2]);
+    free(fbs[1]);
+    free(fbs[0]);
+}
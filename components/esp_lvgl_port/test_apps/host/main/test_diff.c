@@ -0,0 +1,220 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_common.h"
+#include "esp_lvgl_port_diff.h"
+
+/* Width is not a multiple of the segment, to test the short last segment */
+#define PANEL_W         100
+#define PANEL_H         50
+#define PX_SIZE         2
+#define MAX_WINDOWS     4
+#define FLUSH_CYCLES    2000
+
+/* Copy area of the screen into a buffer with stride of the area width, the same as LVGL renders it */
+static void render_area(const uint8_t *screen, uint8_t *buf, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    const size_t len = (x2 - x1 + 1) * PX_SIZE;
+    for (int32_t y = y1; y <= y2; y++) {
+        memcpy(buf + (y - y1) * len, screen + (y * PANEL_W + x1) * PX_SIZE, len);
+    }
+}
+
+/* Simulated panel: draw window pixels at their coordinates */
+static void panel_draw(uint8_t *panel, const lvgl_port_diff_window_t *win)
+{
+    const size_t len = (win->x2 - win->x1 + 1) * PX_SIZE;
+    for (int32_t y = win->y1; y <= win->y2; y++) {
+        memcpy(panel + (y * PANEL_W + win->x1) * PX_SIZE, win->data + (y - win->y1) * len, len);
+    }
+}
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Functionality test
+
+Purpose:
+    - Test that the panel content is the same as the rendered screen, when only the changed windows are sent
+
+Procedure:
+    - Change random rectangles of the screen (some of them to the same values) and flush random areas, rounded to segments or not
+    - Send the windows to a simulated panel and compare the flushed area with the screen
+    - Check, that windows are inside of the area and do not overlap in rows
+    - Flush of an unchanged, rounded area must not give any window
+*/
+TEST_CASE("Diff flush functionality", "[diff][functionality]")
+{
+    const size_t screen_len = PANEL_W * PANEL_H * PX_SIZE;
+    uint8_t *screen = malloc(screen_len);
+    uint8_t *panel = malloc(screen_len);
+    uint8_t *buf = malloc(screen_len);
+    uint32_t *hashes = malloc(lvgl_port_diff_get_hashes_count(PANEL_W, PANEL_H) * sizeof(uint32_t));
+    TEST_ASSERT_NOT_NULL(screen);
+    TEST_ASSERT_NOT_NULL(panel);
+    TEST_ASSERT_NOT_NULL(buf);
+    TEST_ASSERT_NOT_NULL(hashes);
+
+    lvgl_port_diff_t diff = { .hashes = hashes };
+    lvgl_port_diff_reset(&diff, PANEL_W, PANEL_H);
+    test_fill_random(screen, screen_len, 1);
+    memset(panel, 0, screen_len);
+
+    lvgl_port_diff_window_t windows[MAX_WINDOWS];
+    uint32_t x = 7;
+    uint64_t sent_px = 0;
+    uint64_t area_px = 0;
+
+    for (int i = 0; i < FLUSH_CYCLES; i++) {
+        /* Change a small rectangle, sometimes with the same values */
+        if (test_rand_next(&x) % 4) {
+            const int32_t cx = test_rand_next(&x) % PANEL_W;
+            const int32_t cy = test_rand_next(&x) % PANEL_H;
+            const int32_t cw = 1 + test_rand_next(&x) % 8;
+            const uint8_t value = (test_rand_next(&x) % 2) ? (uint8_t)test_rand_next(&x) : screen[(cy * PANEL_W + cx) * PX_SIZE];
+            for (int32_t y = cy; y < cy + 3 && y < PANEL_H; y++) {
+                for (int32_t xx = cx; xx < cx + cw && xx < PANEL_W; xx++) {
+                    memset(screen + (y * PANEL_W + xx) * PX_SIZE, value, PX_SIZE);
+                }
+            }
+        }
+
+        int32_t x1 = test_rand_next(&x) % PANEL_W;
+        int32_t x2 = x1 + test_rand_next(&x) % (PANEL_W - x1);
+        const int32_t y1 = test_rand_next(&x) % PANEL_H;
+        const int32_t y2 = y1 + test_rand_next(&x) % (PANEL_H - y1);
+        if (test_rand_next(&x) % 4) {
+            lvgl_port_diff_round_area(&diff, &x1, &x2);
+        }
+        const uint32_t max_windows = 1 + test_rand_next(&x) % MAX_WINDOWS;
+
+        render_area(screen, buf, x1, y1, x2, y2);
+        const uint32_t count = lvgl_port_diff_area(&diff, buf, PX_SIZE, x1, y1, x2, y2, windows, max_windows);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(max_windows, count);
+
+        int32_t prev_y2 = y1 - 1;
+        for (uint32_t w = 0; w < count; w++) {
+            TEST_ASSERT_TRUE(windows[w].x1 >= x1 && windows[w].x2 <= x2 && windows[w].x1 <= windows[w].x2);
+            TEST_ASSERT_TRUE(windows[w].y1 > prev_y2 && windows[w].y2 <= y2 && windows[w].y1 <= windows[w].y2);
+            prev_y2 = windows[w].y2;
+            panel_draw(panel, &windows[w]);
+            sent_px += (windows[w].x2 - windows[w].x1 + 1) * (windows[w].y2 - windows[w].y1 + 1);
+        }
+        area_px += (x2 - x1 + 1) * (y2 - y1 + 1);
+
+        for (int32_t y = y1; y <= y2; y++) {
+            if (memcmp(panel + (y * PANEL_W + x1) * PX_SIZE, screen + (y * PANEL_W + x1) * PX_SIZE, (x2 - x1 + 1) * PX_SIZE) != 0) {
+                printf("Mismatch: cycle %d, area %"PRIi32",%"PRIi32" %"PRIi32",%"PRIi32", row %"PRIi32"\n", i, x1, y1, x2, y2, y);
+            }
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(screen + (y * PANEL_W + x1) * PX_SIZE, panel + (y * PANEL_W + x1) * PX_SIZE, (x2 - x1 + 1) * PX_SIZE);
+        }
+    }
+    printf("Diff flush: sent %"PRIu64" of %"PRIu64" px\n", sent_px, area_px);
+
+    /* Whole screen is known now, flush of the same content sends nothing */
+    render_area(screen, buf, 0, 0, PANEL_W - 1, PANEL_H - 1);
+    lvgl_port_diff_area(&diff, buf, PX_SIZE, 0, 0, PANEL_W - 1, PANEL_H - 1, windows, MAX_WINDOWS);
+    render_area(screen, buf, 0, 0, PANEL_W - 1, PANEL_H - 1);
+    TEST_ASSERT_EQUAL_UINT32(0, lvgl_port_diff_area(&diff, buf, PX_SIZE, 0, 0, PANEL_W - 1, PANEL_H - 1, windows, MAX_WINDOWS));
+
+    /* One changed pixel gives one window of its segment and row */
+    screen[(10 * PANEL_W + 97) * PX_SIZE] ^= 0xFF;
+    render_area(screen, buf, 0, 0, PANEL_W - 1, PANEL_H - 1);
+    TEST_ASSERT_EQUAL_UINT32(1, lvgl_port_diff_area(&diff, buf, PX_SIZE, 0, 0, PANEL_W - 1, PANEL_H - 1, windows, MAX_WINDOWS));
+    TEST_ASSERT_EQUAL_INT32(96, windows[0].x1);
+    TEST_ASSERT_EQUAL_INT32(PANEL_W - 1, windows[0].x2);
+    TEST_ASSERT_EQUAL_INT32(10, windows[0].y1);
+    TEST_ASSERT_EQUAL_INT32(10, windows[0].y2);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(screen + (10 * PANEL_W + 96) * PX_SIZE, windows[0].data, 4 * PX_SIZE);
+
+    /* Unknown content after reset */
+    lvgl_port_diff_reset(&diff, PANEL_H, PANEL_W);
+    render_area(screen, buf, 0, 0, PANEL_H - 1, 0);
+    TEST_ASSERT_EQUAL_UINT32(1, lvgl_port_diff_area(&diff, buf, PX_SIZE, 0, 0, PANEL_H - 1, 0, windows, MAX_WINDOWS));
+
+    free(screen);
+    free(panel);
+    free(buf);
+    free(hashes);
+}
+
+/*
+Functionality test
+
+Purpose:
+    - Test that the monochrome OLED pages on the panel are the same as the rendered ones, when only the changed spans are sent
+
+Procedure:
+    - Change random bytes of 128x64 pages (8 pages) and send the spans to a simulated panel, with a small and a big spans array
+    - Compare the panel with the pages, check that spans are in one page or are whole pages
+    - Pages without change must not give any span
+*/
+TEST_CASE("Diff flush pages functionality", "[diff][functionality]")
+{
+    const uint32_t width = 128;
+    const uint32_t page_count = 8;
+    const size_t len = width * page_count;
+    uint8_t *pages = malloc(len);
+    uint8_t *sent = malloc(len);
+    uint8_t *panel = malloc(len);
+    TEST_ASSERT_NOT_NULL(pages);
+    TEST_ASSERT_NOT_NULL(sent);
+    TEST_ASSERT_NOT_NULL(panel);
+
+    /* Copy of sent pages is the same as the panel content */
+    test_fill_random(pages, len, 5);
+    memcpy(sent, pages, len);
+    memcpy(panel, pages, len);
+
+    lvgl_port_diff_window_t spans[16];
+    uint32_t x = 11;
+    uint64_t sent_bytes = 0;
+
+    for (int i = 0; i < FLUSH_CYCLES; i++) {
+        const uint32_t changes = test_rand_next(&x) % 24;
+        for (uint32_t c = 0; c < changes; c++) {
+            pages[test_rand_next(&x) % len] = (uint8_t)test_rand_next(&x);
+        }
+        const uint32_t max_spans = (i % 2) ? 16 : 1 + test_rand_next(&x) % 3;
+
+        const uint32_t count = lvgl_port_diff_pages(sent, pages, width, page_count, spans, max_spans);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(max_spans, count);
+        for (uint32_t s = 0; s < count; s++) {
+            const lvgl_port_diff_window_t *span = &spans[s];
+            const uint32_t span_w = span->x2 - span->x1 + 1;
+            const uint32_t span_pages = (span->y2 - span->y1 + 1) / 8;
+            TEST_ASSERT_TRUE(span->y1 % 8 == 0 && (span->y2 + 1) % 8 == 0);
+            TEST_ASSERT_TRUE(span_pages == 1 || span_w == width);
+            for (uint32_t p = 0; p < span_pages; p++) {
+                memcpy(panel + (span->y1 / 8 + p) * width + span->x1, span->data + p * span_w, span_w);
+            }
+            sent_bytes += span_w * span_pages;
+        }
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(pages, panel, len);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(pages, sent, len);
+    }
+    printf("Diff flush pages: sent %"PRIu64" of %"PRIu64" bytes\n", sent_bytes, (uint64_t)FLUSH_CYCLES * len);
+
+    TEST_ASSERT_EQUAL_UINT32(0, lvgl_port_diff_pages(sent, pages, width, page_count, spans, 16));
+
+    /* Two changes closer than the gap are one span */
+    pages[3 * width + 10] ^= 0x01;
+    pages[3 * width + 10 + LVGL_PORT_DIFF_PAGE_GAP] ^= 0x80;
+    TEST_ASSERT_EQUAL_UINT32(1, lvgl_port_diff_pages(sent, pages, width, page_count, spans, 16));
+    TEST_ASSERT_EQUAL_INT32(10, spans[0].x1);
+    TEST_ASSERT_EQUAL_INT32(10 + LVGL_PORT_DIFF_PAGE_GAP, spans[0].x2);
+    TEST_ASSERT_EQUAL_INT32(24, spans[0].y1);
+    TEST_ASSERT_EQUAL_INT32(31, spans[0].y2);
+
+    free(pages);
+    free(sent);
+    free(panel);
+}
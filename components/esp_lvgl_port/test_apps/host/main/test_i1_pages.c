@@ -0,0 +1,158 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_common.h"
+#include "esp_lvgl_port_color.h"
+
+#define MAX_RES         48
+#define BENCH_W         128
+#define BENCH_H         64
+#define BENCH_CYCLES    2000
+
+// ------------------------------------------------ Reference ----------------------------------------------------------
+
+/*
+ * Reference: I1 path of _lvgl_port_transform_monochrome() from esp_lvgl_port_disp.c (LVGL 9),
+ * with LVGL display getters replaced by parameters. The palette is already skipped in src.
+ */
+static void ref_transform_monochrome(const uint8_t *src, uint8_t *color_map, uint16_t hor_res, uint16_t ver_res, bool swap_xy,
+                                     int x1, int y1, int x2, int y2)
+{
+    uint16_t res = hor_res;
+    int out_x, out_y;
+    for (int y = y1; y <= y2; y++) {
+        for (int x = x1; x <= x2; x++) {
+            bool chroma_color = (src[(hor_res >> 3) * y  + (x >> 3)] & 1 << (7 - x % 8));
+
+            if (swap_xy) {
+                out_x = y;
+                out_y = x;
+                res = ver_res;
+            } else {
+                out_x = x;
+                out_y = y;
+                res = hor_res;
+            }
+
+            uint8_t *outbuf = NULL;
+            outbuf = color_map + res * (out_y >> 3) + (out_x);
+            if (chroma_color) {
+                (*outbuf) &= ~(1 << (out_y % 8));
+            } else {
+                (*outbuf) |= (1 << (out_y % 8));
+            }
+        }
+    }
+}
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Functionality test
+
+Purpose:
+    - Test that the block kernel gives the same pages as the existing per-pixel transform
+
+Procedure:
+    - For resolutions (multiples of 8) up to MAX_RES x MAX_RES, generate random I1 screens and random output pages
+    - Convert the whole screen and random areas (not aligned to 8) with and without swap_xy
+    - Compare the whole output buffers, pixels out of the area must be kept
+*/
+TEST_CASE("I1 to pages functionality", "[i1][functionality]")
+{
+    const size_t len = MAX_RES * MAX_RES / 8 + 16;
+    uint8_t *src = malloc(len);
+    uint8_t *ref = malloc(len);
+    uint8_t *dut = malloc(len);
+    TEST_ASSERT_NOT_NULL(src);
+    TEST_ASSERT_NOT_NULL(ref);
+    TEST_ASSERT_NOT_NULL(dut);
+
+    uint32_t r = 3;
+    unsigned int combinations = 0;
+    for (uint16_t hor_res = 8; hor_res <= MAX_RES; hor_res += 8) {
+        for (uint16_t ver_res = 8; ver_res <= MAX_RES; ver_res += 8) {
+            for (int swap_xy = 0; swap_xy <= 1; swap_xy++) {
+                for (int i = 0; i < 20; i++) {
+                    int x1 = 0;
+                    int y1 = 0;
+                    int x2 = hor_res - 1;
+                    int y2 = ver_res - 1;
+                    if (i > 0) {
+                        x1 = test_rand_next(&r) % hor_res;
+                        x2 = x1 + test_rand_next(&r) % (hor_res - x1);
+                        y1 = test_rand_next(&r) % ver_res;
+                        y2 = y1 + test_rand_next(&r) % (ver_res - y1);
+                    }
+                    test_fill_random(src, len, test_rand_next(&r));
+                    test_fill_random(ref, len, i + 1);
+                    memcpy(dut, ref, len);
+
+                    ref_transform_monochrome(src, ref, hor_res, ver_res, swap_xy, x1, y1, x2, y2);
+                    lvgl_port_i1_to_pages(src, hor_res >> 3, dut, swap_xy ? ver_res : hor_res, x1, y1, x2, y2, swap_xy);
+
+                    if (memcmp(ref, dut, len) != 0) {
+                        printf("Mismatch: %dx%d, area %d,%d %d,%d, swap_xy %d\n", hor_res, ver_res, x1, y1, x2, y2, swap_xy);
+                    }
+                    TEST_ASSERT_EQUAL_UINT8_ARRAY(ref, dut, len);
+                    combinations++;
+                }
+            }
+        }
+    }
+    printf("I1 to pages: test combinations: %u\n", combinations);
+
+    free(src);
+    free(ref);
+    free(dut);
+}
+
+/*
+Benchmark test
+
+Purpose:
+    - Compare the block kernel with the existing per-pixel transform on a 128x64 SSD1306 screen
+
+Procedure:
+    - Convert the whole screen BENCH_CYCLES times with each variant, with and without swap_xy, and print time per frame
+*/
+TEST_CASE("I1 to pages benchmark", "[i1][benchmark]")
+{
+    const size_t len = BENCH_W * BENCH_H / 8;
+    uint8_t *src = malloc(len);
+    uint8_t *dst = malloc(len);
+    TEST_ASSERT_NOT_NULL(src);
+    TEST_ASSERT_NOT_NULL(dst);
+    test_fill_random(src, len, 1);
+
+    for (int swap_xy = 0; swap_xy <= 1; swap_xy++) {
+        /* With swap_xy, the screen is rotated */
+        const uint16_t hor_res = swap_xy ? BENCH_H : BENCH_W;
+        const uint16_t ver_res = swap_xy ? BENCH_W : BENCH_H;
+
+        uint64_t start = test_time_ns();
+        for (int i = 0; i < BENCH_CYCLES; i++) {
+            ref_transform_monochrome(src, dst, hor_res, ver_res, swap_xy, 0, 0, hor_res - 1, ver_res - 1);
+        }
+        const double ref_ns = (double)(test_time_ns() - start) / BENCH_CYCLES;
+
+        start = test_time_ns();
+        for (int i = 0; i < BENCH_CYCLES; i++) {
+            lvgl_port_i1_to_pages(src, hor_res >> 3, dst, swap_xy ? ver_res : hor_res, 0, 0, hor_res - 1, ver_res - 1, swap_xy);
+        }
+        const double dut_ns = (double)(test_time_ns() - start) / BENCH_CYCLES;
+
+        printf("I1 to pages %dx%d, swap_xy %d: per pixel: %.0f ns, blocks: %.0f ns\n", hor_res, ver_res, swap_xy, ref_ns, dut_ns);
+    }
+
+    free(src);
+    free(dst);
+}
@@ -0,0 +1,201 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include "unity.h"
+#include "test_common.h"
+#include "esp_lvgl_port_merge.h"
+
+#define SCREEN_W        240
+#define SCREEN_H        320
+#define PX_SIZE         2
+#define BUFF_LINES      40
+#define FRAMES          2000
+#define FRAME_AREAS     24
+
+static void merge_init(lvgl_port_merge_t *merge)
+{
+    /* 40 MHz SPI, CASET, RASET and RAMWR with the transfer setup */
+    merge->trans_overhead_us = 20;
+    merge->bytes_per_us = 5;
+    merge->px_size = PX_SIZE;
+    merge->buff_bytes = SCREEN_W * BUFF_LINES * PX_SIZE;
+    lvgl_port_merge_reset(merge);
+}
+
+static bool area_is_in(const lvgl_port_merge_area_t *in, const lvgl_port_merge_area_t *holder)
+{
+    return (in->x1 >= holder->x1 && in->y1 >= holder->y1 && in->x2 <= holder->x2 && in->y2 <= holder->y2);
+}
+
+/* LVGL keeps the invalidated area, when it is not inside of a kept one */
+static void lvgl_inv_area(lvgl_port_merge_area_t *areas, uint32_t *count, const lvgl_port_merge_area_t *area)
+{
+    for (uint32_t i = 0; i < *count; i++) {
+        if (area_is_in(area, &areas[i])) {
+            return;
+        }
+    }
+    TEST_ASSERT_TRUE(*count < LVGL_PORT_MERGE_AREAS_MAX);
+    areas[(*count)++] = *area;
+}
+
+static uint64_t areas_cost(const lvgl_port_merge_t *merge, const lvgl_port_merge_area_t *areas, uint32_t count, uint32_t *trans)
+{
+    uint64_t cost = 0;
+    *trans = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t area_trans;
+        cost += lvgl_port_merge_area_cost(merge, &areas[i], &area_trans);
+        *trans += area_trans;
+    }
+    return cost;
+}
+
+/*
+Functionality test
+
+Purpose:
+    - Test that the merged areas cover all invalidated areas and don't cost more than the areas without merging
+
+Procedure:
+    - Invalidate random areas of frames of a 240x320 RGB565 screen with a draw buffer of 40 lines, once through
+      the merging and once without it, the invalidated areas are kept as LVGL keeps them
+    - Each invalidated area must be inside of an area kept by LVGL and inside of an area of the frame after merging
+    - Areas of the frame after merging must not cost more than the areas kept by LVGL without merging
+*/
+TEST_CASE("Merge areas by flush cost", "[merge][functionality]")
+{
+    lvgl_port_merge_t merge;
+    merge_init(&merge);
+    uint32_t x = 0x2545F491;
+    uint64_t cost_merged = 0;
+    uint64_t cost_unmerged = 0;
+    uint32_t trans_merged = 0;
+    uint32_t trans_unmerged = 0;
+    uint32_t merged_areas = 0;
+    uint32_t trans_saved = 0;
+
+    for (int f = 0; f < FRAMES; f++) {
+        lvgl_port_merge_area_t inv[FRAME_AREAS];
+        lvgl_port_merge_area_t kept[LVGL_PORT_MERGE_AREAS_MAX];
+        lvgl_port_merge_area_t kept_unmerged[LVGL_PORT_MERGE_AREAS_MAX];
+        uint32_t kept_count = 0;
+        uint32_t kept_unmerged_count = 0;
+        const uint32_t count = 1 + test_rand_next(&x) % FRAME_AREAS;
+
+        lvgl_port_merge_reset(&merge);
+        for (uint32_t i = 0; i < count; i++) {
+            test_random_area(&x, SCREEN_W, SCREEN_H, 0, &inv[i].x1, &inv[i].y1, &inv[i].x2, &inv[i].y2);
+            lvgl_inv_area(kept_unmerged, &kept_unmerged_count, &inv[i]);
+
+            lvgl_port_merge_area_t area = inv[i];
+            merged_areas += lvgl_port_merge_area(&merge, &area, &trans_saved);
+            TEST_ASSERT_TRUE(area_is_in(&inv[i], &area));
+            TEST_ASSERT_TRUE(area.x1 >= 0 && area.y1 >= 0 && area.x2 < SCREEN_W && area.y2 < SCREEN_H);
+            lvgl_inv_area(kept, &kept_count, &area);
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            bool in_kept = false;
+            bool in_merged = false;
+            for (uint32_t k = 0; k < kept_count; k++) {
+                in_kept |= area_is_in(&inv[i], &kept[k]);
+            }
+            for (uint32_t k = 0; k < merge.count; k++) {
+                in_merged |= area_is_in(&inv[i], &merge.areas[k]);
+            }
+            TEST_ASSERT_TRUE(in_kept);
+            TEST_ASSERT_TRUE(in_merged);
+        }
+
+        uint32_t frame_trans_merged;
+        uint32_t frame_trans_unmerged;
+        const uint64_t frame_cost_merged = areas_cost(&merge, merge.areas, merge.count, &frame_trans_merged);
+        const uint64_t frame_cost_unmerged = areas_cost(&merge, kept_unmerged, kept_unmerged_count, &frame_trans_unmerged);
+        TEST_ASSERT_TRUE(frame_cost_merged <= frame_cost_unmerged);
+        cost_merged += frame_cost_merged;
+        cost_unmerged += frame_cost_unmerged;
+        trans_merged += frame_trans_merged;
+        trans_unmerged += frame_trans_unmerged;
+    }
+
+    printf("Area merging %dx%d, %d frames: %"PRIu32" transactions in %"PRIu64" us merged, %"PRIu32" in %"PRIu64" us unmerged | %"PRIu32" merged areas, %"PRIu32" saved\n",
+           SCREEN_W, SCREEN_H, FRAMES, trans_merged, cost_merged / 1000, trans_unmerged, cost_unmerged / 1000, merged_areas, trans_saved);
+    TEST_ASSERT_TRUE(merged_areas > 0 && trans_saved > 0);
+    TEST_ASSERT_TRUE(cost_merged < cost_unmerged);
+}
+
+/*
+Functionality test
+
+Purpose:
+    - Test that the areas, which LVGL would join anyway, are merged but not counted in the saved transactions
+
+Procedure:
+    - New area containing an area of the frame: merged into the new area, nothing is counted
+    - New area next to an area of the frame (one band after merging): one merged area, one saved transaction
+    - New area containing a small area and next to another one: both are merged, only the second one is counted
+    - New area inside of an area of the frame: not changed and not remembered
+*/
+TEST_CASE("Merge areas counts only areas LVGL would not join", "[merge][functionality]")
+{
+    lvgl_port_merge_t merge;
+    merge_init(&merge);
+    uint32_t trans_saved = 0;
+    uint32_t trans;
+
+    /* A band of the draw buffer is one transaction */
+    const lvgl_port_merge_area_t band = {0, 0, SCREEN_W - 1, BUFF_LINES - 1};
+    lvgl_port_merge_area_cost(&merge, &band, &trans);
+    TEST_ASSERT_EQUAL_UINT32(1, trans);
+    const lvgl_port_merge_area_t screen = {0, 0, SCREEN_W - 1, SCREEN_H - 1};
+    lvgl_port_merge_area_cost(&merge, &screen, &trans);
+    TEST_ASSERT_EQUAL_UINT32(SCREEN_H / BUFF_LINES, trans);
+
+    /* Area inside of the new one */
+    lvgl_port_merge_area_t small = {10, 10, 19, 19};
+    TEST_ASSERT_EQUAL_UINT32(0, lvgl_port_merge_area(&merge, &small, &trans_saved));
+    lvgl_port_merge_area_t area = band;
+    TEST_ASSERT_EQUAL_UINT32(0, lvgl_port_merge_area(&merge, &area, &trans_saved));
+    TEST_ASSERT_EQUAL_MEMORY(&band, &area, sizeof(area));
+    TEST_ASSERT_EQUAL_UINT32(0, trans_saved);
+    TEST_ASSERT_EQUAL_UINT32(1, merge.count);
+
+    /* Area next to the new one */
+    lvgl_port_merge_reset(&merge);
+    lvgl_port_merge_area_t top = {0, 0, SCREEN_W - 1, 3};
+    TEST_ASSERT_EQUAL_UINT32(0, lvgl_port_merge_area(&merge, &top, &trans_saved));
+    area = (lvgl_port_merge_area_t) {0, 4, SCREEN_W - 1, 7};
+    TEST_ASSERT_EQUAL_UINT32(1, lvgl_port_merge_area(&merge, &area, &trans_saved));
+    TEST_ASSERT_EQUAL_INT32(0, area.y1);
+    TEST_ASSERT_EQUAL_INT32(7, area.y2);
+    TEST_ASSERT_EQUAL_UINT32(1, trans_saved);
+    TEST_ASSERT_EQUAL_UINT32(1, merge.count);
+
+    /* Both: the small area is merged first (bigger saving), only the area next to the new one is counted */
+    lvgl_port_merge_reset(&merge);
+    trans_saved = 0;
+    TEST_ASSERT_EQUAL_UINT32(0, lvgl_port_merge_area(&merge, &top, &trans_saved));
+    small = (lvgl_port_merge_area_t) {100, 5, 110, 6};
+    TEST_ASSERT_EQUAL_UINT32(0, lvgl_port_merge_area(&merge, &small, &trans_saved));
+    TEST_ASSERT_EQUAL_UINT32(2, merge.count);
+    area = (lvgl_port_merge_area_t) {0, 4, SCREEN_W - 1, 7};
+    TEST_ASSERT_EQUAL_UINT32(1, lvgl_port_merge_area(&merge, &area, &trans_saved));
+    TEST_ASSERT_EQUAL_INT32(0, area.y1);
+    TEST_ASSERT_EQUAL_INT32(7, area.y2);
+    TEST_ASSERT_EQUAL_UINT32(1, trans_saved);
+    TEST_ASSERT_EQUAL_UINT32(1, merge.count);
+
+    /* Already invalidated */
+    small = (lvgl_port_merge_area_t) {10, 1, 19, 2};
+    TEST_ASSERT_EQUAL_UINT32(0, lvgl_port_merge_area(&merge, &small, &trans_saved));
+    TEST_ASSERT_EQUAL_INT32(10, small.x1);
+    TEST_ASSERT_EQUAL_INT32(2, small.y2);
+    TEST_ASSERT_EQUAL_UINT32(1, trans_saved);
+    TEST_ASSERT_EQUAL_UINT32(1, merge.count);
+}
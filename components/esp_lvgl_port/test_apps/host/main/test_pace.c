@@ -0,0 +1,182 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "unity.h"
+#include "test_common.h"
+#include "esp_lvgl_port_pace.h"
+
+#define PERIOD_US       33333   /* 30 FPS */
+#define TICK_US         1000    /* RTOS tick, the task sleeps whole ticks */
+#define FRAMES          600
+#define EVENTS          400
+
+/* The task sleeps whole ticks and wakes on the next tick boundary after the wait */
+static int64_t sleep_ticks(int64_t now_us, uint32_t wait_us)
+{
+    const int64_t wake = now_us + wait_us;
+    return (wake + TICK_US - 1) / TICK_US * TICK_US;
+}
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Functionality test
+
+Purpose:
+    - Test that an animation, which refreshes every frame, is refreshed on a fixed cadence and that the late frames
+      skip whole periods instead of catching up
+
+Procedure:
+    - Run the frames on a simulated clock with tick-sized sleeps, frame work takes 5..15 ms and 50 ms in every 20th frame
+    - Every frame must start within one tick after a period boundary, late frames and skipped periods must be counted
+    - Intervals of frames in time are the period, the statistics must show the average and deviation of all intervals
+*/
+TEST_CASE("Frame pacing functionality", "[pace][functionality]")
+{
+    lvgl_port_pace_t pace;
+    const int64_t t0 = 1000000;
+    lvgl_port_pace_init(&pace, PERIOD_US, t0);
+
+    uint32_t x = 9;
+    int64_t now = t0;
+    uint32_t late = 0;
+    uint32_t missed = 0;
+    double sum = 0;
+    double sq_sum = 0;
+    int64_t last_start = 0;
+    for (int frame = 0; frame < FRAMES; frame++) {
+        now = sleep_ticks(now, lvgl_port_pace_get_wait(&pace, now));
+        TEST_ASSERT_EQUAL_UINT32(0, lvgl_port_pace_get_wait(&pace, now));
+        TEST_ASSERT_TRUE((now - t0) % PERIOD_US < TICK_US);
+        if (frame) {
+            sum += (double)(now - last_start);
+            sq_sum += (double)(now - last_start) * (now - last_start);
+        }
+        last_start = now;
+
+        lvgl_port_pace_frame_start(&pace, now, true);
+        const uint32_t work = (frame % 20 == 19 ? 50000 : 5000 + test_rand_next(&x) % 10000);
+        if (work > PERIOD_US - TICK_US) {
+            late++;
+            missed += 1;
+        }
+        now += work;
+        lvgl_port_pace_frame_end(&pace, now);
+    }
+
+    lvgl_port_pace_stats_t stats;
+    lvgl_port_pace_get_stats(&pace, now, &stats);
+    printf("Frame pacing %"PRIu32" us: %"PRIu32" frames, %"PRIu32" late, %"PRIu32" missed | interval %"PRIu32" +- %"PRIu32" us | slack min %"PRIu32" us, avg %"PRIu64" us\n",
+           (uint32_t)PERIOD_US, stats.frames, stats.late, stats.missed, stats.interval_avg_us, stats.interval_dev_us,
+           stats.slack_min_us, stats.slack_us / (stats.frames - stats.late));
+    TEST_ASSERT_EQUAL_UINT32(FRAMES, stats.frames);
+    TEST_ASSERT_EQUAL_UINT32(late, stats.late);
+    TEST_ASSERT_EQUAL_UINT32(missed, stats.missed);
+    TEST_ASSERT_EQUAL_UINT32(FRAMES - 1, stats.intervals);
+    TEST_ASSERT_EQUAL_UINT32(50000, stats.work_max_us);
+    TEST_ASSERT_TRUE(stats.slack_min_us >= PERIOD_US - 15000 - TICK_US);
+    TEST_ASSERT_EQUAL_UINT64(now - t0, stats.elapsed_us);
+
+    const double mean = sum / (FRAMES - 1);
+    const double dev = sqrt(sq_sum / (FRAMES - 1) - mean * mean);
+    TEST_ASSERT_INT32_WITHIN(1, (int32_t)(mean + 0.5), stats.interval_avg_us);
+    TEST_ASSERT_INT32_WITHIN(1, (int32_t)(dev + 0.5), stats.interval_dev_us);
+
+    /* Without the late frames, the cadence doesn't vary by more than a tick (idle first, the row starts again) */
+    now += 3 * PERIOD_US;
+    lvgl_port_pace_reset_stats(&pace, now);
+    for (int frame = 0; frame < FRAMES; frame++) {
+        now = sleep_ticks(now, lvgl_port_pace_get_wait(&pace, now));
+        lvgl_port_pace_frame_start(&pace, now, true);
+        now += 5000 + test_rand_next(&x) % 10000;
+        lvgl_port_pace_frame_end(&pace, now);
+    }
+    lvgl_port_pace_get_stats(&pace, now, &stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.late);
+    TEST_ASSERT_INT32_WITHIN(TICK_US / 100, PERIOD_US, stats.interval_avg_us);
+    TEST_ASSERT_TRUE(stats.interval_dev_us < TICK_US);
+}
+
+/*
+Functionality test
+
+Purpose:
+    - Test that invalidations between two frame starts are coalesced into one frame and that the cadence starts again
+      after an idle time
+
+Procedure:
+    - Invalidations come at random times, in bursts and with idle times of several periods
+    - The task wakes on every invalidation, a frame starts only when the pacing doesn't ask for a wait
+    - Refreshed frames must never start closer than one period, every invalidation must be refreshed by a frame starting
+      at most one period and one tick later
+    - Only the refreshed frames in a row are measured
+*/
+TEST_CASE("Frame pacing coalesces invalidations", "[pace][functionality]")
+{
+    lvgl_port_pace_t pace;
+    lvgl_port_pace_init(&pace, PERIOD_US, 0);
+    TEST_ASSERT_EQUAL_UINT32(0, lvgl_port_pace_get_wait(&pace, 0));
+
+    uint32_t x = 11;
+    int64_t now = 0;
+    int64_t event = 0;
+    int64_t pending = -1;   /* Time of the first invalidation, which was not refreshed yet */
+    int64_t last_refresh = -PERIOD_US;
+    uint32_t refreshed = 0;
+    for (int i = 0; i < EVENTS; i++) {
+        /* Bursts of invalidations, sometimes idle for a few periods */
+        const uint32_t kind = test_rand_next(&x) % 8;
+        event += (kind == 0 ? 3 * PERIOD_US + test_rand_next(&x) % (5 * PERIOD_US) : test_rand_next(&x) % (PERIOD_US / 2));
+
+        /* The task sleeps until the frame or the invalidation */
+        while (now < event) {
+            const uint32_t wait = lvgl_port_pace_get_wait(&pace, now);
+            if (pending < 0 || wait > 0) {
+                const int64_t wake = sleep_ticks(now, wait);
+                now = (pending < 0 || wake > event ? event : wake);
+                continue;
+            }
+            /* Frame */
+            TEST_ASSERT_TRUE(now - last_refresh >= PERIOD_US - TICK_US);
+            TEST_ASSERT_TRUE(now - pending <= PERIOD_US + TICK_US);
+            lvgl_port_pace_frame_start(&pace, now, true);
+            last_refresh = now;
+            pending = -1;
+            refreshed++;
+            now += 2000 + test_rand_next(&x) % 4000;
+            lvgl_port_pace_frame_end(&pace, now);
+        }
+        pending = (pending < 0 ? now : pending);
+    }
+
+    lvgl_port_pace_stats_t stats;
+    lvgl_port_pace_get_stats(&pace, now, &stats);
+    printf("Frame pacing: %d invalidations refreshed in %"PRIu32" frames, %"PRIu32" intervals of %"PRIu32" +- %"PRIu32" us\n",
+           EVENTS, refreshed, stats.intervals, stats.interval_avg_us, stats.interval_dev_us);
+    TEST_ASSERT_EQUAL_UINT32(refreshed, stats.frames);
+    TEST_ASSERT_TRUE(refreshed < EVENTS);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.late);
+    TEST_ASSERT_TRUE(stats.intervals > 0 && stats.intervals < refreshed);
+    TEST_ASSERT_INT32_WITHIN(TICK_US, PERIOD_US, stats.interval_avg_us);
+
+    /* Frames without invalidations keep the cadence, but they are not measured and break the row */
+    lvgl_port_pace_reset_stats(&pace, now);
+    now = sleep_ticks(now, lvgl_port_pace_get_wait(&pace, now) + 3 * PERIOD_US);
+    const bool refresh[] = {true, false, true, true};
+    for (size_t i = 0; i < sizeof(refresh) / sizeof(refresh[0]); i++) {
+        lvgl_port_pace_frame_start(&pace, now, refresh[i]);
+        now += 1000;
+        lvgl_port_pace_frame_end(&pace, now);
+        now = sleep_ticks(now, lvgl_port_pace_get_wait(&pace, now));
+    }
+    lvgl_port_pace_get_stats(&pace, now, &stats);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.frames);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.intervals);
+}
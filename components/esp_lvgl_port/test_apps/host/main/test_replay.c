@@ -0,0 +1,171 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "unity.h"
+#include "esp_lvgl_port_rand.h"
+#include "esp_lvgl_port_replay.h"
+
+#define SAMPLES         300000
+#define CYCLES          1000
+
+/* LVGL task cycle of the modeled application: LVGL tick and the random values taken by the animations */
+typedef struct {
+    uint32_t    tick;
+    uint32_t    value;
+} app_cycle_t;
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Functionality test
+
+Purpose:
+    - Test that the pseudo-random generator gives the same PCG32 sequence for the same seed on every platform
+
+Procedure:
+    - Seed 42: the first values must be the PCG32 (XSH RR, 64-bit state, default increment) reference values
+    - Seeding again restarts the sequence, other seed gives other values
+*/
+TEST_CASE("Pseudo-random generator sequence", "[rand][functionality]")
+{
+    const uint32_t expected[] = {0xc2f57bd6, 0x6b07c4a9, 0x72b7b29b, 0x44215383, 0xf5af5ead, 0x68beb632};
+    const size_t count = sizeof(expected) / sizeof(expected[0]);
+
+    lvgl_port_rand_seed(42);
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_HEX32(expected[i], lvgl_port_rand());
+    }
+
+    lvgl_port_rand_seed(42);
+    TEST_ASSERT_EQUAL_HEX32(expected[0], lvgl_port_rand());
+
+    lvgl_port_rand_seed(43);
+    TEST_ASSERT_NOT_EQUAL(expected[0], lvgl_port_rand());
+}
+
+/*
+Functionality test
+
+Purpose:
+    - Test that bounded values are in the range, uniform and without modulo bias
+
+Procedure:
+    - Bounds 0 and 1 give 0, bounded value is the first value out of the incomplete last range, modulo bound
+    - Random bounds: all values in the range
+    - Bound 7: every value has the expected count within 3 %
+    - Bound 3 * 2^30: plain modulo would give values under 2^30 in 1/2 of the samples, bounded values in 1/3
+*/
+TEST_CASE("Pseudo-random generator bounded values", "[rand][functionality]")
+{
+    lvgl_port_rand_seed(7);
+    TEST_ASSERT_EQUAL_UINT32(0, lvgl_port_rand_bounded(0));
+    TEST_ASSERT_EQUAL_UINT32(0, lvgl_port_rand_bounded(1));
+
+    /* Same result as the rejection sampling done by hand on the same sequence */
+    const uint32_t bounds[] = {3, 7, 1000, 0x80000001, 0xC0000000, 0xFFFFFFFF};
+    for (size_t b = 0; b < sizeof(bounds) / sizeof(bounds[0]); b++) {
+        const uint32_t bound = bounds[b];
+        const uint32_t threshold = (0x100000000ULL - bound) % bound;
+        for (int i = 0; i < 100; i++) {
+            lvgl_port_rand_seed(100 + i);
+            const uint32_t value = lvgl_port_rand_bounded(bound);
+            lvgl_port_rand_seed(100 + i);
+            uint32_t r = lvgl_port_rand();
+            while (r < threshold) {
+                r = lvgl_port_rand();
+            }
+            TEST_ASSERT_EQUAL_UINT32(r % bound, value);
+        }
+    }
+
+    lvgl_port_rand_seed(11);
+    for (int i = 0; i < SAMPLES; i++) {
+        const uint32_t bound = 1 + lvgl_port_rand() % 5000;
+        TEST_ASSERT_TRUE(lvgl_port_rand_bounded(bound) < bound);
+    }
+
+    uint32_t counts[7] = {0};
+    for (int i = 0; i < SAMPLES; i++) {
+        counts[lvgl_port_rand_bounded(7)]++;
+    }
+    for (int i = 0; i < 7; i++) {
+        TEST_ASSERT_TRUE(abs((int)counts[i] - SAMPLES / 7) < SAMPLES / 7 * 3 / 100);
+    }
+
+    uint32_t low = 0;
+    for (int i = 0; i < SAMPLES; i++) {
+        low += (lvgl_port_rand_bounded(0xC0000000) < 0x40000000);
+    }
+    printf("Bounded 3 * 2^30: %" PRIu32 " %% of values under 2^30 (modulo bias would give 50 %%)\n", low * 100 / SAMPLES);
+    TEST_ASSERT_TRUE(abs((int)low - SAMPLES / 3) < SAMPLES / 100);
+}
+
+/*
+Functionality test
+
+Purpose:
+    - Test that recorded LVGL tick increments replay the same ticks in the same LVGL task cycles, so a seeded
+      application takes the same decisions at the same ticks
+
+Procedure:
+    - Record: LVGL tick advanced by a jittery clock (0..30 ms per cycle, over the 32-bit overflow), the application
+      takes a random value in some cycles, depending on the elapsed tick
+    - Replay: LVGL tick starts from other value and is advanced by the recorded increments, then by the synthetic period
+    - Elapsed ticks and the values must be the same in all recorded cycles, the synthetic period follows, the recording
+      stops, when its buffer is full
+*/
+TEST_CASE("Replay of recorded LVGL tick", "[replay][functionality]")
+{
+    uint32_t *deltas = malloc((CYCLES + 1) * sizeof(uint32_t));
+    app_cycle_t *recorded = malloc(CYCLES * sizeof(app_cycle_t));
+    TEST_ASSERT_NOT_NULL(deltas);
+    TEST_ASSERT_NOT_NULL(recorded);
+    deltas[CYCLES] = 0xDEADBEEF;
+
+    /* Jitter of the real clock doesn't use the application generator */
+    uint32_t jitter = 0x12345678;
+    const uint32_t start = 0xFFFFFF00;
+    uint32_t tick = start;
+    lvgl_port_record_t record;
+    lvgl_port_record_init(&record, deltas, CYCLES, tick);
+    lvgl_port_rand_seed(1234);
+    for (int i = 0; i < CYCLES + 10; i++) {
+        jitter = jitter * 1103515245 + 12345;
+        tick += (jitter >> 16) % 31;
+        lvgl_port_record_tick(&record, tick);
+        if (i < CYCLES) {
+            recorded[i].tick = tick - start;
+            recorded[i].value = (recorded[i].tick % 3 == 0 ? lvgl_port_rand_bounded(1000) : 0);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(CYCLES, record.count);
+    TEST_ASSERT_EQUAL_HEX32(0xDEADBEEF, deltas[CYCLES]);
+
+    const uint32_t period = 10;
+    lvgl_port_replay_t replay;
+    lvgl_port_replay_init(&replay, period, deltas, CYCLES);
+    lvgl_port_rand_seed(1234);
+    uint32_t replay_tick = 5;
+    for (int i = 0; i < CYCLES; i++) {
+        replay_tick += lvgl_port_replay_next(&replay);
+        const uint32_t elapsed = replay_tick - 5;
+        TEST_ASSERT_EQUAL_UINT32(recorded[i].tick, elapsed);
+        TEST_ASSERT_EQUAL_UINT32(recorded[i].value, (elapsed % 3 == 0 ? lvgl_port_rand_bounded(1000) : 0));
+    }
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL_UINT32(period, lvgl_port_replay_next(&replay));
+    }
+
+    /* Synthetic clock only */
+    lvgl_port_replay_init(&replay, period, NULL, CYCLES);
+    TEST_ASSERT_EQUAL_UINT32(period, lvgl_port_replay_next(&replay));
+
+    free(recorded);
+    free(deltas);
+}
@@ -0,0 +1,161 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_common.h"
+#include "esp_lvgl_port_color.h"
+
+#define CANARY          0xA5
+#define MAX_SIZE        35
+#define BENCH_W         240
+#define BENCH_H         40
+#define BENCH_CYCLES    500
+
+// ------------------------------------------------ Reference ----------------------------------------------------------
+
+static const uint8_t ref_bayer[4][4] = {
+    { 0,  8,  2, 10},
+    {12,  4, 14,  6},
+    { 3, 11,  1,  9},
+    {15,  7, 13,  5},
+};
+
+/* Reduce a channel by dropped bits, with an optional ordered dithering threshold (0..15) */
+static uint8_t ref_reduce(uint32_t value, int dropped_bits, uint32_t threshold)
+{
+    uint32_t out = (value + (threshold >> (4 - dropped_bits))) >> dropped_bits;
+    return out > 15 ? 15 : out;
+}
+
+/* Reference: pixel by pixel, with screen coordinates, written nibble by nibble */
+static size_t ref_rgb565_to_rgb444(const uint16_t *src, uint8_t *dst, int32_t w, int32_t h, int32_t x0, int32_t y0, bool dither)
+{
+    size_t nibble = 0;
+    for (int32_t y = 0; y < h; y++) {
+        for (int32_t x = 0; x < w; x++) {
+            const uint16_t c = src[y * w + x];
+            const uint32_t t = dither ? ref_bayer[(y0 + y) % 4][(x0 + x) % 4] : 0;
+            const uint8_t ch[3] = {
+                ref_reduce(c >> 11, 1, t),
+                ref_reduce((c >> 5) & 0x3F, 2, t),
+                ref_reduce(c & 0x1F, 1, t),
+            };
+            for (int i = 0; i < 3; i++, nibble++) {
+                if (nibble % 2 == 0) {
+                    dst[nibble / 2] = ch[i] << 4;
+                } else {
+                    dst[nibble / 2] |= ch[i];
+                }
+            }
+        }
+    }
+    return (nibble + 1) / 2;
+}
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Functionality test
+
+Purpose:
+    - Test that the RGB444 packer gives the same stream as the reference, with and without dithering
+
+Procedure:
+    - Generate random RGB565 areas of all sizes up to MAX_SIZE x MAX_SIZE at screen positions with all dithering phases
+    - Run the reference and the packer to a separate buffer and in place
+    - Compare packed bytes and the returned length, check canary bytes behind the separate output
+*/
+TEST_CASE("RGB565 to RGB444 functionality", "[rgb444][functionality]")
+{
+    const size_t buf_len = MAX_SIZE * MAX_SIZE * 2 + 16;
+    uint16_t *src = malloc(buf_len);
+    uint16_t *in_place = malloc(buf_len);
+    uint8_t *ref = malloc(buf_len);
+    uint8_t *dut = malloc(buf_len);
+    TEST_ASSERT_NOT_NULL(src);
+    TEST_ASSERT_NOT_NULL(in_place);
+    TEST_ASSERT_NOT_NULL(ref);
+    TEST_ASSERT_NOT_NULL(dut);
+
+    unsigned int combinations = 0;
+    for (int32_t w = 1; w <= MAX_SIZE; w++) {
+        for (int32_t h = 1; h <= MAX_SIZE; h++) {
+            for (int32_t phase = 0; phase < 4; phase++) {
+                for (int dither = 0; dither <= 1; dither++) {
+                    const int32_t x0 = phase * 5;
+                    const int32_t y0 = phase * 3;
+                    test_fill_random(src, buf_len, w * 1000 + h);
+                    memcpy(in_place, src, buf_len);
+                    memset(ref, CANARY, buf_len);
+                    memset(dut, CANARY, buf_len);
+
+                    const size_t ref_len = ref_rgb565_to_rgb444(src, ref, w, h, x0, y0, dither);
+                    const size_t dut_len = lvgl_port_rgb565_to_rgb444(src, dut, w, h, x0, y0, dither);
+                    const size_t in_place_len = lvgl_port_rgb565_to_rgb444(in_place, in_place, w, h, x0, y0, dither);
+
+                    if (ref_len != dut_len || memcmp(ref, dut, buf_len) != 0 || memcmp(ref, in_place, ref_len) != 0) {
+                        printf("Mismatch: %"PRIi32"x%"PRIi32", position %"PRIi32",%"PRIi32", dither %d\n", w, h, x0, y0, dither);
+                    }
+                    TEST_ASSERT_EQUAL_UINT32(ref_len, dut_len);
+                    TEST_ASSERT_EQUAL_UINT32(ref_len, in_place_len);
+                    TEST_ASSERT_EQUAL_UINT32((w * h * 3 + 1) / 2, ref_len);
+                    TEST_ASSERT_EQUAL_UINT8_ARRAY(ref, dut, buf_len);
+                    TEST_ASSERT_EQUAL_UINT8_ARRAY(ref, in_place, ref_len);
+                    combinations++;
+                }
+            }
+        }
+    }
+    printf("RGB444: test combinations: %u\n", combinations);
+
+    /* Extremes: white stays white with dithering, black stays black */
+    const uint16_t extremes[2] = {0xFFFF, 0x0000};
+    for (int32_t t = 0; t < 16; t++) {
+        lvgl_port_rgb565_to_rgb444(extremes, dut, 2, 1, t % 4, t / 4, true);
+        TEST_ASSERT_EQUAL_HEX8(0xFF, dut[0]);
+        TEST_ASSERT_EQUAL_HEX8(0xF0, dut[1]);
+        TEST_ASSERT_EQUAL_HEX8(0x00, dut[2]);
+    }
+
+    free(src);
+    free(in_place);
+    free(ref);
+    free(dut);
+}
+
+/*
+Benchmark test
+
+Purpose:
+    - Measure the packer on a 240x40 partial buffer, with and without dithering
+
+Procedure:
+    - Run each variant BENCH_CYCLES times in place and print time per pixel
+*/
+TEST_CASE("RGB565 to RGB444 benchmark", "[rgb444][benchmark]")
+{
+    const size_t len = BENCH_W * BENCH_H * 2;
+    uint16_t *buf = aligned_alloc(16, len);
+    TEST_ASSERT_NOT_NULL(buf);
+
+    for (int dither = 0; dither <= 1; dither++) {
+        uint64_t total = 0;
+        for (int i = 0; i < BENCH_CYCLES; i++) {
+            test_fill_random(buf, len, i + 1);
+            const uint64_t start = test_time_ns();
+            lvgl_port_rgb565_to_rgb444(buf, buf, BENCH_W, BENCH_H, 0, 0, dither);
+            total += test_time_ns() - start;
+        }
+        printf("RGB565 to RGB444 %dx%d, dither %d: %.3f ns/px\n", BENCH_W, BENCH_H, dither,
+               (double)total / BENCH_CYCLES / (BENCH_W * BENCH_H));
+    }
+
+    free(buf);
+}
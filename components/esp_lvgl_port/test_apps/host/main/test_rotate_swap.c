@@ -0,0 +1,431 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_common.h"
+#include "esp_lvgl_port_color.h"
+
+#define CANARY          0xA5
+#define MAX_SIZE        35
+#define BENCH_W         240
+#define BENCH_H         40
+#define BENCH_CYCLES    500
+/* Data cache in front of PSRAM (ESP32-S3: 32 KB, 8 ways, 32 B lines) */
+#define CACHE_SIZE      (32 * 1024)
+#define CACHE_WAYS      8
+#define CACHE_LINE      32
+#define CACHE_SETS      (CACHE_SIZE / CACHE_LINE / CACHE_WAYS)
+
+typedef struct {
+    uint32_t    tags[CACHE_SETS][CACHE_WAYS];   /* Line address + 1 (0: empty) */
+    uint32_t    ages[CACHE_SETS][CACHE_WAYS];
+    bool        dirty[CACHE_SETS][CACHE_WAYS];
+    uint32_t    clock;
+    uint32_t    fills;                          /* Lines read from PSRAM */
+    uint32_t    write_backs;                    /* Dirty lines written to PSRAM */
+} cache_model_t;
+
+// ------------------------------------------------ Reference ----------------------------------------------------------
+
+/*
+ * Reference: the sequence, which was used in the flush callback before.
+ * Plain per-pixel rotation (same as lv_draw_sw_rotate() for RGB565) followed by a separate pass of lv_draw_sw_rgb565_swap().
+ */
+static void ref_rotate_px(const uint8_t *src, uint8_t *dst, int32_t w, int32_t h, int32_t src_stride, int32_t dst_stride,
+                          uint32_t px_size, lvgl_port_color_rotation_t rotation)
+{
+    for (int32_t y = 0; y < h; y++) {
+        for (int32_t x = 0; x < w; x++) {
+            int32_t dx = x;
+            int32_t dy = y;
+            switch (rotation) {
+            case LVGL_PORT_COLOR_ROTATION_90:
+                dx = y;
+                dy = w - 1 - x;
+                break;
+            case LVGL_PORT_COLOR_ROTATION_180:
+                dx = w - 1 - x;
+                dy = h - 1 - y;
+                break;
+            case LVGL_PORT_COLOR_ROTATION_270:
+                dx = h - 1 - y;
+                dy = x;
+                break;
+            default:
+                break;
+            }
+            memcpy(dst + dy * dst_stride + dx * px_size, src + y * src_stride + x * px_size, px_size);
+        }
+    }
+}
+
+static void ref_rotate(const uint8_t *src, uint8_t *dst, int32_t w, int32_t h, int32_t src_stride, int32_t dst_stride,
+                       lvgl_port_color_rotation_t rotation)
+{
+    ref_rotate_px(src, dst, w, h, src_stride, dst_stride, 2, rotation);
+}
+
+static void ref_swap(uint8_t *buf, uint32_t len_px)
+{
+    for (uint32_t i = 0; i < len_px; i++) {
+        uint8_t t = buf[2 * i];
+        buf[2 * i] = buf[2 * i + 1];
+        buf[2 * i + 1] = t;
+    }
+}
+
+static void ref_rotate_swap(const uint8_t *src, uint8_t *dst, int32_t w, int32_t h, int32_t src_stride, int32_t dst_stride,
+                            lvgl_port_color_rotation_t rotation, bool swap)
+{
+    ref_rotate(src, dst, w, h, src_stride, dst_stride, rotation);
+    if (swap) {
+        /* Destination is contiguous in the flush path */
+        bool rotated = (rotation == LVGL_PORT_COLOR_ROTATION_90 || rotation == LVGL_PORT_COLOR_ROTATION_270);
+        int32_t dst_h = rotated ? w : h;
+        for (int32_t y = 0; y < dst_h; y++) {
+            ref_swap(dst + y * dst_stride, rotated ? h : w);
+        }
+    }
+}
+
+// ------------------------------------------------ Cache model ---------------------------------------------------------
+
+/* Access of len bytes at addr: LRU set-associative write-back cache, every byte is in one line */
+static void cache_access(cache_model_t *cache, uint32_t addr, uint32_t len, bool write)
+{
+    for (uint32_t line = addr / CACHE_LINE; line <= (addr + len - 1) / CACHE_LINE; line++) {
+        const uint32_t set = line % CACHE_SETS;
+        uint32_t way = 0;
+        for (uint32_t i = 0; i < CACHE_WAYS; i++) {
+            if (cache->tags[set][i] == line + 1) {
+                way = i;
+                goto hit;
+            }
+            if (cache->ages[set][i] < cache->ages[set][way]) {
+                way = i;
+            }
+        }
+        /* Miss: the least recently used line is replaced */
+        if (cache->dirty[set][way]) {
+            cache->write_backs++;
+        }
+        cache->tags[set][way] = line + 1;
+        cache->dirty[set][way] = false;
+        cache->fills++;
+hit:
+        cache->ages[set][way] = ++cache->clock;
+        cache->dirty[set][way] |= write;
+    }
+}
+
+/*
+ * Access order of the rotations by 90 degrees of a source in PSRAM to a destination in PSRAM (pixel addresses only):
+ *  - naive:  source rows, one pixel to each destination row (lv_draw_sw_rotate)
+ *  - tiled:  tiles, destination rows of the tile, source read by columns (lvgl_port_rotate() without the tile buffer)
+ *  - staged: tiles, source rows of the tile into the tile buffer, then destination rows of the tile (with the buffer)
+ */
+typedef enum {
+    WALK_NAIVE,
+    WALK_TILED,
+    WALK_STAGED,
+} rotate_walk_t;
+
+static void cache_rotate_90(cache_model_t *cache, rotate_walk_t walk, int32_t w, int32_t h, uint32_t px_size)
+{
+    const uint32_t src = 0;
+    const uint32_t dst = 16 * 1024 * 1024;
+    const uint32_t src_stride = w * px_size;
+    const uint32_t dst_stride = h * px_size;
+
+    if (walk == WALK_NAIVE) {
+        for (int32_t y = 0; y < h; y++) {
+            for (int32_t x = 0; x < w; x++) {
+                cache_access(cache, src + y * src_stride + x * px_size, px_size, false);
+                cache_access(cache, dst + (w - 1 - x) * dst_stride + y * px_size, px_size, true);
+            }
+        }
+        return;
+    }
+
+    for (int32_t y0 = 0; y0 < h; y0 += LVGL_PORT_ROTATE_TILE) {
+        const int32_t y1 = (y0 + LVGL_PORT_ROTATE_TILE < h ? y0 + LVGL_PORT_ROTATE_TILE : h);
+        for (int32_t x0 = 0; x0 < w; x0 += LVGL_PORT_ROTATE_TILE) {
+            const int32_t x1 = (x0 + LVGL_PORT_ROTATE_TILE < w ? x0 + LVGL_PORT_ROTATE_TILE : w);
+            if (walk == WALK_STAGED) {
+                for (int32_t y = y0; y < y1; y++) {
+                    cache_access(cache, src + y * src_stride + x0 * px_size, (x1 - x0) * px_size, false);
+                }
+                for (int32_t x = x0; x < x1; x++) {
+                    cache_access(cache, dst + (w - 1 - x) * dst_stride + y0 * px_size, (y1 - y0) * px_size, true);
+                }
+                continue;
+            }
+            for (int32_t x = x0; x < x1; x++) {
+                for (int32_t y = y0; y < y1; y++) {
+                    cache_access(cache, src + y * src_stride + x * px_size, px_size, false);
+                    cache_access(cache, dst + (w - 1 - x) * dst_stride + y * px_size, px_size, true);
+                }
+            }
+        }
+    }
+}
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Functionality test
+
+Purpose:
+    - Test that the fused rotate+swap kernel gives the same result as rotation followed by byte swap
+
+Procedure:
+    - Generate random source matrices of all sizes up to MAX_SIZE x MAX_SIZE, word aligned and 2-byte unaligned, with and without stride padding
+    - Run the reference and the fused kernel for all rotations, with and without swap
+    - Compare destination buffers, including canary bytes behind the destination
+*/
+TEST_CASE("Rotate swap functionality RGB565", "[rotate][functionality][RGB565]")
+{
+    const size_t buf_len = (MAX_SIZE + 2) * (MAX_SIZE + 2) * 2 + 16;
+    uint8_t *src_alloc = malloc(buf_len);
+    uint8_t *ref_alloc = malloc(buf_len);
+    uint8_t *dut_alloc = malloc(buf_len);
+    TEST_ASSERT_NOT_NULL(src_alloc);
+    TEST_ASSERT_NOT_NULL(ref_alloc);
+    TEST_ASSERT_NOT_NULL(dut_alloc);
+
+    unsigned int combinations = 0;
+    for (int rot = LVGL_PORT_COLOR_ROTATION_0; rot <= LVGL_PORT_COLOR_ROTATION_270; rot++) {
+        const bool rotated = (rot == LVGL_PORT_COLOR_ROTATION_90 || rot == LVGL_PORT_COLOR_ROTATION_270);
+        for (int32_t w = 1; w <= MAX_SIZE; w++) {
+            for (int32_t h = 1; h <= MAX_SIZE; h++) {
+                for (int unalign = 0; unalign <= 2; unalign += 2) {
+                    for (int pad = 0; pad <= 2; pad += 2) {
+                        for (int swap = 0; swap <= 1; swap++) {
+                            const int32_t src_stride = w * 2 + pad;
+                            const int32_t dst_w = rotated ? h : w;
+                            const int32_t dst_stride = dst_w * 2 + pad;
+                            uint8_t *src = src_alloc + unalign;
+                            uint8_t *ref = ref_alloc + unalign;
+                            uint8_t *dut = dut_alloc + unalign;
+
+                            test_fill_random(src_alloc, buf_len, w * 1000 + h);
+                            memset(ref_alloc, CANARY, buf_len);
+                            memset(dut_alloc, CANARY, buf_len);
+
+                            ref_rotate_swap(src, ref, w, h, src_stride, dst_stride, rot, swap);
+                            lvgl_port_rgb565_rotate_swap(src, dut, w, h, src_stride, dst_stride, rot, swap);
+
+                            if (memcmp(ref_alloc, dut_alloc, buf_len) != 0) {
+                                printf("Mismatch: rotation %d, %"PRIi32"x%"PRIi32", unalign %d, pad %d, swap %d\n", rot, w, h, unalign, pad, swap);
+                            }
+                            TEST_ASSERT_EQUAL_UINT8_ARRAY(ref_alloc, dut_alloc, buf_len);
+                            combinations++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    printf("Rotate swap: test combinations: %u\n", combinations);
+
+    free(src_alloc);
+    free(ref_alloc);
+    free(dut_alloc);
+}
+
+/*
+Benchmark test
+
+Purpose:
+    - Compare the fused kernel with the rotation followed by a byte swap pass on a 240x40 partial buffer
+
+Procedure:
+    - Run each variant BENCH_CYCLES times for every rotation and print time per pixel
+*/
+TEST_CASE("Rotate swap benchmark RGB565", "[rotate][benchmark][RGB565]")
+{
+    const size_t len = BENCH_W * BENCH_H * 2;
+    uint8_t *src = aligned_alloc(16, len);
+    uint8_t *dst = aligned_alloc(16, len);
+    TEST_ASSERT_NOT_NULL(src);
+    TEST_ASSERT_NOT_NULL(dst);
+    test_fill_random(src, len, 1);
+
+    for (int rot = LVGL_PORT_COLOR_ROTATION_90; rot <= LVGL_PORT_COLOR_ROTATION_270; rot++) {
+        const bool rotated = (rot == LVGL_PORT_COLOR_ROTATION_90 || rot == LVGL_PORT_COLOR_ROTATION_270);
+        const int32_t dst_stride = (rotated ? BENCH_H : BENCH_W) * 2;
+
+        uint64_t start = test_time_ns();
+        for (int i = 0; i < BENCH_CYCLES; i++) {
+            ref_rotate_swap(src, dst, BENCH_W, BENCH_H, BENCH_W * 2, dst_stride, rot, true);
+        }
+        const double ref_ns = (double)(test_time_ns() - start) / BENCH_CYCLES;
+
+        start = test_time_ns();
+        for (int i = 0; i < BENCH_CYCLES; i++) {
+            lvgl_port_rgb565_rotate_swap(src, dst, BENCH_W, BENCH_H, BENCH_W * 2, dst_stride, rot, true);
+        }
+        const double dut_ns = (double)(test_time_ns() - start) / BENCH_CYCLES;
+
+        printf("Rotate %3d + swap %dx%d: rotate, swap: %.3f ns/px, fused: %.3f ns/px\n", rot * 90, BENCH_W, BENCH_H,
+               ref_ns / (BENCH_W * BENCH_H), dut_ns / (BENCH_W * BENCH_H));
+    }
+
+    free(src);
+    free(dst);
+}
+
+/*
+Functionality test
+
+Purpose:
+    - Test that the rotation of 2, 3 and 4 bytes per pixel gives the same result as per-pixel rotation,
+      with and without the tile buffer
+
+Procedure:
+    - Generate random source matrices up to MAX_SIZE x MAX_SIZE (more than two tiles), with and without stride padding
+    - Run the reference and the kernel for all rotations and pixel sizes, 2 bytes also with swap
+    - Compare destination buffers, including canary bytes behind the destination, and check the tile buffer bounds
+*/
+TEST_CASE("Rotate tiled functionality", "[rotate][functionality]")
+{
+    const size_t buf_len = (MAX_SIZE + 4) * (MAX_SIZE + 4) * 4 + 16;
+    uint8_t *src = malloc(buf_len);
+    uint8_t *ref = malloc(buf_len);
+    uint8_t *dut = malloc(buf_len);
+    uint8_t *tile = malloc(LVGL_PORT_ROTATE_TILE_BYTES + 16);
+    TEST_ASSERT_NOT_NULL(src);
+    TEST_ASSERT_NOT_NULL(ref);
+    TEST_ASSERT_NOT_NULL(dut);
+    TEST_ASSERT_NOT_NULL(tile);
+
+    unsigned int combinations = 0;
+    for (uint32_t px_size = 2; px_size <= 4; px_size++) {
+        for (int rot = LVGL_PORT_COLOR_ROTATION_0; rot <= LVGL_PORT_COLOR_ROTATION_270; rot++) {
+            const bool rotated = (rot == LVGL_PORT_COLOR_ROTATION_90 || rot == LVGL_PORT_COLOR_ROTATION_270);
+            for (int32_t w = 1; w <= MAX_SIZE; w++) {
+                for (int32_t h = 1; h <= MAX_SIZE; h++) {
+                    for (int pad = 0; pad <= 4; pad += 4) {
+                        for (int staged = 0; staged <= 1; staged++) {
+                            for (int swap = 0; swap <= (px_size == 2); swap++) {
+                                const int32_t src_stride = w * px_size + pad;
+                                const int32_t dst_stride = (rotated ? h : w) * px_size + pad;
+
+                                test_fill_random(src, buf_len, w * 1000 + h);
+                                memset(ref, CANARY, buf_len);
+                                memset(dut, CANARY, buf_len);
+                                memset(tile, CANARY, LVGL_PORT_ROTATE_TILE_BYTES + 16);
+
+                                if (swap) {
+                                    ref_rotate_swap(src, ref, w, h, src_stride, dst_stride, rot, true);
+                                } else {
+                                    ref_rotate_px(src, ref, w, h, src_stride, dst_stride, px_size, rot);
+                                }
+                                lvgl_port_rotate(src, dut, w, h, src_stride, dst_stride, px_size, rot, swap, staged ? tile : NULL);
+
+                                if (memcmp(ref, dut, buf_len) != 0) {
+                                    printf("Mismatch: %"PRIu32" B/px, rotation %d, %"PRIi32"x%"PRIi32", pad %d, staged %d, swap %d\n", px_size, rot, w, h, pad, staged, swap);
+                                }
+                                TEST_ASSERT_EQUAL_UINT8_ARRAY(ref, dut, buf_len);
+                                for (int i = 0; i < 16; i++) {
+                                    TEST_ASSERT_EQUAL_UINT8(CANARY, tile[LVGL_PORT_ROTATE_TILE_BYTES + i]);
+                                }
+                                combinations++;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    printf("Rotate tiled: test combinations: %u\n", combinations);
+
+    free(src);
+    free(ref);
+    free(dut);
+    free(tile);
+}
+
+/*
+Benchmark test
+
+Purpose:
+    - Compare the cache line traffic of the rotation by 90 degrees of a PSRAM frame buffer: naive walk, tiles and tiles
+      with the tile buffer
+    - Compare the time of the kernel with and without the tile buffer on host
+
+Procedure:
+    - Replay the accesses of each walk of RGB565 and XRGB8888 frames in a model of the PSRAM data cache, count line
+      fills and write-backs: 800x480 of the rgb_lcd example and 1024x512, whose strides map the rows of a tile
+      to the same cache sets
+    - The tile buffer must move at least 4 times less cache lines than the naive walk and not more than the tiles
+      without it, at most twice the lines of the source and destination (fill of the source, fill and write-back
+      of the destination)
+*/
+TEST_CASE("Rotate tiled PSRAM cache model benchmark", "[rotate][benchmark]")
+{
+    cache_model_t *cache = malloc(sizeof(cache_model_t));
+    TEST_ASSERT_NOT_NULL(cache);
+
+    const int32_t frames[][2] = {{800, 480}, {1024, 512}};
+    for (size_t f = 0; f < sizeof(frames) / sizeof(frames[0]); f++) {
+        for (uint32_t px_size = 2; px_size <= 4; px_size += 2) {
+            const uint32_t frame_lines = frames[f][0] * frames[f][1] * px_size / CACHE_LINE;
+            uint32_t lines[3];
+            for (int walk = WALK_NAIVE; walk <= WALK_STAGED; walk++) {
+                memset(cache, 0, sizeof(cache_model_t));
+                cache_rotate_90(cache, walk, frames[f][0], frames[f][1], px_size);
+                lines[walk] = cache->fills + cache->write_backs;
+            }
+            printf("Rotate 90 %"PRIi32"x%"PRIi32", %"PRIu32" B/px, cache lines moved (frame has %"PRIu32"): naive %"PRIu32", tiled %"PRIu32", staged %"PRIu32"\n",
+                   frames[f][0], frames[f][1], px_size, frame_lines, lines[WALK_NAIVE], lines[WALK_TILED], lines[WALK_STAGED]);
+            TEST_ASSERT_TRUE(lines[WALK_STAGED] * 4 <= lines[WALK_NAIVE]);
+            TEST_ASSERT_TRUE(lines[WALK_STAGED] <= lines[WALK_TILED]);
+            TEST_ASSERT_TRUE(lines[WALK_STAGED] <= 2 * frame_lines * 2);
+        }
+    }
+    free(cache);
+
+    const size_t len = BENCH_W * BENCH_H * 4;
+    uint8_t *src = aligned_alloc(16, len);
+    uint8_t *dst = aligned_alloc(16, len);
+    uint8_t *tile = aligned_alloc(16, LVGL_PORT_ROTATE_TILE_BYTES);
+    TEST_ASSERT_NOT_NULL(src);
+    TEST_ASSERT_NOT_NULL(dst);
+    TEST_ASSERT_NOT_NULL(tile);
+    test_fill_random(src, len, 1);
+
+    for (uint32_t px_size = 2; px_size <= 4; px_size++) {
+        uint64_t start = test_time_ns();
+        for (int i = 0; i < BENCH_CYCLES; i++) {
+            ref_rotate_px(src, dst, BENCH_W, BENCH_H, BENCH_W * px_size, BENCH_H * px_size, px_size, LVGL_PORT_COLOR_ROTATION_90);
+        }
+        const double ref_ns = (double)(test_time_ns() - start) / BENCH_CYCLES;
+
+        start = test_time_ns();
+        for (int i = 0; i < BENCH_CYCLES; i++) {
+            lvgl_port_rotate(src, dst, BENCH_W, BENCH_H, BENCH_W * px_size, BENCH_H * px_size, px_size, LVGL_PORT_COLOR_ROTATION_90, false, NULL);
+        }
+        const double tiled_ns = (double)(test_time_ns() - start) / BENCH_CYCLES;
+
+        start = test_time_ns();
+        for (int i = 0; i < BENCH_CYCLES; i++) {
+            lvgl_port_rotate(src, dst, BENCH_W, BENCH_H, BENCH_W * px_size, BENCH_H * px_size, px_size, LVGL_PORT_COLOR_ROTATION_90, false, tile);
+        }
+        const double staged_ns = (double)(test_time_ns() - start) / BENCH_CYCLES;
+
+        printf("Rotate  90 %dx%d, %"PRIu32" B/px: naive %.3f ns/px, tiled %.3f ns/px, staged %.3f ns/px\n", BENCH_W, BENCH_H, px_size,
+               ref_ns / (BENCH_W * BENCH_H), tiled_ns / (BENCH_W * BENCH_H), staged_ns / (BENCH_W * BENCH_H));
+    }
+
+    free(src);
+    free(dst);
+    free(tile);
+}
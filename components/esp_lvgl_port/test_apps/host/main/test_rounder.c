@@ -0,0 +1,233 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "unity.h"
+#include "test_common.h"
+#include "esp_lvgl_port_rounder.h"
+#include "esp_lvgl_port_visible.h"
+
+#define CASES           20000
+#define AREAS           2000
+
+static void check_axis(const lvgl_port_rounder_axis_t *axis, int32_t a1, int32_t a2, int32_t r1, int32_t r2)
+{
+    /* Aligned, inside of the screen and containing the area */
+    TEST_ASSERT_TRUE(r1 >= 0 && r2 < axis->res);
+    TEST_ASSERT_EQUAL_INT32(0, r1 % axis->align);
+    TEST_ASSERT_EQUAL_INT32(0, (r2 + 1) % axis->align);
+    TEST_ASSERT_TRUE(r1 <= a1 && r2 >= a2);
+    TEST_ASSERT_TRUE(r2 - r1 + 1 >= axis->min);
+
+    /* Not bigger than needed: grown only to the next cell or to the minimum length */
+    if (r2 - r1 + 1 > axis->min) {
+        TEST_ASSERT_TRUE(a1 - r1 < axis->align);
+        TEST_ASSERT_TRUE(r2 - a2 < axis->align);
+    }
+}
+
+/*
+ * Invalidation event of the port: the area is clipped to the visible window (if any) and rounded. Invalidations
+ * while LVGL renders the display are the probes of the band height, they are only rounded.
+ */
+static void port_invalidate(const lvgl_port_visible_t *vis, const lvgl_port_rounder_t *rounder, bool refreshing, int32_t *x1, int32_t *y1, int32_t *x2, int32_t *y2)
+{
+    if (vis && !refreshing && !lvgl_port_visible_clip(vis, x1, y1, x2, y2)) {
+        *x2 = *x1;
+        *y2 = *y1;
+    }
+    lvgl_port_rounder_area(rounder, x1, y1, x2, y2);
+}
+
+/*
+ * Bands of the area, as LVGL renders them in partial mode: height of the draw buffer is rounded down by the same
+ * event (area from row 0, one column wide) until it fits into the buffer
+ */
+static int32_t lvgl_max_row(const lvgl_port_visible_t *vis, const lvgl_port_rounder_t *rounder, bool refreshing, int32_t buf_lines, int32_t area_h)
+{
+    int32_t max_row = (buf_lines > area_h ? area_h : buf_lines);
+    int32_t h_tmp = max_row;
+    int32_t x1, y1, x2, y2;
+    do {
+        x1 = x2 = y1 = 0;
+        y2 = h_tmp - 1;
+        port_invalidate(vis, rounder, refreshing, &x1, &y1, &x2, &y2);
+        if (y2 - y1 + 1 <= max_row) {
+            break;
+        }
+        h_tmp--;
+    } while (h_tmp > 0);
+    return (h_tmp > 0 ? y2 + 1 : 0);
+}
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Functionality test
+
+Purpose:
+    - Test that rounded areas are aligned, inside of the screen, contain the invalidated area and are not bigger
+      than needed, in all rotations
+
+Procedure:
+    - Random panels (resolution multiple of the alignment), alignments 1..8, minimum widths and rotations
+    - Random areas are rounded and checked on both axes, columns of the panel are rows of the screen in 90/270
+*/
+TEST_CASE("Rounder functionality", "[rounder][functionality]")
+{
+    const uint32_t aligns[] = {1, 2, 4, 8};
+    uint32_t x = 13;
+    for (int i = 0; i < CASES; i++) {
+        const uint32_t x_align = aligns[test_rand_next(&x) % 4];
+        const uint32_t y_align = aligns[test_rand_next(&x) % 4];
+        const uint32_t hres = x_align * (1 + test_rand_next(&x) % (480 / x_align));
+        const uint32_t vres = y_align * (1 + test_rand_next(&x) % (480 / y_align));
+        const uint32_t min_width = (test_rand_next(&x) % 3 ? 0 : test_rand_next(&x) % (hres + 8));
+        const bool swap_xy = test_rand_next(&x) % 2;
+
+        lvgl_port_rounder_t rounder;
+        lvgl_port_rounder_init(&rounder, hres, vres, x_align, y_align, min_width, swap_xy);
+        const lvgl_port_rounder_axis_t *panel_x = (swap_xy ? &rounder.y : &rounder.x);
+        const lvgl_port_rounder_axis_t *panel_y = (swap_xy ? &rounder.x : &rounder.y);
+        TEST_ASSERT_EQUAL_INT32(hres, panel_x->res);
+        TEST_ASSERT_EQUAL_INT32(vres, panel_y->res);
+        TEST_ASSERT_EQUAL_INT32(x_align, panel_x->align);
+        TEST_ASSERT_EQUAL_INT32(y_align, panel_y->align);
+        TEST_ASSERT_TRUE(panel_x->min >= (int32_t)(min_width < hres ? min_width : hres));
+
+        int32_t x1, y1, x2, y2;
+        test_random_area(&x, rounder.x.res, rounder.y.res, 0, &x1, &y1, &x2, &y2);
+        int32_t r1 = x1, s1 = y1, r2 = x2, s2 = y2;
+        lvgl_port_rounder_area(&rounder, &r1, &s1, &r2, &s2);
+        check_axis(&rounder.x, x1, x2, r1, r2);
+        check_axis(&rounder.y, y1, y2, s1, s2);
+
+        /* Rounded area stays the same */
+        int32_t t1 = r1, u1 = s1, t2 = r2, u2 = s2;
+        lvgl_port_rounder_area(&rounder, &t1, &u1, &t2, &u2);
+        TEST_ASSERT_TRUE(t1 == r1 && u1 == s1 && t2 == r2 && u2 == s2);
+    }
+
+    /* Without alignment nothing changes */
+    lvgl_port_rounder_t rounder;
+    lvgl_port_rounder_init(&rounder, 240, 320, 0, 0, 0, false);
+    int32_t x1 = 3, y1 = 5, x2 = 7, y2 = 9;
+    lvgl_port_rounder_area(&rounder, &x1, &y1, &x2, &y2);
+    TEST_ASSERT_TRUE(x1 == 3 && y1 == 5 && x2 == 7 && y2 == 9);
+}
+
+/*
+Functionality test
+
+Purpose:
+    - Test that LVGL renders the bands of rounded areas aligned, so every flushed window is aligned, and print the
+      count of pixels rendered more because of the rounding
+
+Procedure:
+    - Panels: AMOLED 466x466 with even windows, 368x448 with 4 columns and 2 rows, 240x320 with 8 rows and 16 columns
+      minimum width, in all rotations
+    - Draw buffers of random height (not smaller than the alignment), bands are split as LVGL splits them
+    - Every band must start and end on the alignment of its axis
+*/
+TEST_CASE("Rounder aligns bands of the draw buffer", "[rounder][functionality]")
+{
+    const struct {
+        uint32_t hres, vres, x_align, y_align, min_width;
+    } panels[] = {
+        {466, 466, 2, 2, 0},
+        {368, 448, 4, 2, 0},
+        {240, 320, 1, 8, 16},
+    };
+    uint32_t x = 17;
+    for (size_t p = 0; p < sizeof(panels) / sizeof(panels[0]); p++) {
+        uint64_t px = 0;
+        uint64_t rounded_px = 0;
+        uint32_t bands = 0;
+        for (int rotation = 0; rotation < 4; rotation++) {
+            const bool swap_xy = (rotation % 2 == 1);
+            lvgl_port_rounder_t rounder;
+            lvgl_port_rounder_init(&rounder, panels[p].hres, panels[p].vres, panels[p].x_align, panels[p].y_align, panels[p].min_width, swap_xy);
+            const int32_t min_lines = (rounder.y.align > rounder.y.min ? rounder.y.align : rounder.y.min);
+
+            for (int i = 0; i < AREAS; i++) {
+                const int32_t buf_lines = min_lines + test_rand_next(&x) % 64;
+                int32_t x1, y1, x2, y2;
+                test_random_area(&x, rounder.x.res, rounder.y.res, 0, &x1, &y1, &x2, &y2);
+                px += (uint64_t)(x2 - x1 + 1) * (y2 - y1 + 1);
+                lvgl_port_rounder_area(&rounder, &x1, &y1, &x2, &y2);
+                rounded_px += (uint64_t)(x2 - x1 + 1) * (y2 - y1 + 1);
+
+                const int32_t max_row = lvgl_max_row(NULL, &rounder, true, buf_lines, y2 - y1 + 1);
+                TEST_ASSERT_TRUE(max_row > 0 && max_row <= buf_lines);
+                for (int32_t row = y1; row <= y2; row += max_row) {
+                    const int32_t band_y2 = (row + max_row - 1 > y2 ? y2 : row + max_row - 1);
+                    TEST_ASSERT_EQUAL_INT32(0, row % rounder.y.align);
+                    TEST_ASSERT_EQUAL_INT32(0, (band_y2 + 1) % rounder.y.align);
+                    TEST_ASSERT_EQUAL_INT32(0, x1 % rounder.x.align);
+                    TEST_ASSERT_EQUAL_INT32(0, (x2 + 1) % rounder.x.align);
+                    TEST_ASSERT_TRUE(x2 - x1 + 1 >= rounder.x.min);
+                    bands++;
+                }
+            }
+        }
+        printf("Rounder %" PRIu32 "x%" PRIu32 ", align %" PRIu32 "x%" PRIu32 ", min width %" PRIu32 ": %" PRIu32 " aligned bands, %" PRIu64 "%% more pixels rendered\n",
+               panels[p].hres, panels[p].vres, panels[p].x_align, panels[p].y_align, panels[p].min_width, bands, (rounded_px - px) * 100 / px);
+    }
+}
+
+/*
+Functionality test
+
+Purpose:
+    - Test that the band height of the draw buffer is kept on displays with a visible window, where column 0 of the
+      screen is hidden (round display, window not starting at column 0)
+
+Procedure:
+    - Round 466x466 display with even windows, 240x280 panel with the window from column 10 and 8 rows alignment,
+      in all rotations, draw buffers of random height
+    - Probe of the band height is rounded only (LVGL renders the display), bands must have the height of the draw
+      buffer rounded down to the alignment
+    - Clipped probe gives bands of one cell, where column 0 is hidden
+*/
+TEST_CASE("Rounder keeps bands of the visible window", "[rounder][visible][functionality]")
+{
+    const struct {
+        uint32_t hres, vres, x_align, y_align;
+        int32_t x1, y1, x2, y2, radius;
+    } panels[] = {
+        {466, 466, 2, 2, 0, 0, 465, 465, 233},
+        {240, 280, 1, 8, 10, 0, 229, 279, 0},
+    };
+    uint32_t x = 23;
+    for (size_t p = 0; p < sizeof(panels) / sizeof(panels[0]); p++) {
+        for (int rotation = 0; rotation < 4; rotation++) {
+            const bool swap_xy = (rotation % 2 == 1);
+            lvgl_port_rounder_t rounder;
+            lvgl_port_rounder_init(&rounder, panels[p].hres, panels[p].vres, panels[p].x_align, panels[p].y_align, 0, swap_xy);
+            /* Window in the screen coordinates (rotated by 90 or 270 degrees, hidden columns are the top rows) */
+            lvgl_port_visible_t vis;
+            if (swap_xy) {
+                lvgl_port_visible_init(&vis, panels[p].y1, panels[p].x1, panels[p].y2, panels[p].x2, panels[p].radius);
+            } else {
+                lvgl_port_visible_init(&vis, panels[p].x1, panels[p].y1, panels[p].x2, panels[p].y2, panels[p].radius);
+            }
+
+            for (int i = 0; i < AREAS; i++) {
+                const int32_t buf_lines = rounder.y.align + test_rand_next(&x) % 64;
+                const int32_t area_h = rounder.y.res;
+                const int32_t expected = buf_lines - buf_lines % rounder.y.align;
+                TEST_ASSERT_EQUAL_INT32(expected, lvgl_max_row(&vis, &rounder, true, buf_lines, area_h));
+            }
+            /* Probe of 64 lines is hidden, when column 0 is hidden there */
+            int32_t x1 = 0, y1 = 0, x2 = 0, y2 = 63;
+            if (!lvgl_port_visible_clip(&vis, &x1, &y1, &x2, &y2)) {
+                TEST_ASSERT_EQUAL_INT32(rounder.y.align, lvgl_max_row(&vis, &rounder, false, 64, rounder.y.res));
+            }
+        }
+    }
+}
@@ -0,0 +1,314 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_common.h"
+#include "sim_panel.h"
+#include "esp_lvgl_port_color.h"
+#include "esp_lvgl_port_chain.h"
+
+#define FUNC_W          64
+#define FUNC_H          48
+#define FUNC_DRAWS      200
+
+/* ST7789 240x320 on 40 MHz SPI */
+#define BENCH_W         240
+#define BENCH_H         320
+#define BENCH_PCLK_HZ   (40 * 1000 * 1000)
+#define BENCH_OVERHEAD  30
+#define BENCH_FRAMES    4
+/* Time of LVGL rendering of one pixel on the MCU (simple widgets on a 160 MHz RISC-V) */
+#define BENCH_RENDER_NS 100
+
+static bool count_trans_done(sim_panel_t *panel, void *user_ctx)
+{
+    atomic_fetch_add((atomic_uint *)user_ctx, 1);
+    return false;
+}
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Functionality test
+
+Purpose:
+    - Test that the simulated panel writes the windows to its frame buffer, as a MIPI DCS panel does
+    - Test the timing model and the done callback
+
+Procedure:
+    - Draw random windows (each from its own buffer, with queued transfers), some of them split to RAMWR and RAMWRC,
+      some of them sent by polling as parameters of RAMWR (without the done callback)
+    - Compare the frame buffer with a reference screen and the done callback count with the queued color transfers
+    - Draw RGB444 pixels after COLMOD, they must be expanded to the same RGB565 pixels
+    - Full frame must not take less time than the bus model
+*/
+TEST_CASE("Simulated panel functionality", "[sim_panel][functionality]")
+{
+    atomic_uint done_count = 0;
+    const sim_panel_config_t config = {
+        .width = FUNC_W,
+        .height = FUNC_H,
+        .pclk_hz = 20 * 1000 * 1000,
+        .bus_width = 1,
+        .trans_overhead_us = 5,
+        .trans_queue_depth = 4,
+        .on_color_trans_done = count_trans_done,
+        .user_ctx = &done_count,
+    };
+    sim_panel_t *panel = sim_panel_new(&config);
+    TEST_ASSERT_NOT_NULL(panel);
+
+    const size_t frame_len = FUNC_W * FUNC_H;
+    uint16_t *screen = calloc(frame_len, sizeof(uint16_t));
+    uint8_t *bufs[4];
+    for (int i = 0; i < 4; i++) {
+        bufs[i] = malloc(frame_len * sizeof(uint16_t));
+        TEST_ASSERT_NOT_NULL(bufs[i]);
+    }
+    TEST_ASSERT_NOT_NULL(screen);
+
+    uint32_t x = 3;
+    uint32_t color_trans = 0;
+    for (int i = 0; i < FUNC_DRAWS; i++) {
+        const int x1 = test_rand_next(&x) % FUNC_W;
+        const int x2 = x1 + 1 + test_rand_next(&x) % (FUNC_W - x1);
+        const int y1 = test_rand_next(&x) % FUNC_H;
+        const int y2 = y1 + 1 + test_rand_next(&x) % (FUNC_H - y1);
+        const size_t len = (x2 - x1) * (y2 - y1);
+
+        /* Buffer is not reused before its transfer is done, the queue is as deep as the buffers count */
+        uint8_t *buf = bufs[i % 4];
+        test_fill_random(buf, len * 2, i + 1);
+        for (int y = y1; y < y2; y++) {
+            for (int xx = x1; xx < x2; xx++) {
+                const uint8_t *px = buf + ((y - y1) * (x2 - x1) + (xx - x1)) * 2;
+                screen[y * FUNC_W + xx] = (px[0] << 8) | px[1];
+            }
+        }
+
+        const uint32_t path = test_rand_next(&x) % 3;
+        if (path == 2) {
+            const uint8_t caset[4] = {0, x1, 0, x2 - 1};
+            const uint8_t raset[4] = {0, y1, 0, y2 - 1};
+            sim_panel_tx_param(panel, SIM_PANEL_CMD_CASET, caset, sizeof(caset));
+            sim_panel_tx_param(panel, SIM_PANEL_CMD_RASET, raset, sizeof(raset));
+            sim_panel_tx_param(panel, SIM_PANEL_CMD_RAMWR, buf, len * 2);
+        } else if (len > 1 && path == 1) {
+            const uint8_t caset[4] = {0, x1, 0, x2 - 1};
+            const uint8_t raset[4] = {0, y1, 0, y2 - 1};
+            const size_t split = (test_rand_next(&x) % len) * 2;
+            sim_panel_tx_param(panel, SIM_PANEL_CMD_CASET, caset, sizeof(caset));
+            sim_panel_tx_param(panel, SIM_PANEL_CMD_RASET, raset, sizeof(raset));
+            sim_panel_tx_color(panel, SIM_PANEL_CMD_RAMWR, buf, split);
+            sim_panel_tx_color(panel, SIM_PANEL_CMD_RAMWRC, buf + split, len * 2 - split);
+            color_trans += 2;
+        } else {
+            sim_panel_draw_bitmap(panel, x1, y1, x2, y2, buf);
+            color_trans++;
+        }
+    }
+    sim_panel_wait_idle(panel);
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(screen, sim_panel_get_frame(panel), frame_len);
+    TEST_ASSERT_EQUAL_UINT32(color_trans, atomic_load(&done_count));
+
+    /* RGB444: pixels with 4 bits per channel are sent without a loss */
+    uint16_t *src = (uint16_t *)bufs[0];
+    for (size_t i = 0; i < frame_len; i++) {
+        const uint32_t r = test_rand_next(&x) & 0xF;
+        const uint32_t g = test_rand_next(&x) & 0xF;
+        const uint32_t b = test_rand_next(&x) & 0xF;
+        src[i] = ((r << 1 | r >> 3) << 11) | ((g << 2 | g >> 2) << 5) | (b << 1 | b >> 3);
+    }
+    memcpy(screen, src, frame_len * sizeof(uint16_t));
+    const uint8_t colmod = SIM_PANEL_COLMOD_RGB444;
+    sim_panel_tx_param(panel, SIM_PANEL_CMD_COLMOD, &colmod, 1);
+    lvgl_port_rgb565_to_rgb444(src, src, FUNC_W, FUNC_H, 0, 0, false);
+
+    sim_panel_stats_t before, after;
+    sim_panel_get_stats(panel, &before);
+    const uint64_t start = test_time_ns();
+    sim_panel_draw_bitmap(panel, 0, 0, FUNC_W, FUNC_H, src);
+    sim_panel_wait_idle(panel);
+    const uint64_t elapsed = test_time_ns() - start;
+    sim_panel_get_stats(panel, &after);
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(screen, sim_panel_get_frame(panel), frame_len);
+    TEST_ASSERT_EQUAL_UINT64(frame_len * 3 / 2, after.color_bytes - before.color_bytes);
+    TEST_ASSERT_TRUE(elapsed >= sim_panel_get_trans_ns(panel, frame_len * 3 / 2));
+
+    sim_panel_del(panel);
+    for (int i = 0; i < 4; i++) {
+        free(bufs[i]);
+    }
+    free(screen);
+}
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    bool            flushing;
+} bench_display_t;
+
+/* The same as the LVGL port: IO callback notifies LVGL, that the flush is ready */
+static bool bench_flush_ready(sim_panel_t *panel, void *user_ctx)
+{
+    bench_display_t *disp = user_ctx;
+    pthread_mutex_lock(&disp->lock);
+    disp->flushing = false;
+    pthread_cond_signal(&disp->cond);
+    pthread_mutex_unlock(&disp->lock);
+    return false;
+}
+
+static void bench_wait_for_flushing(bench_display_t *disp)
+{
+    pthread_mutex_lock(&disp->lock);
+    while (disp->flushing) {
+        pthread_cond_wait(&disp->cond, &disp->lock);
+    }
+    pthread_mutex_unlock(&disp->lock);
+}
+
+/* Render a band of a frame: pattern of the frame, byte swap and the time of LVGL rendering on the MCU (slept, the DMA thread can run) */
+static void bench_render(uint16_t *buf, int y1, int lines, int frame)
+{
+    const uint64_t end = test_time_ns() + (uint64_t)BENCH_W * lines * BENCH_RENDER_NS;
+    for (int y = 0; y < lines; y++) {
+        for (int x = 0; x < BENCH_W; x++) {
+            buf[y * BENCH_W + x] = (((x + frame * 8) & 0x1F) << 11) | ((((y1 + y) >> 2) & 0x3F) << 5) | (frame & 0x1F);
+        }
+    }
+    lvgl_port_rgb565_swap(buf, BENCH_W * lines);
+    test_sleep_until_ns(end);
+}
+
+/*
+Benchmark test
+
+Purpose:
+    - Measure FPS of the partial flush pipeline with one and two draw buffers of different sizes on a simulated 40 MHz SPI panel
+    - Compare a window per band with chained bands (the next band of the same area continues the window with RAMWRC)
+
+Procedure:
+    - Render bands of the frame (with a modelled render time) and flush them the same way as LVGL does it:
+      rendering into a buffer waits until its previous flush is ready
+    - Chained: bands are sent the same way as the LVGL port does it, the chaining of the port decides between RAMWRC
+      and a new window reaching to the bottom of the panel, all bands of a frame but the first one must be chained
+    - Print FPS and bus utilization, check the last frame on the panel
+    - The last frame is saved as PPM, when LVGL_PORT_SIM_DUMP environment variable is set to a path
+*/
+TEST_CASE("Simulated panel flush pipeline benchmark", "[sim_panel][benchmark]")
+{
+    const struct {
+        int buffers;
+        int lines;
+        bool chain;
+    } modes[] = {
+        {1, BENCH_H / 10, false},
+        {2, BENCH_H / 10, false},
+        {1, BENCH_H / 4, false},
+        {2, BENCH_H / 4, false},
+        {2, BENCH_H / 40, false},
+        {2, BENCH_H / 40, true},
+        {2, BENCH_H / 10, true},
+    };
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        bench_display_t disp = { .flushing = false };
+        pthread_mutex_init(&disp.lock, NULL);
+        pthread_cond_init(&disp.cond, NULL);
+        const sim_panel_config_t config = {
+            .width = BENCH_W,
+            .height = BENCH_H,
+            .pclk_hz = BENCH_PCLK_HZ,
+            .bus_width = 1,
+            .trans_overhead_us = BENCH_OVERHEAD,
+            .trans_queue_depth = 10,
+            .on_color_trans_done = bench_flush_ready,
+            .user_ctx = &disp,
+        };
+        sim_panel_t *panel = sim_panel_new(&config);
+        TEST_ASSERT_NOT_NULL(panel);
+        uint16_t *bufs[2] = {
+            malloc(BENCH_W * modes[m].lines * sizeof(uint16_t)),
+            malloc(BENCH_W * modes[m].lines * sizeof(uint16_t)),
+        };
+        TEST_ASSERT_NOT_NULL(bufs[0]);
+        TEST_ASSERT_NOT_NULL(bufs[1]);
+
+        lvgl_port_chain_t chain;
+        lvgl_port_chain_reset(&chain);
+        int chained_bands = 0;
+        int bands = 0;
+        int act = 0;
+        const uint64_t start = test_time_ns();
+        for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+            for (int y = 0; y < BENCH_H; y += modes[m].lines) {
+                const int lines = (y + modes[m].lines > BENCH_H) ? BENCH_H - y : modes[m].lines;
+                if (modes[m].buffers == 1) {
+                    bench_wait_for_flushing(&disp);
+                }
+                bench_render(bufs[act], y, lines, frame);
+                bench_wait_for_flushing(&disp);
+                pthread_mutex_lock(&disp.lock);
+                disp.flushing = true;
+                pthread_mutex_unlock(&disp.lock);
+                bands++;
+                int32_t win_y_end;
+                if (!modes[m].chain) {
+                    sim_panel_draw_bitmap(panel, 0, y, BENCH_W, y + lines, bufs[act]);
+                } else if (lvgl_port_chain_band(&chain, 0, y, BENCH_W, y + lines, BENCH_H, true, &win_y_end)) {
+                    chained_bands++;
+                    sim_panel_tx_color(panel, SIM_PANEL_CMD_RAMWRC, bufs[act], (size_t)BENCH_W * lines * sizeof(uint16_t));
+                } else {
+                    const uint8_t caset[4] = {0, 0, ((BENCH_W - 1) >> 8) & 0xFF, (BENCH_W - 1) & 0xFF};
+                    const uint8_t raset[4] = {(y >> 8) & 0xFF, y & 0xFF, ((win_y_end - 1) >> 8) & 0xFF, (win_y_end - 1) & 0xFF};
+                    sim_panel_tx_param(panel, SIM_PANEL_CMD_CASET, caset, sizeof(caset));
+                    sim_panel_tx_param(panel, SIM_PANEL_CMD_RASET, raset, sizeof(raset));
+                    sim_panel_tx_color(panel, SIM_PANEL_CMD_RAMWR, bufs[act], (size_t)BENCH_W * lines * sizeof(uint16_t));
+                }
+                act = (act + 1) % modes[m].buffers;
+            }
+        }
+        bench_wait_for_flushing(&disp);
+        const uint64_t elapsed = test_time_ns() - start;
+
+        sim_panel_stats_t stats;
+        sim_panel_get_stats(panel, &stats);
+        printf("Sim panel %dx%d, %d buffer(s) of %d lines%s: %.1f FPS, bus busy %.0f %%\n", BENCH_W, BENCH_H, modes[m].buffers,
+               modes[m].lines, modes[m].chain ? ", chained" : "", BENCH_FRAMES * 1e9 / elapsed, 100.0 * stats.busy_ns / elapsed);
+
+        if (modes[m].chain) {
+            TEST_ASSERT_EQUAL_INT(bands - BENCH_FRAMES, chained_bands);
+        }
+
+        /* Last frame is on the panel */
+        const uint16_t *frame = sim_panel_get_frame(panel);
+        for (int y = 0; y < BENCH_H; y += 37) {
+            for (int x = 0; x < BENCH_W; x += 13) {
+                const int last = BENCH_FRAMES - 1;
+                TEST_ASSERT_EQUAL_HEX16((((x + last * 8) & 0x1F) << 11) | (((y >> 2) & 0x3F) << 5) | (last & 0x1F), frame[y * BENCH_W + x]);
+            }
+        }
+
+        const char *dump = getenv("LVGL_PORT_SIM_DUMP");
+        if (dump && m == sizeof(modes) / sizeof(modes[0]) - 1) {
+            TEST_ASSERT_TRUE(sim_panel_dump_ppm(panel, dump));
+        }
+
+        sim_panel_del(panel);
+        free(bufs[0]);
+        free(bufs[1]);
+        pthread_cond_destroy(&disp.cond);
+        pthread_mutex_destroy(&disp.lock);
+    }
+}
+
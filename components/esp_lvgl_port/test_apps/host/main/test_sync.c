@@ -0,0 +1,163 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_common.h"
+#include "sim_panel.h"
+#include "esp_lvgl_port_sync.h"
+
+#define FRAME_W         160
+#define FRAME_H         120
+#define FRAMES          300
+#define MAX_AREAS       6
+
+typedef struct {
+    uint32_t    calls;
+    size_t      bytes;
+} copy_count_t;
+
+/* Pixels are sent MSB first, frame buffers hold them swapped (as LVGL with swapped bytes) */
+static uint16_t swap_px(uint16_t px)
+{
+    return (uint16_t)((px << 8) | (px >> 8));
+}
+
+static void copy_memcpy(void *dst, const void *src, size_t len, void *user_ctx)
+{
+    copy_count_t *count = user_ctx;
+    memcpy(dst, src, len);
+    count->calls++;
+    count->bytes += len;
+}
+
+static bool sim_flush_ready(sim_panel_t *panel, void *user_ctx)
+{
+    return false;
+}
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Functionality test
+
+Purpose:
+    - Test that two frame buffers in direct mode show the right frame, when only the areas of the last frame are synchronized
+
+Procedure:
+    - Redraw random areas of a reference screen and draw the same areas into the back buffer (as LVGL in direct mode)
+    - Swap: show the back buffer on the simulated panel and compare the panel with the reference screen
+    - Synchronize the areas into the new back buffer, check that every pixel of the areas is copied once
+    - Frames with more than LVGL_PORT_SYNC_AREAS_MAX areas are synchronized whole
+*/
+TEST_CASE("Frame buffer sync functionality", "[sync][functionality]")
+{
+    const size_t frame_len = FRAME_W * FRAME_H;
+    uint16_t *screen = malloc(frame_len * sizeof(uint16_t));
+    uint16_t *fbs[2] = {
+        malloc(frame_len * sizeof(uint16_t)),
+        malloc(frame_len * sizeof(uint16_t)),
+    };
+    uint8_t *mask = malloc(frame_len);
+    TEST_ASSERT_NOT_NULL(screen);
+    TEST_ASSERT_NOT_NULL(fbs[0]);
+    TEST_ASSERT_NOT_NULL(fbs[1]);
+    TEST_ASSERT_NOT_NULL(mask);
+
+    /* Frame buffers of an RGB panel: the panel shows the buffer drawn last */
+    const sim_panel_config_t config = {
+        .width = FRAME_W,
+        .height = FRAME_H,
+        .pclk_hz = 400 * 1000 * 1000,
+        .bus_width = 16,
+        .trans_queue_depth = 1,
+        .on_color_trans_done = sim_flush_ready,
+    };
+    sim_panel_t *panel = sim_panel_new(&config);
+    TEST_ASSERT_NOT_NULL(panel);
+
+    /* Both buffers start with the same screen */
+    test_fill_random(screen, frame_len * sizeof(uint16_t), 3);
+    for (size_t i = 0; i < frame_len; i++) {
+        fbs[0][i] = swap_px(screen[i]);
+    }
+    memcpy(fbs[1], fbs[0], frame_len * sizeof(uint16_t));
+
+    uint32_t x = 7;
+    int back = 0;
+    size_t synced = 0;
+    lvgl_port_sync_t sync;
+    lvgl_port_sync_reset(&sync);
+    for (int frame = 0; frame < FRAMES; frame++) {
+        memset(mask, 0, frame_len);
+        const int count = (frame % 50 == 49 ? LVGL_PORT_SYNC_AREAS_MAX + 5 : (int)(test_rand_next(&x) % (MAX_AREAS + 1)));
+        for (int i = 0; i < count; i++) {
+            lvgl_port_sync_area_t area;
+            /* Sometimes partly out of the frame */
+            test_random_area(&x, FRAME_W, FRAME_H, 4, &area.x1, &area.y1, &area.x2, &area.y2);
+            const uint16_t color = test_rand_next(&x);
+            for (int32_t yy = area.y1; yy <= area.y2; yy++) {
+                for (int32_t xx = area.x1; xx <= area.x2; xx++) {
+                    if (xx < 0 || yy < 0 || xx >= FRAME_W || yy >= FRAME_H) {
+                        continue;
+                    }
+                    const uint16_t px = color ^ (uint16_t)(xx * 31 + yy * 17);
+                    screen[yy * FRAME_W + xx] = px;
+                    fbs[back][yy * FRAME_W + xx] = swap_px(px);
+                    mask[yy * FRAME_W + xx] = 1;
+                }
+            }
+            lvgl_port_sync_add_area(&sync, area.x1, area.y1, area.x2, area.y2);
+        }
+
+        /* Swap */
+        sim_panel_draw_bitmap(panel, 0, 0, FRAME_W, FRAME_H, fbs[back]);
+        sim_panel_wait_idle(panel);
+        TEST_ASSERT_EQUAL_UINT16_ARRAY(screen, sim_panel_get_frame(panel), frame_len);
+
+        size_t masked = 0;
+        for (size_t i = 0; i < frame_len; i++) {
+            masked += mask[i];
+        }
+
+        copy_count_t copies = {0};
+        const size_t copied = lvgl_port_sync_copy(&sync, (uint8_t *)fbs[back ^ 1], (const uint8_t *)fbs[back], FRAME_W, FRAME_H, sizeof(uint16_t), copy_memcpy, &copies);
+        TEST_ASSERT_EQUAL(copies.bytes, copied);
+        if (sync.full) {
+            TEST_ASSERT_EQUAL(frame_len * sizeof(uint16_t), copied);
+            TEST_ASSERT_EQUAL_UINT32(1, copies.calls);
+        } else {
+            TEST_ASSERT_EQUAL(masked * sizeof(uint16_t), copied);
+        }
+        TEST_ASSERT_EQUAL_UINT16_ARRAY(fbs[back], fbs[back ^ 1], frame_len);
+        synced += copied;
+
+        lvgl_port_sync_reset(&sync);
+        back ^= 1;
+    }
+    printf("Frame buffer sync %dx%d: %d frames, %zu%% of full copies\n", FRAME_W, FRAME_H, FRAMES, synced * 100 / (FRAMES * frame_len * sizeof(uint16_t)));
+
+    /* Full-width rows continue in memory, they are copied in one call */
+    copy_count_t copies = {0};
+    lvgl_port_sync_add_area(&sync, 0, 10, FRAME_W - 1, 19);
+    lvgl_port_sync_add_area(&sync, 0, 20, FRAME_W - 1, 29);
+    lvgl_port_sync_add_area(&sync, 5, 12, 20, 25);
+    TEST_ASSERT_EQUAL_UINT32(3, sync.count);
+    lvgl_port_sync_add_area(&sync, 6, 13, 20, 25);
+    TEST_ASSERT_EQUAL_UINT32(3, sync.count);
+    lvgl_port_sync_copy(&sync, (uint8_t *)fbs[0], (const uint8_t *)fbs[1], FRAME_W, FRAME_H, sizeof(uint16_t), copy_memcpy, &copies);
+    TEST_ASSERT_EQUAL_UINT32(1, copies.calls);
+    TEST_ASSERT_EQUAL(20 * FRAME_W * sizeof(uint16_t), copies.bytes);
+
+    sim_panel_del(panel);
+    free(mask);
+    free(fbs[0]);
+    free(fbs[1]);
+    free(screen);
+}
@@ -0,0 +1,211 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "test_common.h"
+#include "sim_panel.h"
+#include "esp_lvgl_port_te.h"
+
+#define FUNC_CASES      20000
+
+/* ST7789 240x320 at 60 Hz on 20 MHz SPI, bands of 32 lines take longer than their scan */
+#define PANEL_W         240
+#define PANEL_H         320
+#define PANEL_REFRESH   16667
+#define PANEL_PCLK_HZ   (20 * 1000 * 1000)
+#define BAND_LINES      32
+#define FRAMES          6
+/* Host threads wake up later than the target tasks, the transfer time is extended by it */
+#define HOST_JITTER_US  300
+
+/* Reference: scan, which shows each row of the band written from the start time, rows are written evenly */
+static bool ref_is_torn(const lvgl_port_te_timing_t *te, double start_us, int32_t y1, int32_t y2, bool down, double trans_us)
+{
+    const int32_t rows = y2 - y1 + 1;
+    double first = NAN;
+    for (int32_t i = 0; i < rows; i++) {
+        const int32_t row = down ? y1 + i : y2 - i;
+        const double written = start_us + trans_us * (i + 1) / rows;
+        const double scan = floor((written - (double)row * te->period_us / te->lines) / te->period_us);
+        if (i == 0) {
+            first = scan;
+        } else if (scan != first) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Functionality test
+
+Purpose:
+    - Test that a band transfer started after the TE delay is not torn
+
+Procedure:
+    - Generate random scan timing, band, write direction, transfer time and time since TE
+    - If the delay is not 0, or the transfer can be done without tearing, the reference must not see tearing
+      at the delayed start. The delay must be shorter than two periods.
+*/
+TEST_CASE("TE delay functionality", "[te][functionality]")
+{
+    uint32_t x = 9;
+    uint32_t delayed = 0;
+    uint32_t checked = 0;
+
+    for (int i = 0; i < FUNC_CASES; i++) {
+        const lvgl_port_te_timing_t te = {
+            .period_us = 8000 + test_rand_next(&x) % 20000,
+            .lines = 64 + test_rand_next(&x) % 400,
+        };
+        const int32_t y1 = test_rand_next(&x) % te.lines;
+        const int32_t y2 = y1 + test_rand_next(&x) % (te.lines - y1);
+        const bool down = test_rand_next(&x) % 4;
+        const uint32_t trans_us = test_rand_next(&x) % te.period_us;
+        const uint32_t since_te = test_rand_next(&x) % (3 * te.period_us);
+
+        const uint32_t delay = lvgl_port_te_get_delay(&te, since_te, y1, y2, down, trans_us);
+        TEST_ASSERT_TRUE(delay < 2 * te.period_us);
+        delayed += (delay > 0);
+
+        const double rows_us = (double)(y2 - y1 + 1) * te.period_us / te.lines;
+        const double drift = down ? trans_us - rows_us : trans_us + rows_us;
+        if (delay == 0 && fabs(drift) + 2.0 * te.period_us / te.lines + 2 >= te.period_us) {
+            /* Can't be done without tearing */
+            continue;
+        }
+        if (ref_is_torn(&te, (double)since_te + delay, y1, y2, down, trans_us)) {
+            printf("Torn: period %"PRIu32", lines %"PRIu32", rows %"PRIi32"-%"PRIi32", down %d, trans %"PRIu32", since TE %"PRIu32", delay %"PRIu32"\n",
+                   te.period_us, te.lines, y1, y2, down, trans_us, since_te, delay);
+        }
+        TEST_ASSERT_FALSE(ref_is_torn(&te, (double)since_te + delay, y1, y2, down, trans_us));
+        checked++;
+    }
+    printf("TE delay: checked %"PRIu32" of %d cases, delayed %"PRIu32"\n", checked, FUNC_CASES, delayed);
+}
+
+typedef struct {
+    atomic_uint_fast64_t    te_time;    /* Time of the last TE pulse [ns] */
+    atomic_uint_fast32_t    period_us;  /* Measured TE period */
+    pthread_mutex_t         lock;
+    pthread_cond_t          cond;
+    bool                    flushing;
+} te_display_t;
+
+/* The same as the TE GPIO interrupt in the LVGL port: time of the pulse and the period */
+static void te_gpio_isr(sim_panel_t *panel, uint64_t te_ns, void *user_ctx)
+{
+    te_display_t *disp = user_ctx;
+    const uint64_t last = atomic_exchange(&disp->te_time, te_ns);
+    if (last) {
+        const uint32_t period = (te_ns - last) / 1000;
+        const uint32_t avg = atomic_load(&disp->period_us);
+        atomic_store(&disp->period_us, avg ? (avg * 7 + period) / 8 : period);
+    }
+}
+
+static bool te_flush_ready(sim_panel_t *panel, void *user_ctx)
+{
+    te_display_t *disp = user_ctx;
+    pthread_mutex_lock(&disp->lock);
+    disp->flushing = false;
+    pthread_cond_signal(&disp->cond);
+    pthread_mutex_unlock(&disp->lock);
+    return false;
+}
+
+static uint32_t te_run(bool te_sync, uint32_t *fps)
+{
+    te_display_t disp = { .flushing = false };
+    pthread_mutex_init(&disp.lock, NULL);
+    pthread_cond_init(&disp.cond, NULL);
+    const sim_panel_config_t config = {
+        .width = PANEL_W,
+        .height = PANEL_H,
+        .pclk_hz = PANEL_PCLK_HZ,
+        .bus_width = 1,
+        .trans_overhead_us = 30,
+        .trans_queue_depth = 2,
+        .refresh_us = PANEL_REFRESH,
+        .on_color_trans_done = te_flush_ready,
+        .on_te = te_gpio_isr,
+        .user_ctx = &disp,
+    };
+    sim_panel_t *panel = sim_panel_new(&config);
+    TEST_ASSERT_NOT_NULL(panel);
+    uint16_t *buf = malloc(PANEL_W * BAND_LINES * sizeof(uint16_t));
+    TEST_ASSERT_NOT_NULL(buf);
+    test_fill_random(buf, PANEL_W * BAND_LINES * sizeof(uint16_t), 1);
+
+    /* Wait for the period measurement */
+    test_sleep_until_ns(test_time_ns() + 3ULL * PANEL_REFRESH * 1000);
+
+    const uint32_t trans_us = sim_panel_get_trans_ns(panel, PANEL_W * BAND_LINES * 2 + 1) / 1000 + HOST_JITTER_US;
+    const uint64_t start = test_time_ns();
+    for (int frame = 0; frame < FRAMES; frame++) {
+        for (int y = 0; y < PANEL_H; y += BAND_LINES) {
+            pthread_mutex_lock(&disp.lock);
+            while (disp.flushing) {
+                pthread_cond_wait(&disp.cond, &disp.lock);
+            }
+            disp.flushing = true;
+            pthread_mutex_unlock(&disp.lock);
+
+            if (te_sync) {
+                const lvgl_port_te_timing_t te = {
+                    .period_us = atomic_load(&disp.period_us),
+                    .lines = PANEL_H,
+                };
+                const uint64_t now = test_time_ns();
+                const uint32_t since_te = (now - atomic_load(&disp.te_time)) / 1000;
+                const uint32_t delay = lvgl_port_te_get_delay(&te, since_te, y, y + BAND_LINES - 1, true, trans_us);
+                test_sleep_until_ns(now + delay * 1000ULL);
+            }
+            sim_panel_draw_bitmap(panel, 0, y, PANEL_W, y + BAND_LINES, buf);
+        }
+    }
+    sim_panel_wait_idle(panel);
+    *fps = (uint32_t)(FRAMES * 1000000000ULL / (test_time_ns() - start));
+
+    sim_panel_stats_t stats;
+    sim_panel_get_stats(panel, &stats);
+    sim_panel_del(panel);
+    free(buf);
+    pthread_cond_destroy(&disp.cond);
+    pthread_mutex_destroy(&disp.lock);
+
+    return stats.torn_trans;
+}
+
+/*
+Functionality test
+
+Purpose:
+    - Test that bands sent after the TE delay are not torn on a simulated panel, which scans its memory at 60 Hz
+
+Procedure:
+    - Measure the TE period from the pulses of the simulated TE GPIO
+    - Flush bands of frames without and with the TE delay, count torn transfers on the panel
+*/
+TEST_CASE("TE synchronized flush", "[te][functionality]")
+{
+    uint32_t fps_free, fps_sync;
+    const uint32_t torn_free = te_run(false, &fps_free);
+    const uint32_t torn_sync = te_run(true, &fps_sync);
+    printf("TE flush %dx%d, %d bands per frame: without TE %"PRIu32" torn, %"PRIu32" FPS; with TE %"PRIu32" torn, %"PRIu32" FPS\n",
+           PANEL_W, PANEL_H, PANEL_H / BAND_LINES, torn_free, fps_free, torn_sync, fps_sync);
+    TEST_ASSERT_TRUE(torn_sync * 4 <= torn_free);
+    TEST_ASSERT_TRUE(torn_sync <= 2);
+}
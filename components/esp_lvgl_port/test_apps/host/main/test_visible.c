@@ -0,0 +1,182 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "unity.h"
+#include "test_common.h"
+#include "esp_lvgl_port_visible.h"
+
+#define SCREEN_W        64
+#define SCREEN_H        48
+#define WINDOWS         200
+#define AREAS           200
+#define ROUND_SIZE      240
+#define PARTICLES       2000
+
+/* Reference: center of the pixel inside of the rounded rectangle [x1, x2 + 1) x [y1, y2 + 1) */
+static bool ref_pixel(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t radius, int32_t x, int32_t y)
+{
+    const double px = x + 0.5;
+    const double py = y + 0.5;
+    if (px < x1 || px > x2 + 1 || py < y1 || py > y2 + 1) {
+        return false;
+    }
+    const double cx = (px < x1 + radius ? x1 + radius : (px > x2 + 1 - radius ? x2 + 1 - radius : px));
+    const double cy = (py < y1 + radius ? y1 + radius : (py > y2 + 1 - radius ? y2 + 1 - radius : py));
+    return (px - cx) * (px - cx) + (py - cy) * (py - cy) <= (double)radius * radius;
+}
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Functionality test
+
+Purpose:
+    - Test that an area is clipped to the bounding box of its visible pixels, and that areas without visible pixels
+      are reported
+
+Procedure:
+    - Random visible windows on a small screen: rectangles, rounded corners, circles and stadiums
+    - Compare the visibility of each pixel with the reference of pixel centers in the rounded rectangle
+    - Clip random areas, partly out of the screen too, and compare them with the bounding box of the reference
+*/
+TEST_CASE("Visible window functionality", "[visible][functionality]")
+{
+    uint32_t x = 5;
+    unsigned int clipped = 0;
+    unsigned int hidden = 0;
+    for (int w = 0; w < WINDOWS; w++) {
+        const int32_t x1 = test_rand_next(&x) % (SCREEN_W / 4);
+        const int32_t y1 = test_rand_next(&x) % (SCREEN_H / 4);
+        const int32_t x2 = x1 + test_rand_next(&x) % (SCREEN_W - x1);
+        const int32_t y2 = (w % 4 == 0 ? y1 + (x2 - x1) : y1 + (int32_t)(test_rand_next(&x) % (SCREEN_H - y1)));
+        const int32_t radius = (w % 4 == 0 ? SCREEN_W : (int32_t)(test_rand_next(&x) % (SCREEN_H / 2 + 4)));
+        lvgl_port_visible_t vis;
+        lvgl_port_visible_init(&vis, x1, y1, x2, y2, radius);
+        TEST_ASSERT_TRUE(vis.radius <= (x2 - x1 + 1) / 2 && vis.radius <= (y2 - y1 + 1) / 2);
+
+        for (int32_t py = -1; py <= SCREEN_H + SCREEN_W; py++) {
+            for (int32_t px = -1; px <= SCREEN_W; px++) {
+                TEST_ASSERT_EQUAL(ref_pixel(x1, y1, x2, y2, vis.radius, px, py), lvgl_port_visible_pixel(&vis, px, py));
+            }
+        }
+
+        for (int a = 0; a < AREAS; a++) {
+            const int32_t ax1 = (int32_t)(test_rand_next(&x) % (SCREEN_W + 8)) - 4;
+            const int32_t ay1 = (int32_t)(test_rand_next(&x) % (SCREEN_H + 8)) - 4;
+            const int32_t ax2 = ax1 + (a % 8 == 0 ? SCREEN_W : (int32_t)(test_rand_next(&x) % 12));
+            const int32_t ay2 = ay1 + (a % 8 == 0 ? SCREEN_H : (int32_t)(test_rand_next(&x) % 12));
+
+            /* Bounding box of the visible pixels */
+            int32_t bx1 = INT32_MAX;
+            int32_t by1 = INT32_MAX;
+            int32_t bx2 = INT32_MIN;
+            int32_t by2 = INT32_MIN;
+            for (int32_t py = ay1; py <= ay2; py++) {
+                for (int32_t px = ax1; px <= ax2; px++) {
+                    if (ref_pixel(x1, y1, x2, y2, vis.radius, px, py)) {
+                        bx1 = (px < bx1 ? px : bx1);
+                        by1 = (py < by1 ? py : by1);
+                        bx2 = (px > bx2 ? px : bx2);
+                        by2 = (py > by2 ? py : by2);
+                    }
+                }
+            }
+
+            int32_t cx1 = ax1;
+            int32_t cy1 = ay1;
+            int32_t cx2 = ax2;
+            int32_t cy2 = ay2;
+            const bool visible = lvgl_port_visible_clip(&vis, &cx1, &cy1, &cx2, &cy2);
+            TEST_ASSERT_EQUAL(bx1 != INT32_MAX, visible);
+            if (!visible) {
+                TEST_ASSERT_TRUE(cx1 == ax1 && cy1 == ay1 && cx2 == ax2 && cy2 == ay2);
+                hidden++;
+                continue;
+            }
+            if (cx1 != bx1 || cy1 != by1 || cx2 != bx2 || cy2 != by2) {
+                printf("Window (%"PRIi32",%"PRIi32")-(%"PRIi32",%"PRIi32") r %"PRIi32", area (%"PRIi32",%"PRIi32")-(%"PRIi32",%"PRIi32")\n",
+                       x1, y1, x2, y2, vis.radius, ax1, ay1, ax2, ay2);
+            }
+            TEST_ASSERT_EQUAL_INT32(bx1, cx1);
+            TEST_ASSERT_EQUAL_INT32(by1, cy1);
+            TEST_ASSERT_EQUAL_INT32(bx2, cx2);
+            TEST_ASSERT_EQUAL_INT32(by2, cy2);
+            clipped++;
+        }
+    }
+    printf("Visible window: %u areas clipped, %u areas without visible pixels\n", clipped, hidden);
+    TEST_ASSERT_TRUE(clipped > 0 && hidden > 0);
+}
+
+/*
+Functionality test
+
+Purpose:
+    - Report the pixels of invalidated areas, which are not rendered on a round display
+
+Procedure:
+    - Small areas (particles) and bands of a 240x240 round display are clipped to the circle
+    - The skipped pixels are the pixels of the areas out of the clipped areas, the corners of the particles
+      at the edge of the circle are rendered
+*/
+TEST_CASE("Visible window of round display", "[visible][functionality]")
+{
+    lvgl_port_visible_t vis;
+    lvgl_port_visible_init(&vis, 0, 0, ROUND_SIZE - 1, ROUND_SIZE - 1, ROUND_SIZE / 2);
+
+    /* Visible pixels of the circle */
+    uint32_t visible_px = 0;
+    for (int32_t y = 0; y < ROUND_SIZE; y++) {
+        for (int32_t x = 0; x < ROUND_SIZE; x++) {
+            visible_px += lvgl_port_visible_pixel(&vis, x, y);
+        }
+    }
+    const double circle = 3.14159265 * (ROUND_SIZE / 2) * (ROUND_SIZE / 2);
+    TEST_ASSERT_TRUE(visible_px > circle * 0.99 && visible_px < circle * 1.01);
+
+    /* Particles of 8x8 pixels anywhere on the screen */
+    uint32_t x = 3;
+    uint64_t area_px = 0;
+    uint64_t clipped_px = 0;
+    uint32_t hidden = 0;
+    for (int i = 0; i < PARTICLES; i++) {
+        int32_t x1 = test_rand_next(&x) % (ROUND_SIZE - 8);
+        int32_t y1 = test_rand_next(&x) % (ROUND_SIZE - 8);
+        int32_t x2 = x1 + 7;
+        int32_t y2 = y1 + 7;
+        area_px += 64;
+        if (!lvgl_port_visible_clip(&vis, &x1, &y1, &x2, &y2)) {
+            hidden++;
+            continue;
+        }
+        clipped_px += (uint64_t)(x2 - x1 + 1) * (y2 - y1 + 1);
+    }
+    printf("Round display %dx%d: %"PRIu32" visible pixels (%"PRIu32"%%), particles: %"PRIu32" of %d hidden, %"PRIu64"%% of pixels skipped\n",
+           ROUND_SIZE, ROUND_SIZE, visible_px, (uint32_t)((uint64_t)visible_px * 100 / (ROUND_SIZE * ROUND_SIZE)),
+           hidden, PARTICLES, (area_px - clipped_px) * 100 / area_px);
+    TEST_ASSERT_TRUE(hidden > 0);
+    TEST_ASSERT_TRUE((area_px - clipped_px) * 100 / area_px >= 15);
+
+    /* Full-width bands: the rows are kept, the columns are clipped by the widest row of the band */
+    uint64_t band_px = 0;
+    for (int32_t y = 0; y < ROUND_SIZE; y += 20) {
+        int32_t x1 = 0;
+        int32_t y1 = y;
+        int32_t x2 = ROUND_SIZE - 1;
+        int32_t y2 = y + 19;
+        TEST_ASSERT_TRUE(lvgl_port_visible_clip(&vis, &x1, &y1, &x2, &y2));
+        TEST_ASSERT_EQUAL_INT32(y, y1);
+        TEST_ASSERT_EQUAL_INT32(y + 19, y2);
+        const bool middle = (y <= ROUND_SIZE / 2 && y + 19 >= ROUND_SIZE / 2 - 1);
+        TEST_ASSERT_EQUAL(middle, x1 == 0);
+        TEST_ASSERT_EQUAL_INT32(ROUND_SIZE - 1 - x1, x2);
+        band_px += (uint64_t)(x2 - x1 + 1) * (y2 - y1 + 1);
+    }
+    TEST_ASSERT_TRUE(band_px < ROUND_SIZE * ROUND_SIZE);
+}
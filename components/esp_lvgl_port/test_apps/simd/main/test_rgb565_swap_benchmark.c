@@ -0,0 +1,126 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <malloc.h>
+#include <sdkconfig.h>
+
+#include "unity.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"  // for xthal_get_ccount()
+#include "esp_lvgl_port_color.h"
+
+#define WIDTH 240
+#define HEIGHT 40
+#define UNALIGN_BYTES 2
+#define BENCHMARK_CYCLES 1000
+
+// ------------------------------------------------- Macros and Types --------------------------------------------------
+
+static const char *TAG_SWAP_BENCH = "RGB565 Swap Benchmark";
+static const char *accel_ansi_func[] = {"Accelerated", "ANSI"};
+
+// ------------------------------------------------ Static function headers --------------------------------------------
+
+/**
+ * @brief Hard copy of lv_draw_sw_rgb565_swap() from LVGL 9.2, used by the flush callback before
+ */
+static void lv_draw_sw_rgb565_swap_ansi(void *buf, uint32_t buf_size_px);
+
+/**
+ * @brief Run the benchmark test
+ */
+static float rgb565_swap_benchmark_run(void (*swap_func)(void *, uint32_t), void *buf, uint32_t len_px);
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Benchmark tests
+
+Requires:
+    - To pass functionality tests first
+
+Purpose:
+    - Test that an acceleration is achieved by the port byte swap, on a typical partial buffer (240x40)
+
+Procedure:
+    - Run the port byte swap multiple times (1000-times or so) on a 16-byte aligned buffer and on a 2-byte aligned buffer
+    - Count how many CPU cycles does it take to swap the buffer
+    - Repeat above steps for the ANSI version (LVGL lv_draw_sw_rgb565_swap)
+*/
+
+TEST_CASE("RGB565 swap benchmark", "[swap][benchmark][RGB565]")
+{
+    const uint32_t len_px = WIDTH * HEIGHT;
+    uint16_t *buf_align16 = (uint16_t *)memalign(16, len_px * sizeof(uint16_t) + UNALIGN_BYTES * 2);
+    TEST_ASSERT_NOT_EQUAL(NULL, buf_align16);
+
+    // Apply 2-byte unalignment for the worst-case test scenario
+    uint16_t *buf_align2 = buf_align16 + 1;
+
+    void (*swap_funcs[])(void *, uint32_t) = {lvgl_port_rgb565_swap, lv_draw_sw_rgb565_swap_ansi};
+    for (int i = 0; i < 2; i++) {
+        float cycles = rgb565_swap_benchmark_run(swap_funcs[i], buf_align16, len_px);
+        ESP_LOGI(TAG_SWAP_BENCH, " %s ideal case: %.3f cycles for %dx%d buffer, %.3f cycles per sample", accel_ansi_func[i], cycles, WIDTH, HEIGHT, cycles / len_px);
+
+        // LVGL version expects 4-byte aligned buffer, 2-byte aligned buffer is measured only for the port version
+        if (i == 0) {
+            cycles = rgb565_swap_benchmark_run(swap_funcs[i], buf_align2, len_px - 1);
+            ESP_LOGI(TAG_SWAP_BENCH, " %s corner case: %.3f cycles for %d px buffer, %.3f cycles per sample\n", accel_ansi_func[i], cycles, WIDTH * HEIGHT - 1, cycles / (len_px - 1));
+        }
+    }
+
+    free(buf_align16);
+}
+
+// ------------------------------------------------ Static test functions ----------------------------------------------
+
+static void lv_draw_sw_rgb565_swap_ansi(void *buf, uint32_t buf_size_px)
+{
+    uint32_t u32_cnt = buf_size_px / 2;
+    uint16_t *buf16 = buf;
+    uint32_t *buf32 = buf;
+
+    while (u32_cnt >= 8) {
+        buf32[0] = ((buf32[0] & 0xff00ff00) >> 8) | ((buf32[0] & 0x00ff00ff) << 8);
+        buf32[1] = ((buf32[1] & 0xff00ff00) >> 8) | ((buf32[1] & 0x00ff00ff) << 8);
+        buf32[2] = ((buf32[2] & 0xff00ff00) >> 8) | ((buf32[2] & 0x00ff00ff) << 8);
+        buf32[3] = ((buf32[3] & 0xff00ff00) >> 8) | ((buf32[3] & 0x00ff00ff) << 8);
+        buf32[4] = ((buf32[4] & 0xff00ff00) >> 8) | ((buf32[4] & 0x00ff00ff) << 8);
+        buf32[5] = ((buf32[5] & 0xff00ff00) >> 8) | ((buf32[5] & 0x00ff00ff) << 8);
+        buf32[6] = ((buf32[6] & 0xff00ff00) >> 8) | ((buf32[6] & 0x00ff00ff) << 8);
+        buf32[7] = ((buf32[7] & 0xff00ff00) >> 8) | ((buf32[7] & 0x00ff00ff) << 8);
+        buf32 += 8;
+        u32_cnt -= 8;
+    }
+
+    while (u32_cnt) {
+        *buf32 = ((*buf32 & 0xff00ff00) >> 8) | ((*buf32 & 0x00ff00ff) << 8);
+        buf32++;
+        u32_cnt--;
+    }
+
+    if (buf_size_px & 0x1) {
+        uint32_t e = buf_size_px - 1;
+        buf16[e] = ((buf16[e] & 0xff00) >> 8) | ((buf16[e] & 0x00ff) << 8);
+    }
+}
+
+static float rgb565_swap_benchmark_run(void (*swap_func)(void *, uint32_t), void *buf, uint32_t len_px)
+{
+    // Call the DUT function for the first time to init the benchmark test
+    swap_func(buf, len_px);
+
+    const unsigned int start_b = xthal_get_ccount();
+    for (int i = 0; i < BENCHMARK_CYCLES; i++) {
+        swap_func(buf, len_px);
+    }
+    const unsigned int end_b = xthal_get_ccount();
+
+    const float total_b = end_b - start_b;
+    const float cycles = total_b / BENCHMARK_CYCLES;
+    return cycles;
+}
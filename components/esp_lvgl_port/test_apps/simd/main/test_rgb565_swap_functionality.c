@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <malloc.h>
+#include <inttypes.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_lvgl_port_color.h"
+
+// ------------------------------------------------- Defines -----------------------------------------------------------
+
+#define CANARY_BYTES 16
+#define CANARY 0xA5
+#define MAX_LEN_PX 80
+#define MAX_UNALIGN_BYTE 16
+
+static const char *TAG_SWAP_FUNC = "RGB565 Swap Functionality";
+
+// ------------------------------------------------ Static function headers --------------------------------------------
+
+/**
+ * @brief ANSI version of the byte swap, one pixel at a time
+ */
+static void rgb565_swap_ansi(uint8_t *buf, uint32_t len_px);
+
+// ------------------------------------------------ Test cases ---------------------------------------------------------
+
+/*
+Functionality tests
+
+Purpose:
+    - Test that the accelerated RGB565 byte swap (PIE on esp32s3, word-wise C otherwise) gives the same results as the ANSI version
+
+Procedure:
+    - Prepare random buffers of all lengths up to MAX_LEN_PX pixels, with all 2-byte unalignments up to 16 bytes
+    - Run the accelerated byte swap
+    - Run ANSI C version of the byte swap
+    - Compare the results, including canary bytes around the buffer
+*/
+
+TEST_CASE("Test rgb565 swap functionality", "[swap][functionality][RGB565]")
+{
+    const size_t total_len = MAX_LEN_PX * sizeof(uint16_t) + MAX_UNALIGN_BYTE + CANARY_BYTES * 2;
+    uint8_t *buf_asm = (uint8_t *)memalign(16, total_len);
+    uint8_t *buf_ansi = (uint8_t *)memalign(16, total_len);
+    TEST_ASSERT_NOT_EQUAL(NULL, buf_asm);
+    TEST_ASSERT_NOT_EQUAL(NULL, buf_ansi);
+
+    unsigned int combinations = 0;
+    for (uint32_t len = 0; len <= MAX_LEN_PX; len++) {
+        for (unsigned int unalign = 0; unalign < MAX_UNALIGN_BYTE; unalign += 2) {
+            memset(buf_asm, CANARY, total_len);
+            for (uint32_t i = 0; i < len * sizeof(uint16_t); i++) {
+                buf_asm[CANARY_BYTES + unalign + i] = (uint8_t)(rand() & 0xff);
+            }
+            memcpy(buf_ansi, buf_asm, total_len);
+
+            lvgl_port_rgb565_swap(buf_asm + CANARY_BYTES + unalign, len);
+            rgb565_swap_ansi(buf_ansi + CANARY_BYTES + unalign, len);
+
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(buf_ansi, buf_asm, total_len);
+            combinations++;
+        }
+    }
+    ESP_LOGI(TAG_SWAP_FUNC, "test combinations: %u\n", combinations);
+
+    free(buf_asm);
+    free(buf_ansi);
+}
+
+// ------------------------------------------------ Static test functions ----------------------------------------------
+
+static void rgb565_swap_ansi(uint8_t *buf, uint32_t len_px)
+{
+    for (uint32_t i = 0; i < len_px; i++) {
+        uint8_t tmp = buf[2 * i];
+        buf[2 * i] = buf[2 * i + 1];
+        buf[2 * i + 1] = tmp;
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCENE_BUILDER_DEFAULT_BUDGET_US 2000
+
+/**
+ * Called once per queued step. `index` is the position of the step inside the
+ * batch it was queued with (see scene_builder_add_steps), 0 for single steps.
+ */
+typedef void (*scene_builder_step_cb_t)(void* user_data, uint32_t index);
+
+typedef void (*scene_builder_done_cb_t)(void* user_data);
+
+typedef struct scene_builder_t scene_builder_t;
+
+/**
+ * Create a builder that runs at most `budget_us` worth of steps per LVGL timer tick.
+ * Steps run from an LVGL timer, so they already hold the LVGL lock.
+ */
+scene_builder_t* scene_builder_create(uint32_t budget_us);
+
+/**
+ * Run the steps every `period_ms` instead of on every lv_timer_handler() call.
+ * Together with the budget this caps the CPU share, e.g. 2 ms every 10 ms for background work.
+ */
+void scene_builder_set_period(scene_builder_t* builder, uint32_t period_ms);
+
+void scene_builder_add_step(scene_builder_t* builder, scene_builder_step_cb_t cb, void* user_data);
+
+/**
+ * Queue `count` calls of `cb`, with index 0..count-1.
+ */
+void scene_builder_add_steps(scene_builder_t* builder, scene_builder_step_cb_t cb, void* user_data, uint32_t count);
+
+/**
+ * Start running the queued steps on successive lv_timer_handler() calls.
+ * `done_cb` is called after the last step, then the builder frees itself.
+ */
+void scene_builder_start(scene_builder_t* builder, scene_builder_done_cb_t done_cb, void* user_data);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "scene_builder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct scene_preload_t scene_preload_t;
+
+/**
+ * Start building a scene in the background with `builder`.
+ * The steps should create their objects on a screen that is not loaded yet, so the
+ * expensive part (image header parsing, GIF decoding, ...) happens before the scene is shown.
+ * The builder budget and scene_builder_set_period() bound the CPU it takes.
+ */
+scene_preload_t* scene_preload_start(scene_builder_t* builder);
+
+/**
+ * Call `show_cb` as soon as the preload is done: right away when it already is,
+ * otherwise after its last step. The preload is freed afterwards.
+ */
+void scene_preload_show(scene_preload_t* preload, scene_builder_done_cb_t show_cb, void* user_data);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A static stack of an opaque background and a constant full-screen overlay.
+ *
+ * Blending the overlay over every dirty area costs a full extra pass per frame.
+ * Since overlay(obj over bg) == recolor(obj, overlay) over overlay(bg), the stack can be
+ * resolved once: the background gets the pre-mixed color and every image drawn between
+ * the two layers gets the overlay baked into its pixels.
+ */
+typedef struct {
+    lv_color_t bg_color;
+    lv_color_t overlay_color;
+    lv_opa_t overlay_opa;
+} static_layer_t;
+
+/**
+ * Background color with the overlay already applied.
+ */
+lv_color_t static_layer_get_bg_color(const static_layer_t* layer);
+
+/**
+ * Return a copy of `src` with the overlay folded into its color channels, alpha is kept as is.
+ * Only RGB565 and RGB565A8 images are supported. NULL is returned for other formats, when the cache
+ * of 8 folded images is full or when there is not enough memory.
+ * The result is cached per layer and source, so it's fine to call this for every object.
+ */
+const lv_image_dsc_t* static_layer_fold_image(const static_layer_t* layer, const lv_image_dsc_t* src);
+
+#ifdef __cplusplus
+}
+#endif
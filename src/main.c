@@ -1,7 +1,8 @@
+#include <assert.h>
+
 #include "freertos/FreeRTOS.h"
 
 #include "esp_log.h"
-#include "esp_random.h"
 
 #include "lvgl.h"
 #include "esp_lvgl_port.h"
@@ -11,13 +12,49 @@
 #include "driver/gpio.h"
 #include "driver/spi_common.h"
 
+#include "scene_builder.h"
+#include "scene_preload.h"
+#include "static_layer.h"
+
 #define MATH_PI 3.1415926
 
 #define PERF_MEM_USAGE 0
+// log FPS and the time LVGL waits for a free draw buffer, to pick DISP_RING_BUFFERS
+#define PERF_FLUSH_STATS 0
+// drive LVGL from a synthetic 10 ms clock, so every run renders the same frames
+#define PERF_REPLAY 0
+#define PERF_REPLAY_TICK_PERIOD_MS 10
+// refresh on a fixed 30 FPS cadence and sleep between frames, 0: as fast as LVGL timers ask;
+// frame interval deviation and slack are logged with PERF_FLUSH_STATS
+#define PERF_TARGET_FPS 0
+
+#define SCENE_RANDOM_SEED 0x6c76676cULL
 
 #define DISP_WIDTH 240
 #define DISP_HEIGHT 240
 #define DISP_DRAW_BUFFER_HEIGHT 40
+// resize the draw buffers to the smallest size close to the best FPS, DISP_DRAW_BUFFER_HEIGHT is the initial size;
+// the chosen size is logged with PERF_FLUSH_STATS and can be pinned in DISP_DRAW_BUFFER_HEIGHT
+#define DISP_BUFF_TUNE 0
+#define DISP_BUFF_TUNE_MAX_BYTES (2 * DISP_WIDTH * 120 * sizeof(uint16_t))
+// 3..4: render into a ring of partial buffers while the previous ones are sent over SPI, 0: double buffer
+#define DISP_RING_BUFFERS 0
+// send only rows, which differ from the panel content (fading particles often re-render the same pixels)
+#define DISP_DIFF_FLUSH 0
+// send 12-bit RGB444 instead of RGB565 (25% less SPI data), with ordered dithering
+#define DISP_RGB444 0
+// send the next band of the same dirty area with RAMWRC, without CASET/RASET (uses DISP_GAP_X/Y)
+#define DISP_CHAIN_BANDS 0
+// send bands up to this size by polling (small particle areas), 0: always queued; compare the times with PERF_FLUSH_STATS
+#define DISP_POLL_MAX_BYTES 0
+// round display (radius DISP_WIDTH / 2) or rounded corners: hidden pixels are not rendered nor sent, 0: whole screen
+#define DISP_VISIBLE_RADIUS 0
+#define DISP_GAP_X 0
+#define DISP_GAP_Y 80
+// merge nearby dirty areas, when one transfer is cheaper: CASET + RASET + RAMWR overhead and 40 MHz SPI (5 bytes/us)
+#define DISP_AREA_MERGE 1
+#define DISP_TRANS_OVERHEAD_US 30
+#define DISP_SPI_BYTES_PER_US 5
 #define DISP_GPIO_RES GPIO_NUM_0
 #define DISP_GPIO_DC GPIO_NUM_1
 #define DISP_SCLK GPIO_NUM_4
@@ -33,14 +70,35 @@
 #define PARTICLE_HORIZONTAL_BOUND_MIN (-96)
 #define PARTICLE_HORIZONTAL_BOUND_MAX 96
 
+// background build of the main scene during the logo fade: 2 ms of work every 10 ms
+#define SCENE_PRELOAD_BUDGET_US 2000
+#define SCENE_PRELOAD_PERIOD_MS 10
+
+typedef struct {
+    lv_obj_t** objs;
+    lv_anim_timeline_t** timelines;
+    size_t size;
+    const lv_image_dsc_t* dsc;
+} particle_pool_t;
+
 static esp_lcd_panel_handle_t main_lcd_panel_handle;
 static lv_disp_t* lvgl_main_display_handle;
 
+// darkening mask between the particles and the pickaxe, resolved once instead of blended every frame
+static const static_layer_t main_scene_mask = {
+        .bg_color = LV_COLOR_MAKE(0x00, 0x00, 0x00),
+        .overlay_color = LV_COLOR_MAKE(0x00, 0x00, 0x00),
+        .overlay_opa = 160,
+};
+
+static lv_obj_t* main_scene;
+static scene_preload_t* main_scene_preload;
+
 static lv_obj_t* lv_image_diamond_pickaxe;
-static lv_obj_t** lv_image_diamonds;
-static lv_obj_t** lv_image_emeralds;
-static lv_obj_t** lv_image_iron_ingots;
-static lv_obj_t** lv_image_gold_ingots;
+static particle_pool_t lv_image_diamonds;
+static particle_pool_t lv_image_emeralds;
+static particle_pool_t lv_image_iron_ingots;
+static particle_pool_t lv_image_gold_ingots;
 
 void init_spi_bus(){
     const spi_bus_config_t buscfg = {
@@ -56,8 +114,11 @@ void init_spi_bus(){
 
 
 void init_lvgl_disp(){
-    const lvgl_port_cfg_t lvgl_cfg = ESP_LVGL_PORT_INIT_CONFIG();
+    lvgl_port_cfg_t lvgl_cfg = ESP_LVGL_PORT_INIT_CONFIG();
+    lvgl_cfg.target_fps = PERF_TARGET_FPS;
     ESP_ERROR_CHECK(lvgl_port_init(&lvgl_cfg));
+    // fixed seed: particle positions and timings are the same on every run
+    lvgl_port_rand_seed(SCENE_RANDOM_SEED);
 
     /* LCD IO */
     esp_lcd_panel_io_handle_t io_handle = NULL;
@@ -89,7 +150,6 @@ void init_lvgl_disp(){
     esp_lcd_panel_disp_on_off(main_lcd_panel_handle, false);
     // depend on hardware
     esp_lcd_panel_invert_color(main_lcd_panel_handle, true);
-    esp_lcd_panel_set_gap(main_lcd_panel_handle, 0, 80);
 
     /* Add LCD screen */
     const lvgl_port_display_cfg_t disp_cfg = {
@@ -101,6 +161,26 @@ void init_lvgl_disp(){
             .vres = DISP_HEIGHT,
             .monochrome = false,
             .color_format = LV_COLOR_FORMAT_RGB565,
+            .ring_buffers = DISP_RING_BUFFERS,
+            .poll_max_bytes = DISP_POLL_MAX_BYTES,
+#if DISP_VISIBLE_RADIUS > 0
+            .visible = {
+                    .width = DISP_WIDTH,
+                    .height = DISP_HEIGHT,
+                    .radius = DISP_VISIBLE_RADIUS,
+            },
+#endif
+            .buff_tune = {
+                    .enable = DISP_BUFF_TUNE,
+                    .max_bytes = DISP_BUFF_TUNE_MAX_BYTES,
+            },
+            .output = {
+                    .cmd_set = LVGL_PORT_PANEL_CMD_DCS,
+                    .rgb444 = DISP_RGB444,
+                    .dither = true,
+                    .x_gap = DISP_GAP_X,
+                    .y_gap = DISP_GAP_Y,
+            },
             .rotation = {
                     .swap_xy = false,
                     .mirror_x = true,
@@ -108,16 +188,30 @@ void init_lvgl_disp(){
             },
             .flags = {
                     .buff_dma = true,
-                    .swap_bytes = true,
+                    // RGB444 is packed in panel byte order
+                    .swap_bytes = !DISP_RGB444,
+                    .diff_flush = DISP_DIFF_FLUSH,
+                    .chain_bands = DISP_CHAIN_BANDS,
             }
     };
 
+    // RGB444 pixels, chained bands and polled transfers bypass the panel driver, both take the gap from the port config
+    esp_lcd_panel_set_gap(main_lcd_panel_handle, disp_cfg.output.x_gap, disp_cfg.output.y_gap);
+
     lvgl_main_display_handle = lvgl_port_add_disp(&disp_cfg);
+
+#if DISP_AREA_MERGE == 1
+    const lvgl_port_area_cost_cfg_t area_cost = {
+            .trans_overhead_us = DISP_TRANS_OVERHEAD_US,
+            .bytes_per_us = DISP_SPI_BYTES_PER_US,
+    };
+    ESP_ERROR_CHECK(lvgl_port_disp_set_area_cost(lvgl_main_display_handle, &area_cost));
+#endif
 }
 
 void anim_move_particle_randomly_on_start(lv_anim_t* animation) {
-    int32_t x = PARTICLE_HORIZONTAL_BOUND_MIN + esp_random() %  (PARTICLE_HORIZONTAL_BOUND_MAX - PARTICLE_HORIZONTAL_BOUND_MIN);
-    int32_t y = PARTICLE_VERTICAL_BOUND_MIN + esp_random() %  (PARTICLE_VERTICAL_BOUND_MAX - PARTICLE_VERTICAL_BOUND_MIN);
+    int32_t x = PARTICLE_HORIZONTAL_BOUND_MIN + lvgl_port_rand_bounded(PARTICLE_HORIZONTAL_BOUND_MAX - PARTICLE_HORIZONTAL_BOUND_MIN);
+    int32_t y = PARTICLE_VERTICAL_BOUND_MIN + lvgl_port_rand_bounded(PARTICLE_VERTICAL_BOUND_MAX - PARTICLE_VERTICAL_BOUND_MIN);
 
     lv_obj_set_pos(animation->var, x, y);
 }
@@ -126,64 +220,80 @@ void anim_cb_set_opa(lv_anim_t* anim, int32_t value){
     lv_obj_set_style_image_opa(anim->var, value, 0);
 }
 
-lv_obj_t** init_particle_pool(size_t size, const lv_image_dsc_t* dsc){
-    lv_obj_t** pool = calloc(size, sizeof(lv_obj_t*));
-    for (int i = 0; i < size; ++i) {
-        pool[i] = lv_image_create(lv_screen_active());
-        lv_image_set_src(pool[i], dsc);
-        lv_obj_align(pool[i], LV_ALIGN_CENTER, 0, 0);
-        lv_obj_set_style_image_opa(pool[i], 0, 0);
-
-        lv_anim_t fade_in_anim;
-        lv_anim_init(&fade_in_anim);
-        lv_anim_set_var(&fade_in_anim, pool[i]);
-        lv_anim_set_duration(&fade_in_anim, 3000);
-        lv_anim_set_values(&fade_in_anim, 0, 255);
-        lv_anim_set_path_cb(&fade_in_anim, lv_anim_path_ease_in_out);
-        lv_anim_set_start_cb(&fade_in_anim, anim_move_particle_randomly_on_start);
-        lv_anim_set_custom_exec_cb(&fade_in_anim, anim_cb_set_opa);
-
-        lv_anim_t fade_out_anim;
-        lv_anim_init(&fade_out_anim);
-        lv_anim_set_var(&fade_out_anim, pool[i]);
-        lv_anim_set_duration(&fade_out_anim, 3000);
-        lv_anim_set_values(&fade_out_anim, 255, 0);
-        lv_anim_set_path_cb(&fade_out_anim, lv_anim_path_ease_in_out);
-        lv_anim_set_custom_exec_cb(&fade_out_anim, anim_cb_set_opa);
-
-        lv_anim_timeline_t* timeline = lv_anim_timeline_create();
-        lv_anim_timeline_add(timeline, esp_random() % 2048, &fade_in_anim);
-        lv_anim_timeline_add(timeline, lv_anim_timeline_get_playtime(timeline), &fade_out_anim);
-        lv_anim_timeline_set_repeat_delay(timeline, esp_random() % 1024);
-        lv_anim_timeline_set_repeat_count(timeline, LV_ANIM_REPEAT_INFINITE);
-
-        lv_anim_timeline_start(timeline);
-    }
-    return pool;
+void init_particle(void* user_data, uint32_t index){
+    particle_pool_t* pool = user_data;
+    lv_obj_t* particle = lv_image_create(main_scene);
+    lv_image_set_src(particle, pool->dsc);
+    lv_obj_align(particle, LV_ALIGN_CENTER, 0, 0);
+    lv_obj_set_style_image_opa(particle, 0, 0);
+    pool->objs[index] = particle;
+
+    lv_anim_t fade_in_anim;
+    lv_anim_init(&fade_in_anim);
+    lv_anim_set_var(&fade_in_anim, particle);
+    lv_anim_set_duration(&fade_in_anim, 3000);
+    lv_anim_set_values(&fade_in_anim, 0, 255);
+    lv_anim_set_path_cb(&fade_in_anim, lv_anim_path_ease_in_out);
+    lv_anim_set_start_cb(&fade_in_anim, anim_move_particle_randomly_on_start);
+    lv_anim_set_custom_exec_cb(&fade_in_anim, anim_cb_set_opa);
+
+    lv_anim_t fade_out_anim;
+    lv_anim_init(&fade_out_anim);
+    lv_anim_set_var(&fade_out_anim, particle);
+    lv_anim_set_duration(&fade_out_anim, 3000);
+    lv_anim_set_values(&fade_out_anim, 255, 0);
+    lv_anim_set_path_cb(&fade_out_anim, lv_anim_path_ease_in_out);
+    lv_anim_set_custom_exec_cb(&fade_out_anim, anim_cb_set_opa);
+
+    lv_anim_timeline_t* timeline = lv_anim_timeline_create();
+    lv_anim_timeline_add(timeline, lvgl_port_rand_bounded(2048), &fade_in_anim);
+    lv_anim_timeline_add(timeline, lv_anim_timeline_get_playtime(timeline), &fade_out_anim);
+    lv_anim_timeline_set_repeat_delay(timeline, lvgl_port_rand_bounded(1024));
+    lv_anim_timeline_set_repeat_count(timeline, LV_ANIM_REPEAT_INFINITE);
+    // started when the scene is shown
+    pool->timelines[index] = timeline;
 }
 
-void anim_intro_end(lv_anim_t* anim){
-    LV_IMAGE_DECLARE(image_diamond_pickaxe);
-    LV_IMAGE_DECLARE(image_diamond);
-    LV_IMAGE_DECLARE(image_emerald);
-    LV_IMAGE_DECLARE(image_iron_ingot);
-    LV_IMAGE_DECLARE(image_gold_ingot);
+void init_particle_pool(scene_builder_t* builder, particle_pool_t* pool, size_t size, const lv_image_dsc_t* dsc){
+    pool->objs = calloc(size, sizeof(lv_obj_t*));
+    pool->timelines = calloc(size, sizeof(lv_anim_timeline_t*));
+    pool->size = size;
+    // particles are drawn below the mask, so they use the pre-darkened copy of the sprite
+    pool->dsc = static_layer_fold_image(&main_scene_mask, dsc);
+    // the original sprite would be drawn without the darkening, the mask object is gone
+    assert(pool->dsc != NULL);
+    // one particle (image + timeline) per step, so the pool is spread over several ticks
+    scene_builder_add_steps(builder, init_particle, pool, size);
+}
 
-    lv_image_diamonds = init_particle_pool(PARTICLE_DIAMOND_POOL_SIZE, &image_diamond);
-    lv_image_emeralds = init_particle_pool(PARTICLE_EMERALD_POOL_SIZE, &image_emerald);
-    lv_image_iron_ingots = init_particle_pool(PARTICLE_IRON_INGOT_POOL_SIZE, &image_iron_ingot);
-    lv_image_gold_ingots = init_particle_pool(PARTICLE_GOLD_INGOT_POOL_SIZE, &image_gold_ingot);
+void start_particle_pool(particle_pool_t* pool){
+    for (int i = 0; i < pool->size; ++i) {
+        lv_anim_timeline_start(pool->timelines[i]);
+    }
+}
 
-    lv_obj_t * mask = lv_obj_create(lv_screen_active());
-    lv_obj_set_size(mask , 240, 240);
-    lv_obj_align(mask, LV_ALIGN_CENTER, 0, 0);
-    lv_obj_set_style_bg_color(mask ,lv_color_hex(0x000000), 0);
-    lv_obj_set_style_border_opa(mask ,LV_OPA_TRANSP, 0);
-    lv_obj_set_style_opa(mask ,160, 0);
+void init_diamond_pickaxe(void* user_data, uint32_t index){
+    LV_IMAGE_DECLARE(image_diamond_pickaxe);
 
-    lv_image_diamond_pickaxe = lv_gif_create(lv_screen_active());
+    lv_image_diamond_pickaxe = lv_gif_create(main_scene);
+    // parses the header and decodes the first frame
     lv_gif_set_src(lv_image_diamond_pickaxe, &image_diamond_pickaxe);
     lv_obj_align(lv_image_diamond_pickaxe, LV_ALIGN_CENTER, 0, 0);
+    lv_obj_set_style_image_opa(lv_image_diamond_pickaxe, LV_OPA_TRANSP, 0);
+    // don't decode frames nobody can see yet
+    lv_gif_pause(lv_image_diamond_pickaxe);
+}
+
+void show_main_scene(void* user_data){
+    lv_obj_t* intro_scene = lv_screen_active();
+    lv_screen_load(main_scene);
+    lv_obj_delete_async(intro_scene);
+
+    start_particle_pool(&lv_image_diamonds);
+    start_particle_pool(&lv_image_emeralds);
+    start_particle_pool(&lv_image_iron_ingots);
+    start_particle_pool(&lv_image_gold_ingots);
+    lv_gif_resume(lv_image_diamond_pickaxe);
 
     lv_anim_t fade_in_anim;
     lv_anim_init(&fade_in_anim);
@@ -194,8 +304,32 @@ void anim_intro_end(lv_anim_t* anim){
     lv_anim_set_custom_exec_cb(&fade_in_anim, anim_cb_set_opa);
 
     lv_anim_start(&fade_in_anim);
+}
+
+void anim_intro_end(lv_anim_t* anim){
+    // usually preloaded by now, so this only loads the prepared screen
+    scene_preload_show(main_scene_preload, show_main_scene, NULL);
+}
+
+void preload_main_scene(void){
+    LV_IMAGE_DECLARE(image_diamond);
+    LV_IMAGE_DECLARE(image_emerald);
+    LV_IMAGE_DECLARE(image_iron_ingot);
+    LV_IMAGE_DECLARE(image_gold_ingot);
 
-    lv_obj_delete_async(anim->var);
+    main_scene = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(main_scene, static_layer_get_bg_color(&main_scene_mask), LV_PART_MAIN);
+
+    // the main scene is built off-screen while the logo is shown,
+    // in small slices so the logo fade keeps its frame rate
+    scene_builder_t* builder = scene_builder_create(SCENE_PRELOAD_BUDGET_US);
+    scene_builder_set_period(builder, SCENE_PRELOAD_PERIOD_MS);
+    init_particle_pool(builder, &lv_image_diamonds, PARTICLE_DIAMOND_POOL_SIZE, &image_diamond);
+    init_particle_pool(builder, &lv_image_emeralds, PARTICLE_EMERALD_POOL_SIZE, &image_emerald);
+    init_particle_pool(builder, &lv_image_iron_ingots, PARTICLE_IRON_INGOT_POOL_SIZE, &image_iron_ingot);
+    init_particle_pool(builder, &lv_image_gold_ingots, PARTICLE_GOLD_INGOT_POOL_SIZE, &image_gold_ingot);
+    scene_builder_add_step(builder, init_diamond_pickaxe, NULL);
+    main_scene_preload = scene_preload_start(builder);
 }
 
 void init_lvgl_scene(void){
@@ -232,6 +366,8 @@ void enter_lvgl_scene(void){
     lv_anim_timeline_add(timeline, 2000, &intro_fade_out_anim);
 
     lv_anim_timeline_start(timeline);
+
+    preload_main_scene();
 }
 
 void app_main() {
@@ -241,10 +377,17 @@ void app_main() {
     vTaskDelay(40 / portTICK_PERIOD_MS);
     esp_lcd_panel_disp_on_off(main_lcd_panel_handle, true);
     vTaskDelay(10 / portTICK_PERIOD_MS);
+#if PERF_REPLAY == 1
+    const lvgl_port_replay_cfg_t replay_cfg = {
+            .tick_period_ms = PERF_REPLAY_TICK_PERIOD_MS,
+    };
+    ESP_ERROR_CHECK(lvgl_port_replay_start(&replay_cfg));
+#endif
     enter_lvgl_scene();
 
-#if PERF_MEM_USAGE == 1
+#if PERF_MEM_USAGE == 1 || PERF_FLUSH_STATS == 1
     while (1) {
+#if PERF_MEM_USAGE == 1
         lv_mem_monitor_t lv_mem_info;
         lv_mem_monitor(&lv_mem_info);
         ESP_LOGI("perf", "heap: %lu | lvgl: %zu/%zu",
@@ -252,6 +395,61 @@ void app_main() {
                  lv_mem_info.free_size,
                  lv_mem_info.total_size
         );
+#endif
+#if PERF_FLUSH_STATS == 1
+        lvgl_port_disp_flush_stats_t flush_stats;
+        lvgl_port_disp_get_flush_stats(lvgl_main_display_handle, &flush_stats, true);
+        ESP_LOGI("perf", "flush: %lu fps | %lu flushes | %lu stalls, %llu us | %lu merged areas, %lu transactions saved | %llu bytes skipped | %lu chained bands",
+                 flush_stats.fps,
+                 flush_stats.flushes,
+                 flush_stats.stalls,
+                 flush_stats.stall_us,
+                 flush_stats.merged_areas,
+                 flush_stats.trans_saved,
+                 flush_stats.diff_skipped_bytes,
+                 flush_stats.chained_bands
+        );
+#if DISP_POLL_MAX_BYTES > 0
+        ESP_LOGI("perf", "transfers: %lu polled, %llu us | %lu queued, %lu measured, %llu us",
+                 flush_stats.poll_trans,
+                 flush_stats.poll_us,
+                 flush_stats.queued_trans,
+                 flush_stats.queued_measured,
+                 flush_stats.queued_us
+        );
+#endif
+#if DISP_VISIBLE_RADIUS > 0
+        ESP_LOGI("perf", "visible: %llu px flushed | %llu px skipped",
+                 flush_stats.flushed_px,
+                 flush_stats.visible_skipped_px
+        );
+#endif
+#if PERF_TARGET_FPS > 0
+        lvgl_port_frame_stats_t frame_stats;
+        lvgl_port_get_frame_stats(&frame_stats, true);
+        ESP_LOGI("perf", "pacing: %lu fps | %lu late, %lu missed | interval %lu +- %lu us | slack min %lu us | work max %lu us",
+                 frame_stats.fps,
+                 frame_stats.late,
+                 frame_stats.missed,
+                 frame_stats.interval_avg_us,
+                 frame_stats.interval_dev_us,
+                 frame_stats.slack_min_us,
+                 frame_stats.work_max_us
+        );
+#endif
+#if DISP_BUFF_TUNE == 1
+        lvgl_port_buff_tune_info_t tune_info;
+        lvgl_port_disp_get_buff_tune(lvgl_main_display_handle, &tune_info);
+        ESP_LOGI("perf", "draw buffers: %u x %lu lines (buffer_size %lu) | predicted %lu us per frame | %lu resizes%s",
+                 tune_info.buffers,
+                 tune_info.lines,
+                 tune_info.buffer_size,
+                 tune_info.frame_us,
+                 tune_info.resizes,
+                 tune_info.stable ? " | stable" : ""
+        );
+#endif
+#endif
         vTaskDelay(100 / portTICK_PERIOD_MS);
     }
 #endif
@@ -0,0 +1,124 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "scene_builder.h"
+
+static const char* TAG = "scene_builder";
+
+typedef struct {
+    scene_builder_step_cb_t cb;
+    void* user_data;
+    uint32_t index;
+} scene_builder_step_t;
+
+struct scene_builder_t {
+    scene_builder_step_t* steps;
+    uint32_t step_count;
+    uint32_t step_capacity;
+    uint32_t next_step;
+
+    uint32_t budget_us;
+    uint32_t period_ms;
+    // most expensive step seen so far, used to predict whether the next one still fits
+    uint32_t max_step_us;
+    uint32_t ticks;
+
+    lv_timer_t* timer;
+    scene_builder_done_cb_t done_cb;
+    void* done_user_data;
+};
+
+static void scene_builder_push(scene_builder_t* builder, scene_builder_step_cb_t cb, void* user_data, uint32_t index){
+    if (builder->step_count == builder->step_capacity) {
+        uint32_t capacity = builder->step_capacity ? builder->step_capacity * 2 : 16;
+        scene_builder_step_t* steps = realloc(builder->steps, capacity * sizeof(scene_builder_step_t));
+        assert(steps != NULL);
+        builder->steps = steps;
+        builder->step_capacity = capacity;
+    }
+
+    builder->steps[builder->step_count++] = (scene_builder_step_t) {
+            .cb = cb,
+            .user_data = user_data,
+            .index = index,
+    };
+}
+
+static void scene_builder_finish(scene_builder_t* builder){
+    ESP_LOGD(TAG, "%lu steps done in %lu ticks, slowest step %lu us",
+             builder->step_count, builder->ticks, builder->max_step_us);
+
+    lv_timer_delete(builder->timer);
+    if (builder->done_cb) {
+        builder->done_cb(builder->done_user_data);
+    }
+    free(builder->steps);
+    free(builder);
+}
+
+static void scene_builder_timer_cb(lv_timer_t* timer){
+    scene_builder_t* builder = lv_timer_get_user_data(timer);
+    int64_t tick_start = esp_timer_get_time();
+    builder->ticks++;
+
+    // always make progress, even if a single step is larger than the budget
+    do {
+        int64_t step_start = esp_timer_get_time();
+        scene_builder_step_t* step = &builder->steps[builder->next_step++];
+        step->cb(step->user_data, step->index);
+
+        uint32_t step_us = esp_timer_get_time() - step_start;
+        if (step_us > builder->max_step_us) {
+            builder->max_step_us = step_us;
+        }
+    } while (builder->next_step < builder->step_count &&
+             (esp_timer_get_time() - tick_start) + builder->max_step_us <= builder->budget_us);
+
+    if (builder->next_step >= builder->step_count) {
+        scene_builder_finish(builder);
+    }
+}
+
+scene_builder_t* scene_builder_create(uint32_t budget_us){
+    scene_builder_t* builder = calloc(1, sizeof(scene_builder_t));
+    assert(builder != NULL);
+    builder->budget_us = budget_us ? budget_us : SCENE_BUILDER_DEFAULT_BUDGET_US;
+    return builder;
+}
+
+void scene_builder_set_period(scene_builder_t* builder, uint32_t period_ms){
+    assert(builder != NULL && builder->timer == NULL);
+    builder->period_ms = period_ms;
+}
+
+void scene_builder_add_step(scene_builder_t* builder, scene_builder_step_cb_t cb, void* user_data){
+    assert(builder != NULL && builder->timer == NULL);
+    scene_builder_push(builder, cb, user_data, 0);
+}
+
+void scene_builder_add_steps(scene_builder_t* builder, scene_builder_step_cb_t cb, void* user_data, uint32_t count){
+    assert(builder != NULL && builder->timer == NULL);
+    for (uint32_t i = 0; i < count; ++i) {
+        scene_builder_push(builder, cb, user_data, i);
+    }
+}
+
+void scene_builder_start(scene_builder_t* builder, scene_builder_done_cb_t done_cb, void* user_data){
+    assert(builder != NULL && builder->timer == NULL);
+    builder->done_cb = done_cb;
+    builder->done_user_data = user_data;
+
+    if (builder->step_count == 0) {
+        if (done_cb) {
+            done_cb(user_data);
+        }
+        free(builder);
+        return;
+    }
+
+    // period 0 (default): run on every lv_timer_handler() call until the queue is drained
+    builder->timer = lv_timer_create(scene_builder_timer_cb, builder->period_ms, builder);
+}
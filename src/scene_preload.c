@@ -0,0 +1,42 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "scene_preload.h"
+
+struct scene_preload_t {
+    bool ready;
+    scene_builder_done_cb_t show_cb;
+    void* show_user_data;
+};
+
+static void scene_preload_built(void* user_data){
+    scene_preload_t* preload = user_data;
+    preload->ready = true;
+
+    // shown before the preload was done, finish the switch now
+    if (preload->show_cb) {
+        preload->show_cb(preload->show_user_data);
+        free(preload);
+    }
+}
+
+scene_preload_t* scene_preload_start(scene_builder_t* builder){
+    scene_preload_t* preload = calloc(1, sizeof(scene_preload_t));
+    assert(preload != NULL);
+    scene_builder_start(builder, scene_preload_built, preload);
+    return preload;
+}
+
+void scene_preload_show(scene_preload_t* preload, scene_builder_done_cb_t show_cb, void* user_data){
+    assert(preload != NULL && preload->show_cb == NULL);
+
+    if (preload->ready) {
+        show_cb(user_data);
+        free(preload);
+        return;
+    }
+
+    preload->show_cb = show_cb;
+    preload->show_user_data = user_data;
+}
@@ -0,0 +1,78 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+
+#include "static_layer.h"
+
+#define STATIC_LAYER_CACHE_SIZE 8
+
+static const char* TAG = "static_layer";
+
+typedef struct {
+    static_layer_t layer;
+    const lv_image_dsc_t* src;
+    lv_image_dsc_t* folded;
+} static_layer_cache_entry_t;
+
+static static_layer_cache_entry_t static_layer_cache[STATIC_LAYER_CACHE_SIZE];
+static size_t static_layer_cache_count;
+
+static bool static_layer_equal(const static_layer_t* a, const static_layer_t* b){
+    return lv_color_eq(a->bg_color, b->bg_color) &&
+           lv_color_eq(a->overlay_color, b->overlay_color) &&
+           a->overlay_opa == b->overlay_opa;
+}
+
+static uint16_t static_layer_fold_rgb565(uint16_t pixel, lv_color_t overlay_color, lv_opa_t overlay_opa){
+    lv_color_t color = lv_color_make((pixel >> 8) & 0xF8, (pixel >> 3) & 0xFC, (pixel << 3) & 0xF8);
+    return lv_color_to_u16(lv_color_mix(overlay_color, color, overlay_opa));
+}
+
+lv_color_t static_layer_get_bg_color(const static_layer_t* layer){
+    return lv_color_mix(layer->overlay_color, layer->bg_color, layer->overlay_opa);
+}
+
+const lv_image_dsc_t* static_layer_fold_image(const static_layer_t* layer, const lv_image_dsc_t* src){
+    for (size_t i = 0; i < static_layer_cache_count; ++i) {
+        if (static_layer_cache[i].src == src && static_layer_equal(&static_layer_cache[i].layer, layer)) {
+            return static_layer_cache[i].folded;
+        }
+    }
+
+    if (src->header.cf != LV_COLOR_FORMAT_RGB565 && src->header.cf != LV_COLOR_FORMAT_RGB565A8) {
+        ESP_LOGW(TAG, "color format %d can't be folded", src->header.cf);
+        return NULL;
+    }
+    if (static_layer_cache_count == STATIC_LAYER_CACHE_SIZE) {
+        ESP_LOGW(TAG, "cache is full");
+        return NULL;
+    }
+
+    lv_image_dsc_t* folded = malloc(sizeof(lv_image_dsc_t));
+    uint8_t* data = malloc(src->data_size);
+    if (folded == NULL || data == NULL) {
+        free(folded);
+        free(data);
+        return NULL;
+    }
+
+    // the alpha plane of RGB565A8 follows the color plane and is copied unchanged
+    memcpy(data, src->data, src->data_size);
+    for (uint32_t y = 0; y < src->header.h; ++y) {
+        uint16_t* row = (uint16_t*) (data + y * src->header.stride);
+        for (uint32_t x = 0; x < src->header.w; ++x) {
+            row[x] = static_layer_fold_rgb565(row[x], layer->overlay_color, layer->overlay_opa);
+        }
+    }
+
+    *folded = *src;
+    folded->data = data;
+
+    static_layer_cache[static_layer_cache_count++] = (static_layer_cache_entry_t) {
+            .layer = *layer,
+            .src = src,
+            .folded = folded,
+    };
+    return folded;
+}